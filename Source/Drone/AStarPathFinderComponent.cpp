@@ -2,67 +2,73 @@
 #include "AStarPathFinderComponent.h"
 #include "DrawDebugHelpers.h"
 #include "PathModifierComponent.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 
-// Helper struct for A* algorithm
-struct FAStarNode
-{
-    FVector Position;      // World position
-    int GridX, GridY, GridZ; // Grid coordinates
-    float GScore;          // Cost from start
-    float FScore;          // Total cost (GScore + Heuristic)
-    FAStarNode* Parent;    // Parent node
-    
-    FAStarNode(FVector InPos, int X, int Y, int Z)
-        : Position(InPos), GridX(X), GridY(Y), GridZ(Z),
-          GScore(FLT_MAX), FScore(FLT_MAX), Parent(nullptr)
-    {
-    }
-    
-    bool operator==(const FAStarNode& Other) const
-    {
-        return GridX == Other.GridX && GridY == Other.GridY && GridZ == Other.GridZ;
-    }
-};
-
-// Node comparison operator for priority queue
-struct FNodeCompare
-{
-    bool operator()(const FAStarNode& A, const FAStarNode& B) const
-    {
-        return A.FScore > B.FScore; // Lower FScore has higher priority
-    }
-};
+#include "PlanningCoreConversions.h"
+#include "PlanningCore/PathSmoother.h"
 
 // 添加最大搜索步数和超时时间常量
 const int32 MAX_SEARCH_STEPS = 100000;
-const float MAX_SEARCH_TIME = 1.0f; // 1秒超时
+const int32 MAX_ASYNC_REPLANS = 2; // 异步结果因快照过时而失效后最多重新规划的次数
 
 // 定义静态成员变量
-TMap<int32, FDroneReservation> UAStarPathFinderComponent::ReservationTable;
+DronePlanning::FReservationTable UAStarPathFinderComponent::ReservationTable;
+uint32 UAStarPathFinderComponent::ReservationVersion = 0;
+TSharedPtr<const DronePlanning::FReservationTable, ESPMode::ThreadSafe> UAStarPathFinderComponent::ReservationSnapshot;
+uint32 UAStarPathFinderComponent::ReservationSnapshotVersion = 0;
+DronePlanning::FBatchPlanner UAStarPathFinderComponent::BatchPlanner;
+DronePlanning::FConflictBasedPlanner UAStarPathFinderComponent::ConflictPlanner;
 
 // 实现静态方法
 void UAStarPathFinderComponent::AddReservation(int32 DroneID, const FDroneReservation& Reservation)
 {
-    ReservationTable.Add(DroneID, Reservation);
+    DronePlanning::FReservationTable::FSampleList Samples;
+    Samples.reserve(Reservation.PathPoints.Num());
+    for (const FSpaceTimePoint& Point : Reservation.PathPoints)
+    {
+        Samples.emplace_back(ToPlanningVec(Point.Position), Point.AbsTime);
+    }
+    ReservationTable.Reserve(DroneID, MoveTemp(Samples));
+    ReservationVersion++;
     UE_LOG(LogTemp, Warning, TEXT("Static ReservationTable - Added DroneID: %d, Total Entries: %d"), DroneID, ReservationTable.Num());
 }
 
-const TMap<int32, FDroneReservation>& UAStarPathFinderComponent::GetReservationTable()
+const DronePlanning::FReservationTable& UAStarPathFinderComponent::GetReservationTable()
 {
     return ReservationTable;
 }
 
 void UAStarPathFinderComponent::ClearReservationTable()
 {
-    ReservationTable.Empty();
+    ReservationTable.Clear();
+    ReservationVersion++;
     UE_LOG(LogTemp, Warning, TEXT("Static ReservationTable - Cleared"));
 }
 
+void UAStarPathFinderComponent::DelayReservation(int32 DroneID, float FromTime, float Delay)
+{
+    ReservationTable.Delay(DroneID, FromTime, Delay);
+    ReservationVersion++;
+}
+
+TSharedRef<const DronePlanning::FReservationTable, ESPMode::ThreadSafe> UAStarPathFinderComponent::GetReservationSnapshot()
+{
+    if (!ReservationSnapshot.IsValid() || ReservationSnapshotVersion != ReservationVersion)
+    {
+        ReservationSnapshot = MakeShared<const DronePlanning::FReservationTable, ESPMode::ThreadSafe>(ReservationTable);
+        ReservationSnapshotVersion = ReservationVersion;
+    }
+    return ReservationSnapshot.ToSharedRef();
+}
+
 UAStarPathFinderComponent::UAStarPathFinderComponent()
 {
     PrimaryComponentTick.bCanEverTick = true;
     PrimaryComponentTick.TickInterval = 1.0f;
     ProgramStartTime = FPlatformTime::Seconds();
+    AsyncPlanner = MakeShared<DronePlanning::FAStarPlanner, ESPMode::ThreadSafe>();
+    AsyncHierarchicalPlanner = MakeShared<FAsyncHierarchicalPlanner, ESPMode::ThreadSafe>();
 }
 
 // 新接口，带DroneID
@@ -75,217 +81,498 @@ bool UAStarPathFinderComponent::FindPath(const FVector& Start, const FVector& Go
         return false;
     }
 
+    // 同步请求取代尚未返回的异步请求
+    CancelAsyncPath();
+
     StoredPath.Empty();
     OutPath.Empty();
-    // Convert start and goal to grid coordinates
-    int StartX, StartY, StartZ;
-    int GoalX, GoalY, GoalZ;
-    
-    if (!GridMap->WorldToGrid(Start, StartX, StartY, StartZ))
+
+    const DronePlanning::FOccupancyGrid& Grid = GridMap->GetPlanningGrid();
+    const DronePlanning::FPlanRequest Request = MakePlanRequest(Start, Goal, DroneID);
+    if (TryCachedPath(Request, OutPath))
+    {
+        return true;
+    }
+
+    Planner.Config.DroneSpeed = DroneSpeed;
+    Planner.Config.SearchMode = GetPlanningSearchMode();
+    Planner.Config.MaxSearchSteps = MAX_SEARCH_STEPS;
+    Planner.Config.MaxSearchMicros = SearchBudgetMicros;
+    Planner.Config.AnytimeInitialWeight = AnytimeInitialWeight;
+
+    std::vector<DronePlanning::FVec3> Path;
+    const DronePlanning::EPlanStatus Status = Planner.FindPath(Grid, &ReservationTable, Request, Path);
+    if (Status != DronePlanning::EPlanStatus::Success)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: %s (DroneID: %d, %s expansions: %d)"),
+            UTF8_TO_TCHAR(DronePlanning::LexToString(Status)), DroneID,
+            UTF8_TO_TCHAR(DronePlanning::LexToString(Planner.Config.SearchMode)), Planner.GetLastStats().Expansions);
+        return TryHierarchicalFallback(Status, Request.Start, Request.Goal, DroneID, OutPath);
+    }
+    UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: found path (DroneID: %d, %s expansions: %d, cost: %.1f, bound: %.2f)"),
+        DroneID, UTF8_TO_TCHAR(DronePlanning::LexToString(Planner.Config.SearchMode)),
+        Planner.GetLastStats().Expansions, Planner.GetLastStats().PathCost, Planner.GetLastStats().SuboptimalityBound);
+    if (DronePlanning::FPathCache* PathCache = bUsePathCache ? GridMap->GetPathCache() : nullptr)
+    {
+        PathCache->Add(Grid, Request, Path);
+    }
+
+    // 平滑路径，不安全时保持原始路径
+    DronePlanning::FPathSmoother Smoother(Grid, GetSafetyDistance(), GridMap->GetDistanceField());
+    if (!Smoother.SmoothPath(Path))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SmoothPath: 平滑路径安全性检查失败，保持原始路径"));
+    }
+    UE_LOG(LogTemp, Warning, TEXT("SmoothPath: 平滑后的路径点数: %d"), (int32)Path.size());
+
+    ToFVectorPath(Path, OutPath);
+    StoredPath = OutPath;
+
+    // 记录预约
+    ReservationTable.Reserve(DroneID, DronePlanning::FReservationTable::BuildSamples(Path, DroneSpeed, ProgramStartTime));
+    ReservationVersion++;
+    return true;
+}
+
+bool UAStarPathFinderComponent::CommitExternalPath(const std::vector<DronePlanning::FVec3>& RawPath, int32 DroneID, TArray<FVector>& OutPath)
+{
+    OutPath.Empty();
+    if (!GridMap || RawPath.size() < 2)
     {
-        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: Start position is outside the grid"));
         return false;
     }
-    
-    if (!GridMap->WorldToGrid(Goal, GoalX, GoalY, GoalZ))
+
+    // 外部规划不考虑预约表，提交前逐段检查
+    if (ReservationTable.IsPathConflict(DronePlanning::FReservationTable::BuildSamples(RawPath, DroneSpeed, ProgramStartTime), DroneID))
     {
-        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: Goal position is outside the grid"));
         return false;
     }
-    
-    // Check if start or goal is occupied
-    if (GridMap->IsOccupied(Start))
+
+    CancelAsyncPath();
+    CommitPath(RawPath, DroneID, OutPath);
+    return true;
+}
+
+void UAStarPathFinderComponent::CommitPath(const std::vector<DronePlanning::FVec3>& RawPath, int32 DroneID, TArray<FVector>& OutPath)
+{
+    std::vector<DronePlanning::FVec3> Path = RawPath;
+    DronePlanning::FPathSmoother Smoother(GridMap->GetPlanningGrid(), GetSafetyDistance(), GridMap->GetDistanceField());
+    Smoother.SmoothPath(Path);
+
+    ToFVectorPath(Path, OutPath);
+    StoredPath = OutPath;
+    ReservationTable.Reserve(DroneID, DronePlanning::FReservationTable::BuildSamples(Path, DroneSpeed, ProgramStartTime));
+    ReservationVersion++;
+}
+
+bool UAStarPathFinderComponent::TryCachedPath(const DronePlanning::FPlanRequest& Request, TArray<FVector>& OutPath)
+{
+    DronePlanning::FPathCache* PathCache = bUsePathCache && GridMap ? GridMap->GetPathCache() : nullptr;
+    std::vector<DronePlanning::FVec3> RawPath;
+    if (!PathCache || !PathCache->Find(GridMap->GetPlanningGrid(), &ReservationTable, ReservationVersion, Request, DroneSpeed, RawPath))
     {
-        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: Start position is occupied"));
         return false;
     }
-    
-    if (GridMap->IsOccupied(Goal))
+
+    const DronePlanning::FPathCacheStats& Stats = PathCache->GetStats();
+    UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: reused cached path (DroneID: %d, points: %d, cache hits: %d, misses: %d)"),
+        Request.DroneID, (int32)RawPath.size(), Stats.Hits, Stats.Misses);
+    CancelAsyncPath();
+    CommitPath(RawPath, Request.DroneID, OutPath);
+    return true;
+}
+
+DronePlanning::FPlanRequest UAStarPathFinderComponent::MakePlanRequest(const FVector& Start, const FVector& Goal, int32 DroneID) const
+{
+    DronePlanning::FPlanRequest Request;
+    Request.Start = ToPlanningVec(Start);
+    Request.Goal = ToPlanningVec(Goal);
+    Request.DroneID = DroneID;
+    Request.StartTime = ProgramStartTime;
+    return Request;
+}
+
+bool UAStarPathFinderComponent::TryHierarchicalFallback(DronePlanning::EPlanStatus Status, const DronePlanning::FVec3& Start, const DronePlanning::FVec3& Goal,
+    int32 DroneID, TArray<FVector>& OutPath)
+{
+    if (!bHierarchicalFallback || !GridMap
+        || (Status != DronePlanning::EPlanStatus::StepLimit && Status != DronePlanning::EPlanStatus::TimeLimit))
     {
-        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: Goal position is occupied"));
         return false;
     }
-    // 使用优先队列替代TArray
-    TArray<FAStarNode*> OpenSet;
-    TArray<FAStarNode*> ClosedSet;
-    TMap<int32, FAStarNode*> NodeMap; // 用于快速查找节点
-    
-    // 创建起始节点
-    FAStarNode* StartNode = new FAStarNode(Start, StartX, StartY, StartZ);
-    StartNode->GScore = 0;
-    float InitialHScore = GetDiagonalHeuristic(StartX, StartY, StartZ, GoalX, GoalY, GoalZ);
-    StartNode->FScore = InitialHScore;
-    
-    // 添加到开放集
-    OpenSet.Add(StartNode);
-    float SearchStartTime = GetWorld()->GetTimeSeconds();
-    int32 Steps = 0;
-    bool bFound = false;
-    FAStarNode* GoalNode = nullptr;
-    while (OpenSet.Num() > 0)
-    {
-        if (GetWorld()->GetTimeSeconds() - SearchStartTime > MAX_SEARCH_TIME)
+    DronePlanning::FHierarchicalPlanner* Hierarchical = GridMap->GetHierarchicalPlanner();
+    if (!Hierarchical)
+    {
+        return false;
+    }
+
+    Hierarchical->Config.MaxSearchSteps = MAX_SEARCH_STEPS;
+    Hierarchical->Config.MaxSearchMicros = SearchBudgetMicros;
+    Hierarchical->Config.CancelFlag = nullptr;
+
+    std::vector<DronePlanning::FVec3> Path;
+    const DronePlanning::EPlanStatus HierarchicalStatus = Hierarchical->Plan(GridMap->GetPlanningGrid(), Start, Goal, Path);
+    const DronePlanning::FSearchStats& Stats = Hierarchical->GetLastStats();
+    if (HierarchicalStatus != DronePlanning::EPlanStatus::Success)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: hierarchical %s (DroneID: %d, expansions: %d)"),
+            UTF8_TO_TCHAR(DronePlanning::LexToString(HierarchicalStatus)), DroneID, Stats.Expansions);
+        return false;
+    }
+    if (!CommitExternalPath(Path, DroneID, OutPath))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: hierarchical path conflicts with reservations (DroneID: %d)"), DroneID);
+        return false;
+    }
+    UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: hierarchical path (DroneID: %d, expansions: %d, clusters built: %d, cost: %.1f)"),
+        DroneID, Stats.Expansions, Stats.GeneratedNodes, Stats.PathCost);
+    return true;
+}
+
+UGridMapComponent* UAStarPathFinderComponent::MakeBatchQueries(TArray<FBatchPathTask>& Tasks,
+    std::vector<DronePlanning::FBatchQuery>& OutQueries, TArray<int32>& OutTaskIndices)
+{
+    UGridMapComponent* SharedGridMap = nullptr;
+    for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+    {
+        FBatchPathTask& Task = Tasks[TaskIndex];
+        Task.Path.Reset();
+        Task.bSuccess = false;
+
+        UAStarPathFinderComponent* PathFinder = Task.PathFinder;
+        if (!PathFinder || !PathFinder->GridMap)
         {
-            for (FAStarNode* Node : OpenSet) delete Node;
-            for (FAStarNode* Node : ClosedSet) delete Node;
-            return false;
+            UE_LOG(LogTemp, Error, TEXT("AStarPathFinder: batch task for DroneID %d has no PathFinder or GridMap"), Task.DroneID);
+            continue;
         }
-        
-        // 检查步数限制
-        if (++Steps > MAX_SEARCH_STEPS)
+        if (!SharedGridMap)
         {
-            UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: Exceeded max steps %d"), MAX_SEARCH_STEPS);
-            // 清理内存
-            for (FAStarNode* Node : OpenSet) delete Node;
-            for (FAStarNode* Node : ClosedSet) delete Node;
-            return false;
+            SharedGridMap = PathFinder->GridMap;
         }
-        
-        // 获取F值最小的节点
-        int32 BestIndex = 0;
-        float BestFScore = OpenSet[0]->FScore;
-        for (int32 i = 1; i < OpenSet.Num(); i++)
+        else if (SharedGridMap != PathFinder->GridMap)
         {
-            if (OpenSet[i]->FScore < BestFScore)
-            {
-                BestFScore = OpenSet[i]->FScore;
-                BestIndex = i;
-            }
+            UE_LOG(LogTemp, Error, TEXT("AStarPathFinder: batch task for DroneID %d uses a different GridMap"), Task.DroneID);
+            continue;
         }
-        
-        FAStarNode* Current = OpenSet[BestIndex];
-        OpenSet.RemoveAt(BestIndex);
-        if(Steps%10000==0)
-        {UE_LOG(LogTemp, Log, TEXT("Step %d: Current node at grid (%d, %d, %d), world (%.2f, %.2f, %.2f), FScore=%.2f"), 
-            Steps, Current->GridX, Current->GridY, Current->GridZ, 
-            Current->Position.X, Current->Position.Y, Current->Position.Z, Current->FScore);}
-        
-        // 检查是否到达目标
-        const float GoalTolerance = 1.0f; // 允许1个网格单位的误差
-        float DistanceToGoal = FVector::Dist(
-            FVector(Current->GridX, Current->GridY, Current->GridZ),
-            FVector(GoalX, GoalY, GoalZ)
-        );
-        
-        if (DistanceToGoal <= GoalTolerance)
+
+        // 批量结果取代尚未返回的异步请求
+        PathFinder->CancelAsyncPath();
+        PathFinder->StoredPath.Empty();
+
+        DronePlanning::FBatchQuery Query;
+        Query.Request.Start = ToPlanningVec(Task.Start);
+        Query.Request.Goal = ToPlanningVec(Task.Goal);
+        Query.Request.DroneID = Task.DroneID;
+        Query.Request.StartTime = PathFinder->ProgramStartTime;
+        Query.DroneSpeed = PathFinder->DroneSpeed;
+        Query.SearchMode = PathFinder->GetPlanningSearchMode();
+        Query.SafetyDistance = PathFinder->GetSafetyDistance();
+        Query.MaxSearchMicros = PathFinder->SearchBudgetMicros;
+        Query.AnytimeInitialWeight = PathFinder->AnytimeInitialWeight;
+        OutQueries.push_back(Query);
+        OutTaskIndices.Add(TaskIndex);
+    }
+    return SharedGridMap;
+}
+
+void UAStarPathFinderComponent::ApplyBatchResults(TArray<FBatchPathTask>& Tasks, const TArray<int32>& TaskIndices,
+    const std::vector<DronePlanning::FBatchResult>& Results)
+{
+    for (int32 QueryIndex = 0; QueryIndex < TaskIndices.Num(); ++QueryIndex)
+    {
+        FBatchPathTask& Task = Tasks[TaskIndices[QueryIndex]];
+        const DronePlanning::FBatchResult& Result = Results[QueryIndex];
+        Task.bSuccess = Result.Status == DronePlanning::EPlanStatus::Success;
+        if (!Task.bSuccess)
         {
-            // 如果非常接近目标，直接使用目标点作为终点
-            if (DistanceToGoal > 0.0f)
-            {
-                FVector GoalWorldPos = GridMap->GridToWorld(GoalX, GoalY, GoalZ);
-                Current->Position = GoalWorldPos;
-                Current->GridX = GoalX;
-                Current->GridY = GoalY;
-                Current->GridZ = GoalZ;
-            }
-            GoalNode = Current;
-            bFound = true;
-            break;
+            UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: batch %s (DroneID: %d, expansions: %d)"),
+                UTF8_TO_TCHAR(DronePlanning::LexToString(Result.Status)), Task.DroneID, Result.Expansions);
+            Task.bSuccess = Task.PathFinder->TryHierarchicalFallback(Result.Status, ToPlanningVec(Task.Start), ToPlanningVec(Task.Goal),
+                Task.DroneID, Task.Path);
+            continue;
         }
-        
-        // 添加到关闭集
-        ClosedSet.Add(Current);
-        
-        // 获取邻居节点
-        TArray<FAStarNode*> Neighbors;
-        GetNeighborsOptimized(Current, Neighbors, GoalX, GoalY, GoalZ);
-        
-        // 处理邻居节点
-        for (FAStarNode* Neighbor : Neighbors)
+        ToFVectorPath(Result.Path, Task.Path);
+        Task.PathFinder->StoredPath = Task.Path;
+    }
+}
+
+DronePlanning::FBatchStats UAStarPathFinderComponent::FindPathsBatch(TArray<FBatchPathTask>& Tasks)
+{
+    std::vector<DronePlanning::FBatchQuery> Queries;
+    TArray<int32> QueryTaskIndices;
+    UGridMapComponent* SharedGridMap = MakeBatchQueries(Tasks, Queries, QueryTaskIndices);
+    if (!SharedGridMap)
+    {
+        return DronePlanning::FBatchStats();
+    }
+
+    BatchPlanner.Config.MaxSearchSteps = MAX_SEARCH_STEPS;
+    BatchPlanner.ParallelFor = [](int32_t Count, const std::function<void(int32_t)>& Body)
+    {
+        ParallelFor(Count, [&Body](int32 Index) { Body(Index); });
+    };
+    BatchPlanner.DistanceField = SharedGridMap->GetDistanceField();
+
+    std::vector<DronePlanning::FBatchResult> Results;
+    const DronePlanning::FBatchStats Stats = BatchPlanner.PlanBatch(SharedGridMap->GetPlanningGrid(), ReservationTable, Queries, Results);
+    ReservationVersion++;
+    ApplyBatchResults(Tasks, QueryTaskIndices, Results);
+
+    UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: batch planned %d/%d paths in %.2f ms (%d waves, %d replanned, %d kept unsmoothed, %lld expansions)"),
+        Stats.NumSucceeded, (int32)Queries.size(), Stats.WallSeconds * 1000.0, Stats.NumWaves, Stats.NumReplanned, Stats.NumUnsmoothed,
+        (long long)Stats.Expansions);
+    return Stats;
+}
+
+DronePlanning::FConflictSearchStats UAStarPathFinderComponent::FindPathsJoint(TArray<FBatchPathTask>& Tasks, float SuboptimalityBound, int64 BudgetMicros)
+{
+    std::vector<DronePlanning::FBatchQuery> Queries;
+    TArray<int32> QueryTaskIndices;
+    UGridMapComponent* SharedGridMap = MakeBatchQueries(Tasks, Queries, QueryTaskIndices);
+    if (!SharedGridMap)
+    {
+        return DronePlanning::FConflictSearchStats();
+    }
+
+    ConflictPlanner.Config.MaxSearchSteps = MAX_SEARCH_STEPS;
+    ConflictPlanner.SuboptimalityBound = SuboptimalityBound;
+    ConflictPlanner.MaxSolveMicros = BudgetMicros;
+    ConflictPlanner.DistanceField = SharedGridMap->GetDistanceField();
+    ConflictPlanner.FallbackPlanner.ParallelFor = [](int32_t Count, const std::function<void(int32_t)>& Body)
+    {
+        ParallelFor(Count, [&Body](int32 Index) { Body(Index); });
+    };
+
+    std::vector<DronePlanning::FBatchResult> Results;
+    const DronePlanning::FConflictSearchStats Stats = ConflictPlanner.PlanGroup(SharedGridMap->GetPlanningGrid(), ReservationTable, Queries, Results);
+    ReservationVersion++;
+    ApplyBatchResults(Tasks, QueryTaskIndices, Results);
+
+    UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: joint planned %d/%d paths in %.2f ms (%d root conflicts, %d/%d tree nodes, %d searches, %lld expansions)%s"),
+        Stats.NumSucceeded, (int32)Queries.size(), Stats.WallSeconds * 1000.0, Stats.RootConflicts, Stats.HighLevelExpansions,
+        Stats.HighLevelNodes, Stats.LowLevelSearches, (long long)Stats.Expansions, Stats.bFellBack ? TEXT(", fell back to prioritized planning") : TEXT(""));
+    return Stats;
+}
+
+void UAStarPathFinderComponent::FindPathAsync(const FVector& Start, const FVector& Goal, int32 DroneID, FOnPathPlanned OnComplete)
+{
+    if (!GridMap)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AStarPathFinder: GridMap is not set"));
+        OnComplete.ExecuteIfBound(false, TArray<FVector>());
+        return;
+    }
+
+    // 缓存命中时立即完成，并取代尚未返回的请求
+    TArray<FVector> CachedPath;
+    if (TryCachedPath(MakePlanRequest(Start, Goal, DroneID), CachedPath))
+    {
+        OnComplete.ExecuteIfBound(true, CachedPath);
+        return;
+    }
+
+    FAsyncPathRequest AsyncRequest{ Start, Goal, DroneID, MoveTemp(OnComplete) };
+    if (bAsyncPlanInFlight)
+    {
+        // 规划器仍被后台任务占用：让它尽快结束，只保留最新的请求
+        AsyncCancelFlag->store(true);
+        PendingAsyncRequest = MoveTemp(AsyncRequest);
+        return;
+    }
+    LaunchAsyncPlan(MoveTemp(AsyncRequest));
+}
+
+void UAStarPathFinderComponent::CancelAsyncPath()
+{
+    PendingAsyncRequest.Reset();
+    if (bAsyncPlanInFlight)
+    {
+        AsyncCancelFlag->store(true);
+        AsyncPlanSerial++;
+        InFlightCallback.Unbind();
+    }
+}
+
+void UAStarPathFinderComponent::LaunchAsyncPlan(FAsyncPathRequest&& AsyncRequest)
+{
+    bAsyncPlanInFlight = true;
+    AsyncPlanSerial++;
+    InFlightCallback = MoveTemp(AsyncRequest.OnComplete);
+    AsyncCancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+
+    const DronePlanning::FPlanRequest Request = MakePlanRequest(AsyncRequest.Start, AsyncRequest.Goal, AsyncRequest.DroneID);
+    const DronePlanning::FPathCache* PathCache = bUsePathCache ? GridMap->GetPathCache() : nullptr;
+
+    DronePlanning::FPlannerConfig Config;
+    Config.DroneSpeed = DroneSpeed;
+    Config.SearchMode = GetPlanningSearchMode();
+    Config.MaxSearchSteps = MAX_SEARCH_STEPS;
+    Config.MaxSearchMicros = SearchBudgetMicros;
+    Config.AnytimeInitialWeight = AnytimeInitialWeight;
+    Config.CancelFlag = AsyncCancelFlag.Get();
+
+    // 快照可能落后于地图（见UGridMapComponent::GridSnapshotMinInterval），记录快照自身的版本，完成时按最新地图重新检查
+    TSharedRef<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> GridSnapshot = GridMap->GetPlanningGridSnapshot();
+
+    FAsyncPlanStamp Stamp;
+    Stamp.Serial = AsyncPlanSerial;
+    Stamp.CacheEpoch = PathCache ? GridMap->GetPlanningGridSnapshotCacheEpoch() : 0;
+    Stamp.ReservationVersion = ReservationVersion;
+    Stamp.GridVersion = GridMap->GetPlanningGridSnapshotVersion();
+    Stamp.Attempt = AsyncRequest.Attempt;
+
+    Async(EAsyncExecution::ThreadPool,
+        [WeakThis = TWeakObjectPtr<UAStarPathFinderComponent>(this),
+         Planner = AsyncPlanner,
+         Hierarchical = bHierarchicalFallback ? AsyncHierarchicalPlanner : TSharedPtr<FAsyncHierarchicalPlanner, ESPMode::ThreadSafe>(),
+         ClusterSize = GridMap->HierarchicalClusterSize,
+         CancelFlag = AsyncCancelFlag,
+         Grid = GridSnapshot,
+         Reservations = GetReservationSnapshot(),
+         Config = MoveTemp(Config),
+         Request,
+         SafetyDistance = GetSafetyDistance(),
+         Stamp]() mutable
         {
-            float SegmentDistance = FVector::Dist(Current->Position, Neighbor->Position);
-            float RelativeTime = Current->GScore / DroneSpeed + SegmentDistance / DroneSpeed;
-            float AbsTime = ProgramStartTime + RelativeTime;
-            // 使用时空冲突检测
-            if (IsSpaceTimeConflict(Neighbor->Position, AbsTime, DroneID))
-            {
-                delete Neighbor;
-                continue;
-            }
-            // 检查是否在关闭集中
-            bool InClosedSet = false;
-            for (FAStarNode* ClosedNode : ClosedSet)
+            Planner->Config = MoveTemp(Config);
+            FAsyncPlanResult Result;
+            Result.SearchStatus = Planner->FindPath(*Grid, &Reservations.Get(), Request, Result.Path);
+            Result.Status = Result.SearchStatus;
+            Result.Expansions = Planner->GetLastStats().Expansions;
+
+            // 逐格搜索超限时在同一快照上改用分层寻路器，预算与取消标志同上；游戏线程只负责检查预约冲突
+            if (Hierarchical.IsValid()
+                && (Result.Status == DronePlanning::EPlanStatus::StepLimit || Result.Status == DronePlanning::EPlanStatus::TimeLimit))
             {
-                if (*Neighbor == *ClosedNode)
+                if (Hierarchical->ClusterGrid.Pin().Get() != &Grid.Get())
                 {
-                    InClosedSet = true;
-                    break;
+                    Hierarchical->Planner.Reset();
+                    Hierarchical->ClusterGrid = Grid;
                 }
+                Hierarchical->Planner.Config = Planner->Config;
+                Hierarchical->Planner.ClusterSize = ClusterSize;
+                Result.Path.clear();
+                Result.Status = Hierarchical->Planner.Plan(*Grid, Request.Start, Request.Goal, Result.Path);
+                Result.bHierarchical = true;
+                Result.Expansions += Hierarchical->Planner.GetLastStats().Expansions;
             }
-            
-            if (InClosedSet)
+
+            if (Result.Status == DronePlanning::EPlanStatus::Success)
             {
-                delete Neighbor;
-                continue;
+                Result.RawPath = Result.Path;
+                DronePlanning::FPathSmoother Smoother(*Grid, SafetyDistance);
+                Smoother.SmoothPath(Result.Path);
             }
-            
-            // 检查是否在开放集中
-            bool InOpenSet = false;
-            FAStarNode* OpenNode = nullptr;
-            for (FAStarNode* Node : OpenSet)
-            {
-                if (*Node == *Neighbor)
+
+            AsyncTask(ENamedThreads::GameThread,
+                [WeakThis, Stamp, Result = MoveTemp(Result), Request]() mutable
                 {
-                    InOpenSet = true;
-                    OpenNode = Node;
-                    break;
-                }
-            }
-            float TentativeGScore = Current->GScore + SegmentDistance;
-            if (!InOpenSet)
-            {
-                Neighbor->GScore = TentativeGScore;
-                float NeighborHScore = GetDiagonalHeuristic(Neighbor->GridX, Neighbor->GridY, Neighbor->GridZ, GoalX, GoalY, GoalZ);
-                Neighbor->FScore = TentativeGScore + NeighborHScore;
-                Neighbor->Parent = Current;
-                OpenSet.Add(Neighbor);
-            }
-            else if (TentativeGScore < OpenNode->GScore)
-            {
-                OpenNode->GScore = TentativeGScore;
-                float OpenNodeHScore = GetDiagonalHeuristic(OpenNode->GridX, OpenNode->GridY, OpenNode->GridZ, GoalX, GoalY, GoalZ);
-                OpenNode->FScore = TentativeGScore + OpenNodeHScore;
-                OpenNode->Parent = Current;
-                delete Neighbor;
-            }
-            else
-            {
-                delete Neighbor;
-            }
+                    if (UAStarPathFinderComponent* This = WeakThis.Get())
+                    {
+                        This->OnAsyncPlanFinished(Stamp, MoveTemp(Result), Request);
+                    }
+                });
+        });
+}
+
+void UAStarPathFinderComponent::OnAsyncPlanFinished(const FAsyncPlanStamp& Stamp, FAsyncPlanResult&& Result, const DronePlanning::FPlanRequest& Request)
+{
+    const int32 DroneID = Request.DroneID;
+    bAsyncPlanInFlight = false;
+
+    // 结果即使被更新的请求取代，对其自身的起点/终点仍然有效；规划开始后变化过的区域会使条目失效。
+    // 分层路径不考虑预约表，与同步规划一样不进入缓存
+    DronePlanning::FPathCache* PathCache = bUsePathCache && GridMap ? GridMap->GetPathCache() : nullptr;
+    if (PathCache && Result.Status == DronePlanning::EPlanStatus::Success && !Result.bHierarchical)
+    {
+        PathCache->Add(GridMap->GetPlanningGrid(), Request, Result.RawPath, Stamp.CacheEpoch);
+    }
+    FOnPathPlanned OnComplete = MoveTemp(InFlightCallback);
+    InFlightCallback.Unbind();
+
+    // 运行期间有更新的请求：丢弃本次结果，立即规划最新请求
+    if (PendingAsyncRequest.IsSet())
+    {
+        FAsyncPathRequest Next = MoveTemp(PendingAsyncRequest.GetValue());
+        PendingAsyncRequest.Reset();
+        LaunchAsyncPlan(MoveTemp(Next));
+        return;
+    }
+
+    // 已被取消或被同步请求取代
+    if (Stamp.Serial != AsyncPlanSerial)
+    {
+        return;
+    }
+
+    if (Result.Status != DronePlanning::EPlanStatus::Success)
+    {
+        if (Result.bHierarchical)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: async %s, hierarchical %s (DroneID: %d, expansions: %d)"),
+                UTF8_TO_TCHAR(DronePlanning::LexToString(Result.SearchStatus)), UTF8_TO_TCHAR(DronePlanning::LexToString(Result.Status)),
+                DroneID, Result.Expansions);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: async %s (DroneID: %d, expansions: %d)"),
+                UTF8_TO_TCHAR(DronePlanning::LexToString(Result.Status)), DroneID, Result.Expansions);
         }
+        OnComplete.ExecuteIfBound(false, TArray<FVector>());
+        return;
     }
-    if (bFound)
+
+    // 规划期间预约表或地图有变化时，快照上的路径可能已与新预约冲突或穿过新障碍物：重新检查，不再可行时重新规划
+    const bool bSnapshotStale = Stamp.ReservationVersion != ReservationVersion || Stamp.GridVersion != GridMap->GetGridVersion();
+    if (bSnapshotStale && !IsPlannedPathStillValid(Result.Path, DroneID))
     {
-        ReconstructPath(GoalNode, OutPath);
-        for (FAStarNode* Node : OpenSet) delete Node;
-        for (FAStarNode* Node : ClosedSet) delete Node;
-        SmoothPath(OutPath);
-        StoredPath = OutPath;
+        if (Stamp.Attempt >= MAX_ASYNC_REPLANS)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: async path invalidated while planning, giving up after %d replans (DroneID: %d)"),
+                Stamp.Attempt, DroneID);
+            OnComplete.ExecuteIfBound(false, TArray<FVector>());
+            return;
+        }
+        UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: async path invalidated while planning, replanning (DroneID: %d)"), DroneID);
+        LaunchAsyncPlan(FAsyncPathRequest{ ToFVector(Request.Start), ToFVector(Request.Goal), DroneID, MoveTemp(OnComplete), Stamp.Attempt + 1 });
+        return;
+    }
 
-        // 记录预约
-        TArray<FSpaceTimePoint> NewReservation;
-        float AccumTime = 0.0f;
-        for (int32 i = 0; i < OutPath.Num() - 1; ++i)
+    // 分层路径不考虑预约表，与CommitExternalPath一样提交前检查；冲突时与同步回退一样判为失败
+    if (Result.bHierarchical && !bSnapshotStale
+        && ReservationTable.IsPathConflict(DronePlanning::FReservationTable::BuildSamples(Result.Path, DroneSpeed, ProgramStartTime), DroneID))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AStarPathFinder: hierarchical path conflicts with reservations (DroneID: %d)"), DroneID);
+        OnComplete.ExecuteIfBound(false, TArray<FVector>());
+        return;
+    }
+    if (Result.bHierarchical)
+    {
+        UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: async hierarchical path after %s (DroneID: %d, expansions: %d)"),
+            UTF8_TO_TCHAR(DronePlanning::LexToString(Result.SearchStatus)), DroneID, Result.Expansions);
+    }
+
+    ToFVectorPath(Result.Path, StoredPath);
+    ReservationTable.Reserve(DroneID, DronePlanning::FReservationTable::BuildSamples(Result.Path, DroneSpeed, ProgramStartTime));
+    ReservationVersion++;
+    OnComplete.ExecuteIfBound(true, StoredPath);
+}
+
+bool UAStarPathFinderComponent::IsPlannedPathStillValid(const std::vector<DronePlanning::FVec3>& Path, int32 DroneID) const
+{
+    if (ReservationTable.IsPathConflict(DronePlanning::FReservationTable::BuildSamples(Path, DroneSpeed, ProgramStartTime), DroneID))
+    {
+        return false;
+    }
+    DronePlanning::FPathSmoother Checker(GridMap->GetPlanningGrid(), GetSafetyDistance(), GridMap->GetDistanceField());
+    for (size_t i = 0; i + 1 < Path.size(); ++i)
+    {
+        if (!Checker.CanReachDirectly(Path[i], Path[i + 1]))
         {
-            float Segment = FVector::Dist(OutPath[i], OutPath[i+1]);
-            float SegmentTime = Segment / DroneSpeed;
-            NewReservation.Add(FSpaceTimePoint(OutPath[i], ProgramStartTime + AccumTime));
-            AccumTime += SegmentTime;
+            return false;
         }
-        if (OutPath.Num() > 0)
-            NewReservation.Add(FSpaceTimePoint(OutPath.Last(), ProgramStartTime + AccumTime));
-        ReservationTable.Remove(DroneID);
-        ReservationTable.Add(DroneID, FDroneReservation(NewReservation));
-        // UE_LOG(LogTemp, Warning, TEXT("Current Reservations:"));
-        // for (const auto& Elem : GetReservationTable())
-        // {
-        //     UE_LOG(LogTemp, Warning, TEXT("DroneID: %d, PathPoints: %d"), Elem.Key, Elem.Value.PathPoints.Num());
-        // }
-        return true;
     }
-    for (FAStarNode* Node : OpenSet) delete Node;
-    for (FAStarNode* Node : ClosedSet) delete Node;
-    return false;
+    return true;
 }
 
 TArray<FVector> UAStarPathFinderComponent::GetSearchedPath()
@@ -349,73 +636,6 @@ void UAStarPathFinderComponent::VisualizePath(float Duration)
     // }
 }
 
-float UAStarPathFinderComponent::Distance(FAStarNode* A, FAStarNode* B)
-{
-    // Euclidean distance
-    return FVector::Dist(A->Position, B->Position);
-}
-
-// 优化后的邻居节点生成函数
-void UAStarPathFinderComponent::GetNeighborsOptimized(FAStarNode* Node, TArray<FAStarNode*>& OutNeighbors, int32 GoalX, int32 GoalY, int32 GoalZ)
-{
-    if (!Node || !GridMap) return;
-    // 获取网格分辨率
-    const float GridResolution = GridMap->GetResolution();
-    
-    // 定义可能的移动方向（26个方向：6个面 + 12个边 + 8个角）
-    static const int32 Directions[][3] = {
-        // 面
-        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
-        // 边
-        {1, 1, 0}, {1, -1, 0}, {-1, 1, 0}, {-1, -1, 0},
-        {1, 0, 1}, {1, 0, -1}, {-1, 0, 1}, {-1, 0, -1},
-        {0, 1, 1}, {0, 1, -1}, {0, -1, 1}, {0, -1, -1},
-        // 角
-        {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1},
-        {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1}
-    };
-
-    // 遍历所有可能的移动方向
-    for (const auto& Dir : Directions)
-    {
-        int32 NewX = Node->GridX + Dir[0];
-        int32 NewY = Node->GridY + Dir[1];
-        int32 NewZ = Node->GridZ + Dir[2];
-
-        // 检查新位置是否在地图范围内
-        if (NewX < 0 || NewX >= GridMap->GetGridDimX() ||
-            NewY < 0 || NewY >= GridMap->GetGridDimY() ||
-            NewZ < 0 || NewZ >= GridMap->GetGridDimZ())
-        {
-            continue;
-        }
-
-        // 获取世界坐标
-        FVector WorldPos = GridMap->GridToWorld(NewX, NewY, NewZ);
-
-        // 检查是否被占用
-        if (GridMap->IsOccupied(WorldPos))
-            continue;
-
-        // 创建新节点
-        FAStarNode* NewNode = new FAStarNode(WorldPos, NewX, NewY, NewZ);
-        OutNeighbors.Add(NewNode);
-    }
-}
-
-void UAStarPathFinderComponent::ReconstructPath(FAStarNode* GoalNode, TArray<FVector>& OutPath)
-{
-    // Clear path
-    OutPath.Empty();
-    // Trace back from goal to start
-    FAStarNode* Current = GoalNode;
-    while (Current)
-    {
-        OutPath.Insert(Current->Position, 0);
-        Current = Current->Parent;
-    }
-}
-
 void UAStarPathFinderComponent::BeginPlay()
 {
     Super::BeginPlay();
@@ -425,6 +645,13 @@ void UAStarPathFinderComponent::BeginPlay()
     ProgramStartTime = GetWorld()->GetTimeSeconds();
 }
 
+void UAStarPathFinderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // 让后台任务尽快退出，结果会因组件失效而被丢弃
+    CancelAsyncPath();
+    Super::EndPlay(EndPlayReason);
+}
+
 void UAStarPathFinderComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     if (StoredPath.Num()>0)
@@ -434,233 +661,6 @@ void UAStarPathFinderComponent::TickComponent(float DeltaTime, ELevelTick TickTy
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 }
 
-// 添加新的启发式函数
-float UAStarPathFinderComponent::GetDiagonalHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2)
-{
-    if (!GridMap)
-    {
-        UE_LOG(LogTemp, Error, TEXT("GetDiagonalHeuristic: GridMap is not set"));
-        return 0.0f;
-    }
-    
-    float DX = FMath::Abs(X2 - X1);
-    float DY = FMath::Abs(Y2 - Y1);
-    float DZ = FMath::Abs(Z2 - Z1);
-    
-    float H = 0.0f;
-    float Diag = FMath::Min3(DX, DY, DZ);
-    DX -= Diag;
-    DY -= Diag;
-    DZ -= Diag;
-    
-    if (DX == 0)
-    {
-        H = 1.0f * FMath::Sqrt(3.0f) * Diag + FMath::Sqrt(2.0f) * FMath::Min(DY, DZ) + 1.0f * FMath::Abs(DY - DZ);
-    }
-    else if (DY == 0)
-    {
-        H = 1.0f * FMath::Sqrt(3.0f) * Diag + FMath::Sqrt(2.0f) * FMath::Min(DX, DZ) + 1.0f * FMath::Abs(DX - DZ);
-    }
-    else if (DZ == 0)
-    {
-        H = 1.0f * FMath::Sqrt(3.0f) * Diag + FMath::Sqrt(2.0f) * FMath::Min(DX, DY) + 1.0f * FMath::Abs(DX - DY);
-    }
-    
-    return H * GridMap->GetResolution();
-}
-
-float UAStarPathFinderComponent::GetManhattanHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2)
-{
-    if (!GridMap)
-    {
-        UE_LOG(LogTemp, Error, TEXT("GetManhattanHeuristic: GridMap is not set"));
-        return 0.0f;
-    }
-    
-    float DX = FMath::Abs(X2 - X1);
-    float DY = FMath::Abs(Y2 - Y1);
-    float DZ = FMath::Abs(Z2 - Z1);
-    return (DX + DY + DZ) * GridMap->GetResolution();
-}
-
-float UAStarPathFinderComponent::GetEuclideanHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2)
-{
-    if (!GridMap)
-    {
-        UE_LOG(LogTemp, Error, TEXT("GetEuclideanHeuristic: GridMap is not set"));
-        return 0.0f;
-    }
-    
-    float DX = X2 - X1;
-    float DY = Y2 - Y1;
-    float DZ = Z2 - Z1;
-    return FMath::Sqrt(DX*DX + DY*DY + DZ*DZ) * GridMap->GetResolution();
-}
-
-
-
-bool UAStarPathFinderComponent::IsPathPointSafe(const FVector& Point) const
-{
-    if (!GridMap)
-    {
-        return false;
-    }
-    
-    // 获取安全距离
-    float SafetyDistance = GetSafetyDistance();
-    
-    // 检查点周围的安全距离内是否有障碍物
-    TArray<FVector> CheckPoints;
-    int32 NumChecks = 8;  // 在水平面上检查8个方向
-    float AngleStep = 2.0f * PI / NumChecks;
-    
-    for (int32 i = 0; i < NumChecks; i++)
-    {
-        float Angle = i * AngleStep;
-        FVector Offset(
-            FMath::Cos(Angle) * SafetyDistance,
-            FMath::Sin(Angle) * SafetyDistance,
-            0.0f
-        );
-        CheckPoints.Add(Point + Offset);
-    }
-    
-    // 检查上下方向
-    CheckPoints.Add(Point + FVector(0, 0, SafetyDistance));
-    CheckPoints.Add(Point + FVector(0, 0, -SafetyDistance));
-    
-    // 检查所有点
-    for (const FVector& CheckPoint : CheckPoints)
-    {
-        if (GridMap->IsOccupied(CheckPoint))
-        {
-            return false;
-        }
-    }
-    
-    return true;
-}
-
-FVector UAStarPathFinderComponent::GetObstacleRepulsionForce(const FVector& Point)
-{
-    const float SampleDist = 10.f; // 周围采样范围
-    const float InfluenceRadius = 100.f; // 斥力有效距离
-    const float RepulsionStrength = 100.f; // 斥力系数
-
-    FVector Gradient = FVector::ZeroVector;
-    const FVector Directions[6] = {
-        FVector(1, 0, 0), FVector(-1, 0, 0),
-        FVector(0, 1, 0), FVector(0, -1, 0),
-        FVector(0, 0, 1), FVector(0, 0, -1),
-    };
-
-    for (const FVector& Dir : Directions)
-    {
-        FVector SamplePoint = Point + Dir * SampleDist;
-        if (!IsPathPointSafe(SamplePoint))
-        {
-            float Dist = FMath::Max(KINDA_SMALL_NUMBER, FVector::Dist(Point, SamplePoint));
-            float Force = RepulsionStrength * (1.0f - FMath::Clamp(Dist / InfluenceRadius, 0.0f, 1.0f));
-            Gradient -= Dir * Force;
-        }
-    }
-
-    return Gradient;
-}
-
-// 添加平滑函数
-void UAStarPathFinderComponent::SmoothPath(TArray<FVector>& InOutPath)
-{
-    if (InOutPath.Num() < 3) return;  // 至少需要3个点才能平滑
-    const float SmoothingWeight = 0.5f;  // 平滑权重
-    const int32 Iterations = 5;  // 平滑迭代次数
-    const float ObstacleWeight = 0.05f; // 新增惩罚项权重
-    
-    TArray<FVector> SmoothedPath = InOutPath;
-    TArray<FVector> OriginalPath = InOutPath;  // 保存原始路径
-    bool bIsPathSafe = true;
-    
-    for (int32 Iter = 0; Iter < Iterations && bIsPathSafe; Iter++)
-    {
-        TArray<FVector> TempPath = SmoothedPath;
-        
-        // 保持起点和终点不变，只平滑中间点
-        for (int32 i = 1; i < SmoothedPath.Num() - 1; i++)
-        {
-            // 使用前一个点和后一个点的加权平均来平滑当前点
-            FVector PrevPoint = TempPath[i - 1];
-            FVector NextPoint = TempPath[i + 1];
-            FVector CurrentPoint = TempPath[i];
-            
-            // 计算平滑后的点
-            FVector SmoothTerm = (PrevPoint + NextPoint) * 0.5f - CurrentPoint;
-            FVector ObstacleForce = GetObstacleRepulsionForce(CurrentPoint);
-
-            FVector SmoothedPoint = CurrentPoint
-                + SmoothingWeight * SmoothTerm
-                + ObstacleWeight * ObstacleForce;
-            
-            // 检查平滑后的点是否安全
-            if (!IsPathPointSafe(SmoothedPoint))
-            {
-                bIsPathSafe = false;
-                break;
-            }
-
-            // 检查到前一个点和后一个点的路径是否安全
-            if (!CanReachDirectly(SmoothedPoint, PrevPoint) || !CanReachDirectly(SmoothedPoint, NextPoint))
-            {
-                bIsPathSafe = false;
-                break;
-            }
-
-            SmoothedPath[i] = SmoothedPoint;
-        }
-
-        // 如果发现不安全的点，回退到原始路径
-        if (!bIsPathSafe)
-        {
-            // UE_LOG(LogTemp, Warning, TEXT("SmoothPath: 检测到不安全的平滑路径，保持原始路径"));
-            SmoothedPath = OriginalPath;
-            break;
-        }
-    }
-    
-    // 最后一次检查整条路径的安全性
-    for (int32 i = 0; i < SmoothedPath.Num() - 1; i++)
-    {
-        if (!CanReachDirectly(SmoothedPath[i], SmoothedPath[i + 1]))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("SmoothPath: 最终路径安全性检查失败，保持原始路径"));
-            SmoothedPath = OriginalPath;
-            break;
-        }
-    }
-    UE_LOG(LogTemp, Warning, TEXT("SmoothPath: 平滑后的路径点数: %d"), SmoothedPath.Num());
-    InOutPath = SmoothedPath;
-}
-
-bool UAStarPathFinderComponent::CanReachDirectly(const FVector& Start, const FVector& Goal)
-{
-    if (!GridMap)
-        return false;
-       
-    // 计算直线路径上的点
-    FVector Direction = (Goal - Start).GetSafeNormal();
-    float Distance = FVector::Dist(Start, Goal);
-    float StepSize = GridMap->GetResolution();
-   
-    // 检查直线路径上是否有障碍物
-    for (float Dist = 0; Dist < Distance; Dist += StepSize)
-    {
-        FVector CheckPoint = Start + Direction * Dist;
-        if (GridMap->IsOccupied(CheckPoint))
-            return false;
-    }
-   
-    return true;
-}
-
 void UAStarPathFinderComponent::SetGridMap(UGridMapComponent* InGridMap)
 {
     if (!InGridMap)
@@ -672,27 +672,6 @@ void UAStarPathFinderComponent::SetGridMap(UGridMapComponent* InGridMap)
     UE_LOG(LogTemp, Log, TEXT("AStarPathFinder: GridMap set successfully"));
 }
 
-// 检查时空冲突：同一时刻，距离小于1米（100cm）算冲突
-bool UAStarPathFinderComponent::IsSpaceTimeConflict(const FVector& Position, float AbsTime, int32 SelfDroneID) const
-{
-    for (const auto& Elem : ReservationTable)
-    {
-        if (Elem.Key == SelfDroneID) continue;
-        for (const FSpaceTimePoint& Point : Elem.Value.PathPoints)
-        {
-            if (FVector::Dist(Point.Position, Position) < 160.0f) // 允许50ms误差
-            {
-                if (FMath::Abs(Point.AbsTime - AbsTime) < 0.04f)
-                {
-                    // UE_LOG(LogTemp, Warning, TEXT("SpaceTimeConflict: DroneID: %d, Position: %s, AbsTime: %f, SelfDroneID: %d"), Elem.Key, *Position.ToString(), AbsTime, SelfDroneID);
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-
 // 将时间转换为字符串
 FString UAStarPathFinderComponent::TimeToString(float AbsTime)
 {
@@ -714,22 +693,17 @@ FString UAStarPathFinderComponent::GetReservationTableString()
     TableStr += TEXT("============================================\n");
     
     // 按DroneID排序
-    TArray<int32> DroneIDs;
-    ReservationTable.GetKeys(DroneIDs);
-    DroneIDs.Sort();
-
-    for (int32 DroneID : DroneIDs)
+    for (int32 DroneID : ReservationTable.GetDroneIDs())
     {
-        const FDroneReservation& Reservation = ReservationTable[DroneID];
         TableStr += FString::Printf(TEXT("\n无人机 %d 的预约:\n"), DroneID);
         TableStr += TEXT("--------------------------------------------\n");
         TableStr += TEXT("时间点\t\t位置\t\t\t安全区域\n");
         
-        for (const FSpaceTimePoint& Point : Reservation.PathPoints)
+        for (const DronePlanning::FSpaceTimeSample& Point : *ReservationTable.Find(DroneID))
         {
             TableStr += FString::Printf(TEXT("%s\t%s\t半径160cm\n"),
                 *TimeToString(Point.AbsTime),
-                *PositionToString(Point.Position));
+                *PositionToString(ToFVector(Point.Position)));
         }
     }
     
@@ -764,21 +738,19 @@ void UAStarPathFinderComponent::VisualizeReservationTable()
     };
 
     // 按DroneID排序
-    TArray<int32> DroneIDs;
-    ReservationTable.GetKeys(DroneIDs);
-    DroneIDs.Sort();
+    const std::vector<int32_t> DroneIDs = ReservationTable.GetDroneIDs();
 
     // 可视化每个无人机的预约点
-    for (int32 Index = 0; Index < DroneIDs.Num(); ++Index)
+    for (int32 Index = 0; Index < (int32)DroneIDs.size(); ++Index)
     {
         int32 DroneID = DroneIDs[Index];
-        const FDroneReservation& Reservation = ReservationTable[DroneID];
+        const DronePlanning::FReservationTable::FSampleList& Samples = *ReservationTable.Find(DroneID);
         FColor DroneColor = DroneColors[Index % DroneColors.Num()];
 
         // 绘制路径点和安全区域
-        for (int32 i = 0; i < Reservation.PathPoints.Num(); ++i)
+        for (int32 i = 0; i < (int32)Samples.size(); ++i)
         {
-            const FSpaceTimePoint& Point = Reservation.PathPoints[i];
+            const FSpaceTimePoint Point(ToFVector(Samples[i].Position), Samples[i].AbsTime);
             
             // 绘制点
             DrawDebugPoint(
@@ -804,13 +776,12 @@ void UAStarPathFinderComponent::VisualizeReservationTable()
             );
 
             // 如果不是最后一个点，绘制到下一个点的连线
-            if (i < Reservation.PathPoints.Num() - 1)
+            if (i < (int32)Samples.size() - 1)
             {
-                const FSpaceTimePoint& NextPoint = Reservation.PathPoints[i + 1];
                 DrawDebugLine(
                     World,
                     Point.Position,
-                    NextPoint.Position,
+                    ToFVector(Samples[i + 1].Position),
                     DroneColor,
                     false,   // 持久化
                     5.0f,    // 显示时间
@@ -5,11 +5,18 @@
 #include "Components/ActorComponent.h"
 #include "Components/SplineComponent.h"
 #include "GridMapComponent.h"
+#include "PlanningCore/AStarPlanner.h"
+#include "PlanningCore/BatchPlanner.h"
+#include "PlanningCore/ConflictBasedPlanner.h"
+#include "PlanningCore/ReservationTable.h"
 #include "AStarPathFinderComponent.generated.h"
 
 // 定义碰撞检测回调函数类型
 DECLARE_DELEGATE_RetVal_OneParam(bool, FCollisionCheckDelegate, const FVector&);
 
+// 异步规划完成回调（在游戏线程上调用）
+DECLARE_DELEGATE_TwoParams(FOnPathPlanned, bool /*bSuccess*/, const TArray<FVector>& /*Path*/);
+
 USTRUCT(BlueprintType)
 struct FSpaceTimePoint
 {
@@ -37,6 +44,32 @@ struct FDroneReservation
     FDroneReservation(const TArray<FSpaceTimePoint>& InPoints) : PathPoints(InPoints) {}
 };
 
+// 栅格搜索方式
+UENUM(BlueprintType)
+enum class EPathSearchMode : uint8
+{
+    // 逐格扩展26邻域
+    AStar       UMETA(DisplayName = "A*"),
+
+    // 跳点搜索：开阔区域只扩展跳点，路径代价与A*相同（存在预约冲突时可能更长）
+    JumpPoint   UMETA(DisplayName = "Jump Point Search"),
+};
+
+class UAStarPathFinderComponent;
+
+// 批量规划的单个任务（数组顺序即优先级）
+struct FBatchPathTask
+{
+    UAStarPathFinderComponent* PathFinder = nullptr;
+    FVector Start = FVector::ZeroVector;
+    FVector Goal = FVector::ZeroVector;
+    int32 DroneID = -1;
+
+    // 输出
+    TArray<FVector> Path;
+    bool bSuccess = false;
+};
+
 UCLASS(ClassGroup=(PathPlanning), meta=(BlueprintSpawnableComponent))
 class DRONE_API UAStarPathFinderComponent : public UActorComponent
 {
@@ -50,6 +83,30 @@ public:
     UFUNCTION(BlueprintCallable, Category="PathPlanning|AStar")
     bool FindPath(const FVector& Start, const FVector& Goal, TArray<FVector>& OutPath, int32 DroneID);
     
+    // 在后台线程上寻路：网格与预约表取快照，结果在游戏线程通过OnComplete返回并写入预约表。
+    // 同一组件同时只有一个任务在运行；运行期间的新请求只保留最新一个，旧请求的回调不会触发。
+    // 规划期间预约表或地图发生变化时，提交前按当前状态重新检查路径，不再可行则重新规划
+    void FindPathAsync(const FVector& Start, const FVector& Goal, int32 DroneID, FOnPathPlanned OnComplete);
+    
+    // 提交在组件外规划的原始路径（如PathModifier的增量重规划）：与其他无人机的预约冲突时返回false；
+    // 否则平滑后写入预约表并取代尚未返回的异步请求，OutPath为平滑后的路径
+    bool CommitExternalPath(const std::vector<DronePlanning::FVec3>& RawPath, int32 DroneID, TArray<FVector>& OutPath);
+    
+    // 取消尚未返回的异步请求（同步FindPath也会取消它们）
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|AStar")
+    void CancelAsyncPath();
+    
+    UFUNCTION(BlueprintPure, Category="PathPlanning|AStar")
+    bool IsAsyncPathPending() const { return bAsyncPlanInFlight; }
+    
+    // 批量优先级规划：每个任务只规划一次，时空走廊互不相交的无人机在工作线程上并行搜索，
+    // 结果按优先级写入预约表。所有任务须共用同一个GridMap，单次搜索预算与AnytimeInitialWeight取自各自的PathFinder
+    static DronePlanning::FBatchStats FindPathsBatch(TArray<FBatchPathTask>& Tasks);
+    
+    // 联合规划（CBS/ECBS）：底层为A*，在约束树上一并消解任务之间的时空冲突；SuboptimalityBound为解代价相对最优的上界，
+    // BudgetMicros内未找到无冲突解时按FindPathsBatch的优先级规划。数组顺序只影响退回时的优先级
+    static DronePlanning::FConflictSearchStats FindPathsJoint(TArray<FBatchPathTask>& Tasks, float SuboptimalityBound, int64 BudgetMicros);
+    
     // 获取保存的路径
     UFUNCTION(BlueprintCallable, Category="PathPlanning|AStar")
     TArray<FVector> GetSearchedPath();
@@ -64,6 +121,31 @@ public:
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
     float DroneSpeed = 100.0f;
+
+    // 跳点搜索的扩展数远少于A*，但每次跳跃要逐格扫描直线与对角线（有预约时每步还要检查冲突），实际耗时不一定更短：
+    // 200x200x20格、60个障碍物的合成地图上20次查询，扩展数3,576对80,969（约少20倍），耗时与A*相当或更长（约0.7x-1.0x）。
+    // 默认使用A*，切换前应在目标地图上用DronePlanningBench --search compare测量
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
+    EPathSearchMode SearchMode = EPathSearchMode::AStar;
+
+    // 每次搜索的实际耗时上限（微秒，单调时钟），<=0表示不限时；同步与异步规划、分层回退各自按此计时
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
+    int32 SearchBudgetMicros = 1000000;
+
+    // 大于1时启用任意时间搜索（ARA*）：先按放大的启发式快速找到路径，再在预算内逐步收紧到最优，
+    // 预算用完时返回已找到的最好路径（代价不超过最优的该倍数）。JumpPoint模式不使用
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar", meta=(ClampMin="1.0", ClampMax="10.0"))
+    float AnytimeInitialWeight = 1.0f;
+    
+    // 逐格搜索超出步数/时间上限时（长距离航线），改用分层寻路器（HPA*）重新规划：同步与批量规划使用GridMap共享的寻路器，
+    // 异步规划在同一后台任务内对地图快照规划。分层路径不考虑预约表，与其他无人机冲突时仍判为失败
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
+    bool bHierarchicalFallback = true;
+    
+    // 复用GridMap共享的规划结果缓存：起点/终点落在同一量化块内、且路径经过的区域未变化时，
+    // 修补缓存路径的首尾并检查预约冲突后直接使用，不再搜索
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
+    bool bUsePathCache = true;
     
     // 设置路径点间距
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|AStar")
@@ -89,9 +171,12 @@ public:
 
     // 添加静态访问方法
     static void AddReservation(int32 DroneID, const FDroneReservation& Reservation);
-    static const TMap<int32, FDroneReservation>& GetReservationTable();
+    static const DronePlanning::FReservationTable& GetReservationTable();
     static void ClearReservationTable();
 
+    // 将DroneID在FromTime之后的预约整体推迟Delay秒（无人机临时悬停时使用）
+    static void DelayReservation(int32 DroneID, float FromTime, float Delay);
+
     // 生成预约表可视化
     UFUNCTION(BlueprintCallable, Category="PathPlanning|AStar")
     static void VisualizeReservationTable();
@@ -104,6 +189,7 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 private:
@@ -115,33 +201,88 @@ private:
     TArray<FVector> StoredPath;
     TArray<FVector> CurrentPath;
     
-    // 启发式函数
-    float GetDiagonalHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2);
-    float GetManhattanHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2);
-    float GetEuclideanHeuristic(int X1, int Y1, int Z1, int X2, int Y2, int Z2);
-    
-    // 计算两个节点间的距离
-    float Distance(struct FAStarNode* A, struct FAStarNode* B);
-    
-    // 获取周围的临近节点（优化版本）
-    void GetNeighborsOptimized(struct FAStarNode* Node, TArray<struct FAStarNode*>& OutNeighbors, int32 GoalX, int32 GoalY, int32 GoalZ);
-    
-    // 重建路径
-    void ReconstructPath(struct FAStarNode* GoalNode, TArray<FVector>& OutPath);
+    // 引擎无关的A*规划器（搜索、平滑与预约表均在PlanningCore中实现）
+    DronePlanning::FAStarPlanner Planner;
 
-    // 检查路径点是否安全
-    bool IsPathPointSafe(const FVector& Point) const;
+    struct FAsyncPathRequest
+    {
+        FVector Start;
+        FVector Goal;
+        int32 DroneID;
+        FOnPathPlanned OnComplete;
 
-    // 获取路径点的安全距离
-    float GetSafetyDistance() const { return DroneRadius * SafetyFactor; }
+        // 结果因预约表/地图在规划期间变化而失效后重新规划的次数
+        int32 Attempt = 0;
+    };
+
+    // 任务启动时的状态：结果返回时据此判断是否已被取代，以及规划所用的快照是否已过时
+    struct FAsyncPlanStamp
+    {
+        uint32 Serial = 0;
+        uint64 CacheEpoch = 0;
+        uint32 ReservationVersion = 0;
+        uint32 GridVersion = 0;
+        int32 Attempt = 0;
+    };
+
+    // 后台任务的结果。逐格搜索超出步数/时间上限时任务内改用分层寻路器，Status为回退后的结果
+    struct FAsyncPlanResult
+    {
+        DronePlanning::EPlanStatus Status = DronePlanning::EPlanStatus::NoPath;
+        DronePlanning::EPlanStatus SearchStatus = DronePlanning::EPlanStatus::NoPath;
+        bool bHierarchical = false;
+        int32 Expansions = 0;
+
+        // 平滑后的路径与平滑前的原始路径
+        std::vector<DronePlanning::FVec3> Path;
+        std::vector<DronePlanning::FVec3> RawPath;
+    };
+
+    // 后台任务独占的规划器；同一时间只有一个任务使用，任务结束前不会启动下一个
+    TSharedPtr<DronePlanning::FAStarPlanner, ESPMode::ThreadSafe> AsyncPlanner;
+
+    // 后台任务的分层回退规划器（与AsyncPlanner一样由任务独占）。区块按任务的地图快照构建，快照更换后整体丢弃
+    struct FAsyncHierarchicalPlanner
+    {
+        DronePlanning::FHierarchicalPlanner Planner;
+        TWeakPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> ClusterGrid;
+    };
+    TSharedPtr<FAsyncHierarchicalPlanner, ESPMode::ThreadSafe> AsyncHierarchicalPlanner;
+    TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> AsyncCancelFlag;
+    bool bAsyncPlanInFlight = false;
 
-    // 检查两点之间是否可以直线到达
-    bool CanReachDirectly(const FVector& Start, const FVector& Goal);
+    // 运行中任务的序号；取消时递增，使返回的结果失效
+    uint32 AsyncPlanSerial = 0;
+    FOnPathPlanned InFlightCallback;
 
-    // 平滑路径
-    void SmoothPath(TArray<FVector>& InOutPath);
+    // 任务运行期间合并的最新请求
+    TOptional<FAsyncPathRequest> PendingAsyncRequest;
 
-    FVector GetObstacleRepulsionForce(const FVector& Point);
+    void LaunchAsyncPlan(FAsyncPathRequest&& AsyncRequest);
+    void OnAsyncPlanFinished(const FAsyncPlanStamp& Stamp, FAsyncPlanResult&& Result, const DronePlanning::FPlanRequest& Request);
+
+    // 快照规划出的路径在当前地图上是否仍然可行：逐段不穿过占用格子，且不与其他无人机的预约冲突
+    bool IsPlannedPathStillValid(const std::vector<DronePlanning::FVec3>& Path, int32 DroneID) const;
+
+    DronePlanning::FPlanRequest MakePlanRequest(const FVector& Start, const FVector& Goal, int32 DroneID) const;
+
+    // 平滑原始路径并写入预约表，OutPath为平滑后的路径
+    void CommitPath(const std::vector<DronePlanning::FVec3>& RawPath, int32 DroneID, TArray<FVector>& OutPath);
+
+    // 规划结果缓存命中时提交缓存路径（取代尚未返回的异步请求），见bUsePathCache
+    bool TryCachedPath(const DronePlanning::FPlanRequest& Request, TArray<FVector>& OutPath);
+
+    // 逐格搜索因步数/时间上限失败后用分层寻路器重新规划并提交（见bHierarchicalFallback）
+    bool TryHierarchicalFallback(DronePlanning::EPlanStatus Status, const DronePlanning::FVec3& Start, const DronePlanning::FVec3& Goal,
+        int32 DroneID, TArray<FVector>& OutPath);
+
+    // 获取路径点的安全距离
+    float GetSafetyDistance() const { return DroneRadius * SafetyFactor; }
+
+    DronePlanning::ESearchMode GetPlanningSearchMode() const
+    {
+        return SearchMode == EPathSearchMode::JumpPoint ? DronePlanning::ESearchMode::JumpPoint : DronePlanning::ESearchMode::AStar;
+    }
 
     // 碰撞检测回调
     FCollisionCheckDelegate CollisionCheckCallback;
@@ -152,10 +293,27 @@ private:
         return CollisionCheckCallback.IsBound() ? CollisionCheckCallback.Execute(Point) : false;
     }
 
-    bool IsSpaceTimeConflict(const FVector& Position, float AbsTime, int32 SelfDroneID) const;
-    
     // 将 ReservationTable 改为静态成员
-    static TMap<int32, FDroneReservation> ReservationTable;
+    static DronePlanning::FReservationTable ReservationTable;
+
+    // 批量规划器，跨批次复用各工作线程的节点池（只在游戏线程上调用）
+    static DronePlanning::FBatchPlanner BatchPlanner;
+
+    // 联合规划器（只在游戏线程上调用）
+    static DronePlanning::FConflictBasedPlanner ConflictPlanner;
+
+    // 批量/联合规划的公共部分：由任务生成查询（取消各自尚未返回的异步请求），返回共用的GridMap；
+    // 以及把结果写回任务（失败时尝试分层回退）
+    static UGridMapComponent* MakeBatchQueries(TArray<FBatchPathTask>& Tasks, std::vector<DronePlanning::FBatchQuery>& OutQueries,
+        TArray<int32>& OutTaskIndices);
+    static void ApplyBatchResults(TArray<FBatchPathTask>& Tasks, const TArray<int32>& TaskIndices,
+        const std::vector<DronePlanning::FBatchResult>& Results);
+
+    // 预约表每次修改时递增；后台规划共享同一版本的快照
+    static uint32 ReservationVersion;
+    static TSharedPtr<const DronePlanning::FReservationTable, ESPMode::ThreadSafe> ReservationSnapshot;
+    static uint32 ReservationSnapshotVersion;
+    static TSharedRef<const DronePlanning::FReservationTable, ESPMode::ThreadSafe> GetReservationSnapshot();
 
     float ProgramStartTime = 0.0f;
 
@@ -1,4 +1,5 @@
 #include "DroneActor.h"
+#include "DroneRegistry.h"
 #include "DrawDebugHelpers.h"
 #include "InputCoreTypes.h"
 #include "Misc/FileHelper.h"
@@ -56,11 +57,8 @@ void ADroneActor::BeginPlay()
     {
         // 启用物理模拟
         DroneMesh->SetSimulatePhysics(true);
-        // 设置碰撞响应
-        DroneMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-        DroneMesh->SetCollisionObjectType(ECollisionChannel::ECC_PhysicsBody);
-        // 对所有通道启用碰撞
-        DroneMesh->SetCollisionResponseToAllChannels(ECR_Block);
+        // 设置碰撞响应：无人机预设为PhysicsBody，阻挡除障碍扫描通道外的所有通道
+        DroneMesh->SetCollisionProfileName(FDroneRegistry::CollisionProfileName);
         // 设置物理材质参数
         if (UPrimitiveComponent* PrimComp = Cast<UPrimitiveComponent>(DroneMesh))
         {
@@ -88,6 +86,15 @@ void ADroneActor::BeginPlay()
     {
         UE_LOG(LogTemp, Error, TEXT("[Drone %d] PathModifier组件未找到!"), DroneID);
     }
+
+    // 加入群体注册表，扫描时据此忽略所有无人机
+    FDroneRegistry::Register(this);
+}
+
+void ADroneActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    FDroneRegistry::Unregister(this);
+    Super::EndPlay(EndPlayReason);
 }
 
 void ADroneActor::SetupGridMapReferences(UGridMapComponent* InGridMap)
@@ -210,7 +217,7 @@ void ADroneActor::ClearDrawnPath()
     }
 }
 
-void ADroneActor::SetGoalLocation(const FVector& NewGoal)
+void ADroneActor::SetGoalLocation(const FVector& NewGoal, bool bPlanPath)
 {
     // 校验目标点是否在地图范围内
     bool bGoalInsideGrid = true;
@@ -238,17 +245,27 @@ void ADroneActor::SetGoalLocation(const FVector& NewGoal)
 
     GoalLocation = NewGoal;
     UE_LOG(LogTemp, Log, TEXT("[Drone %d] 设置目标位置: %s"), DroneID, *NewGoal.ToString());
-    if (PathFinder->FindPath(GetActorLocation(), NewGoal, CurrentPath, DroneID))
+    if (!bPlanPath)
     {
-        SetPath(CurrentPath);
-        // UE_LOG(LogTemp, Log, TEXT("[Drone %d] 路径重规划成功，新路径点数: %d"), DroneID, CurrentPath.Num());
-    }
-    else
-    {
-        UE_LOG(LogTemp, Warning, TEXT("[Drone %d] 路径规划失败，目标点: %s"), DroneID, *NewGoal.ToString());
-        // 不清空CurrentPath，保持无人机停在原地
-        StopMovement();
+        return;
     }
+
+    // 在后台线程规划，结果返回前沿旧路径继续飞行；连续设置目标时只保留最新一次
+    PathFinder->FindPathAsync(GetActorLocation(), NewGoal, DroneID, FOnPathPlanned::CreateWeakLambda(this,
+        [this, NewGoal](bool bSuccess, const TArray<FVector>& NewPath)
+        {
+            if (bSuccess)
+            {
+                SetPath(NewPath);
+                // UE_LOG(LogTemp, Log, TEXT("[Drone %d] 路径重规划成功，新路径点数: %d"), DroneID, CurrentPath.Num());
+            }
+            else
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[Drone %d] 路径规划失败，目标点: %s"), DroneID, *NewGoal.ToString());
+                // 不清空CurrentPath，保持无人机停在原地
+                StopMovement();
+            }
+        }));
 }
 
 void ADroneActor::StartMovement()
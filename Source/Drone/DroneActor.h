@@ -18,6 +18,7 @@ public:
     ADroneActor();
 
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void Tick(float DeltaTime) override;
 
     // 获取无人机ID
@@ -44,9 +45,9 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Drone")
     UPathModifierComponent* GetPathModifier() const { return PathModifier; }
 
-    // 设置目标位置
+    // 设置目标位置（bPlanPath为false时只记录目标，由群体批量规划统一生成路径）
     UFUNCTION(BlueprintCallable, Category = "Drone")
-    void SetGoalLocation(const FVector& NewGoal);
+    void SetGoalLocation(const FVector& NewGoal, bool bPlanPath = true);
 
     // 获取目标位置
     UFUNCTION(BlueprintCallable, Category = "Drone")
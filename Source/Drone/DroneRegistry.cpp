@@ -0,0 +1,89 @@
+// DroneRegistry.cpp
+#include "DroneRegistry.h"
+#include "DroneActor.h"
+#include "Components/PrimitiveComponent.h"
+
+const FName FDroneRegistry::CollisionProfileName(TEXT("Drone"));
+TArray<TWeakObjectPtr<ADroneActor>> FDroneRegistry::Drones;
+TSet<FObjectKey> FDroneRegistry::DroneComponents;
+FCollisionQueryParams FDroneRegistry::IgnoreDronesQueryParams;
+uint32 FDroneRegistry::Version = 0;
+
+namespace
+{
+    // 无人机自身及附加在其上的所有碰撞组件（包括其他Actor的组件）
+    void GatherDronePrimitives(ADroneActor* Drone, TArray<UPrimitiveComponent*>& OutPrimitives)
+    {
+        TArray<USceneComponent*> Components;
+        Drone->GetComponents<USceneComponent>(Components);
+        for (USceneComponent* Component : Components)
+        {
+            TArray<USceneComponent*> Children;
+            Component->GetChildrenComponents(true, Children);
+            Children.Add(Component);
+            for (USceneComponent* Child : Children)
+            {
+                if (UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Child))
+                {
+                    OutPrimitives.AddUnique(Primitive);
+                }
+            }
+        }
+    }
+}
+
+void FDroneRegistry::Register(ADroneActor* Drone)
+{
+    if (!Drone)
+    {
+        return;
+    }
+
+    // 碰撞预设缺失或被蓝图覆盖时也保证扫描射线不会命中无人机
+    TArray<UPrimitiveComponent*> Primitives;
+    GatherDronePrimitives(Drone, Primitives);
+    for (UPrimitiveComponent* Primitive : Primitives)
+    {
+        Primitive->SetCollisionResponseToChannel(ScanTraceChannel, ECR_Ignore);
+    }
+
+    Drones.AddUnique(Drone);
+    RebuildIgnoreSet();
+}
+
+void FDroneRegistry::Unregister(ADroneActor* Drone)
+{
+    if (Drones.Remove(Drone) > 0)
+    {
+        RebuildIgnoreSet();
+    }
+}
+
+bool FDroneRegistry::IsDroneComponent(const UPrimitiveComponent* Component)
+{
+    return Component && DroneComponents.Contains(FObjectKey(Component));
+}
+
+void FDroneRegistry::RebuildIgnoreSet()
+{
+    Drones.RemoveAll([](const TWeakObjectPtr<ADroneActor>& Drone) { return !Drone.IsValid(); });
+
+    DroneComponents.Reset();
+    IgnoreDronesQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(DroneRegistryIgnore));
+    for (const TWeakObjectPtr<ADroneActor>& Drone : Drones)
+    {
+        IgnoreDronesQueryParams.AddIgnoredActor(Drone.Get());
+
+        TArray<UPrimitiveComponent*> Primitives;
+        GatherDronePrimitives(Drone.Get(), Primitives);
+        for (UPrimitiveComponent* Primitive : Primitives)
+        {
+            DroneComponents.Add(FObjectKey(Primitive));
+            IgnoreDronesQueryParams.AddIgnoredComponent(Primitive);
+        }
+    }
+
+    Version++;
+    UE_LOG(LogTemp, Log, TEXT("DroneRegistry: %d drones, %d ignored components (version %u)"),
+        Drones.Num(), DroneComponents.Num(), Version);
+}
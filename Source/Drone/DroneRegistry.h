@@ -0,0 +1,43 @@
+// DroneRegistry.h
+// 群体无人机注册表：无人机在BeginPlay/EndPlay时注册/注销，
+// 扫描等查询直接使用预先构建好的忽略集合，不必每次遍历场景和组件
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "UObject/ObjectKey.h"
+
+class ADroneActor;
+class UPrimitiveComponent;
+
+class DRONE_API FDroneRegistry
+{
+public:
+    // 障碍扫描使用的射线通道，注册的无人机对其响应为Ignore
+    static constexpr ECollisionChannel ScanTraceChannel = ECC_GameTraceChannel1;
+
+    // Config/DefaultEngine.ini中定义的无人机碰撞预设（阻挡所有通道，忽略ScanTraceChannel）
+    static const FName CollisionProfileName;
+
+    static void Register(ADroneActor* Drone);
+    static void Unregister(ADroneActor* Drone);
+
+    // 每次注册/注销时递增，调用方可据此判断缓存的查询参数是否过期
+    static uint32 GetVersion() { return Version; }
+
+    static const TArray<TWeakObjectPtr<ADroneActor>>& GetDrones() { return Drones; }
+
+    // 忽略所有已注册无人机及其组件的查询参数
+    static const FCollisionQueryParams& GetIgnoreDronesQueryParams() { return IgnoreDronesQueryParams; }
+
+    // 组件是否属于某架无人机（哈希查找，注册表不变时可在工作线程上调用）
+    static bool IsDroneComponent(const UPrimitiveComponent* Component);
+
+private:
+    static TArray<TWeakObjectPtr<ADroneActor>> Drones;
+    static TSet<FObjectKey> DroneComponents;
+    static FCollisionQueryParams IgnoreDronesQueryParams;
+    static uint32 Version;
+
+    static void RebuildIgnoreSet();
+};
@@ -3,6 +3,10 @@
 #include "InputCoreTypes.h"
 #include "GameFramework/Actor.h"
 #include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "PlanningCoreConversions.h"
+#include "PlanningCore/PlanningScenario.h"
 
 
 UDroneSwarmManagerComponent::UDroneSwarmManagerComponent()
@@ -86,8 +90,8 @@ void UDroneSwarmManagerComponent::AddDrone(ADroneActor* Drone, const FVector& Go
     NewTask.StartTime = -1.0f;  // 将在规划时设置
     NewTask.EstimatedDuration = -1.0f;  // 将在规划时计算
 
-    // 设置无人机的目标位置
-    Drone->SetGoalLocation(GoalLocation);
+    // 设置无人机的目标位置（路径由StartSwarmPathPlanning统一规划，避免重复规划）
+    Drone->SetGoalLocation(GoalLocation, false);
 
     DroneTasks.Add(NewTask);
     
@@ -107,31 +111,44 @@ void UDroneSwarmManagerComponent::StartSwarmPathPlanning()
 
     // 获取优先级排序后的任务索引
     TArray<int32> PrioritizedIndices = GetPrioritizedTaskIndices();
+    const double PlanningBeginTime = FPlatformTime::Seconds();
 
-    // 按优先级顺序为每个无人机规划路径
-    float CurrentStartTime = 0.0f;
-    for (int32 TaskIndex : PrioritizedIndices)
+    if (bUseBatchPlanning || bUseConflictBasedSearch)
     {
-        FDronePathTask& Task = DroneTasks[TaskIndex];
-        Task.StartTime = CurrentStartTime;
+        PlanPathsInBatch(PrioritizedIndices);
+    }
+    else
+    {
+        // 按优先级顺序为每个无人机规划路径
+        float CurrentStartTime = 0.0f;
+        for (int32 TaskIndex : PrioritizedIndices)
+        {
+            FDronePathTask& Task = DroneTasks[TaskIndex];
+            Task.StartTime = CurrentStartTime;
 
-        UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Planning path for Drone %d (Priority Index: %d)"), 
-            Task.DroneActor->GetDroneID(), TaskIndex);
+            UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Planning path for Drone %d (Priority Index: %d)"), 
+                Task.DroneActor->GetDroneID(), TaskIndex);
 
-        if (PlanPathForDrone(Task))
-        {
-            // 更新下一个无人机的开始时间
-            CurrentStartTime += Task.EstimatedDuration;
-            UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Successfully planned path for Drone %d. Start Time: %.2f, Duration: %.2f"), 
-                Task.DroneActor->GetDroneID(), Task.StartTime, Task.EstimatedDuration);
-        }
-        else
-        {
-            UE_LOG(LogTemp, Error, TEXT("[SwarmManager] Failed to plan path for Drone %d"), 
-                Task.DroneActor->GetDroneID());
+            if (PlanPathForDrone(Task))
+            {
+                // 更新下一个无人机的开始时间
+                CurrentStartTime += Task.EstimatedDuration;
+                UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Successfully planned path for Drone %d. Start Time: %.2f, Duration: %.2f"), 
+                    Task.DroneActor->GetDroneID(), Task.StartTime, Task.EstimatedDuration);
+            }
+            else
+            {
+                UE_LOG(LogTemp, Error, TEXT("[SwarmManager] Failed to plan path for Drone %d"), 
+                    Task.DroneActor->GetDroneID());
+            }
         }
     }
 
+    LastPlanningWallTimeMs = (float)((FPlatformTime::Seconds() - PlanningBeginTime) * 1000.0);
+    UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Path planning for %d drones took %.2f ms (%s)"),
+        DroneTasks.Num(), LastPlanningWallTimeMs,
+        bUseConflictBasedSearch ? TEXT("joint") : bUseBatchPlanning ? TEXT("batch") : TEXT("sequential"));
+
     // 显示预约表
     // UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Displaying reservation table..."));
     // UAStarPathFinderComponent::VisualizeReservationTable();
@@ -225,6 +242,60 @@ bool UDroneSwarmManagerComponent::PlanPathForDrone(FDronePathTask& DroneTask)
 
 
 
+void UDroneSwarmManagerComponent::PlanPathsInBatch(const TArray<int32>& PrioritizedIndices)
+{
+    TArray<FBatchPathTask> BatchTasks;
+    TArray<int32> BatchTaskIndices;
+    for (int32 TaskIndex : PrioritizedIndices)
+    {
+        FDronePathTask& Task = DroneTasks[TaskIndex];
+        Task.PlannedPath.Empty();
+        if (!Task.DroneActor || !Task.DroneActor->GetPathFinder())
+        {
+            UE_LOG(LogTemp, Error, TEXT("[SwarmManager] Cannot plan path: Invalid drone or PathFinder (Task %d)"), TaskIndex);
+            continue;
+        }
+
+        FBatchPathTask& BatchTask = BatchTasks.AddDefaulted_GetRef();
+        BatchTask.PathFinder = Task.DroneActor->GetPathFinder();
+        BatchTask.Start = Task.StartLocation;
+        BatchTask.Goal = Task.GoalLocation;
+        BatchTask.DroneID = Task.DroneActor->GetDroneID();
+        BatchTaskIndices.Add(TaskIndex);
+    }
+
+    if (bUseConflictBasedSearch)
+    {
+        UAStarPathFinderComponent::FindPathsJoint(BatchTasks, ConflictSuboptimalityBound, (int64)(ConflictSearchBudgetMs * 1000.0f));
+    }
+    else
+    {
+        UAStarPathFinderComponent::FindPathsBatch(BatchTasks);
+    }
+
+    for (int32 BatchIndex = 0; BatchIndex < BatchTasks.Num(); ++BatchIndex)
+    {
+        FBatchPathTask& BatchTask = BatchTasks[BatchIndex];
+        FDronePathTask& Task = DroneTasks[BatchTaskIndices[BatchIndex]];
+        Task.StartTime = 0.0f;
+        if (!BatchTask.bSuccess)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[SwarmManager] Failed to plan path for Drone %d"), BatchTask.DroneID);
+            continue;
+        }
+
+        Task.PlannedPath = MoveTemp(BatchTask.Path);
+        float PathLength = 0.0f;
+        for (int32 i = 0; i + 1 < Task.PlannedPath.Num(); ++i)
+        {
+            PathLength += FVector::Dist(Task.PlannedPath[i], Task.PlannedPath[i + 1]);
+        }
+        Task.EstimatedDuration = PathLength / FMath::Max(BatchTask.PathFinder->DroneSpeed, KINDA_SMALL_NUMBER);
+        UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Successfully planned path for Drone %d: %d waypoints, duration: %.2f"),
+            BatchTask.DroneID, Task.PlannedPath.Num(), Task.EstimatedDuration);
+    }
+}
+
 TArray<int32> UDroneSwarmManagerComponent::GetPrioritizedTaskIndices()
 {
     // 创建索引数组
@@ -281,3 +352,32 @@ void UDroneSwarmManagerComponent::ReplayAllDronesPath()
     }
 }
 
+bool UDroneSwarmManagerComponent::SavePlanningScenario(const FString& Directory)
+{
+    if (!GridMap)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[SwarmManager] Cannot save scenario: GridMap component not found!"));
+        return false;
+    }
+
+    IFileManager::Get().MakeDirectory(*Directory, true);
+    const FString MapFile = FPaths::Combine(Directory, TEXT("GridMap.bin"));
+    const FString QueryFile = FPaths::Combine(Directory, TEXT("Queries.txt"));
+
+    std::vector<DronePlanning::FPlanQuery> Queries;
+    for (const FDronePathTask& Task : DroneTasks)
+    {
+        if (!Task.DroneActor) continue;
+        DronePlanning::FPlanQuery Query;
+        Query.DroneID = Task.DroneActor->GetDroneID();
+        Query.Start = ToPlanningVec(Task.StartLocation);
+        Query.Goal = ToPlanningVec(Task.GoalLocation);
+        Queries.push_back(Query);
+    }
+
+    const bool bSaved = GridMap->SaveMapToFile(MapFile)
+        && DronePlanning::SaveQueriesToFile(TCHAR_TO_UTF8(*QueryFile), Queries);
+    UE_LOG(LogTemp, Log, TEXT("[SwarmManager] Saved planning scenario (%d queries) to %s: %s"),
+        (int32)Queries.size(), *Directory, bSaved ? TEXT("OK") : TEXT("FAILED"));
+    return bSaved;
+}
@@ -75,8 +75,33 @@ public:
     // 当前是否处于暂停状态
     bool bIsSwarmPaused = false;
 
+    // 批量规划：每架无人机只规划一次，时空走廊互不相交的无人机并行规划；关闭时按优先级逐个规划
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DroneSwarm")
+    bool bUseBatchPlanning = true;
+
+    // 联合规划（CBS/ECBS）：先为每架无人机单独规划，再在约束树上一并消解路径之间的时空冲突，
+    // 避免高优先级路径堵住狭窄通道后低优先级无人机失败或大幅绕行。开启时优先于bUseBatchPlanning
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DroneSwarm|Joint Planning")
+    bool bUseConflictBasedSearch = false;
+
+    // 解的总代价不超过约束树最优解的该倍数；1为标准CBS，越大越快
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DroneSwarm|Joint Planning", meta=(ClampMin="1.0", ClampMax="10.0"))
+    float ConflictSuboptimalityBound = 1.5f;
+
+    // 联合规划的时间预算（毫秒），用完仍有冲突时改为按优先级规划
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DroneSwarm|Joint Planning", meta=(ClampMin="1.0"))
+    float ConflictSearchBudgetMs = 200.0f;
+
+    // 最近一次StartSwarmPathPlanning的总墙钟耗时（毫秒）
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "DroneSwarm|Stats")
+    float LastPlanningWallTimeMs = 0.0f;
+
     void ReplayAllDronesPath();
 
+    // 录制当前地图与所有无人机的起终点，供无头基准测试回放
+    UFUNCTION(BlueprintCallable, Category = "DroneSwarm")
+    bool SavePlanningScenario(const FString& Directory);
+
 protected:
     virtual void BeginPlay() override;
 
@@ -92,6 +117,9 @@ private:
     // Plan path for a single drone
     bool PlanPathForDrone(FDronePathTask& DroneTask);
 
+    // Plan all drones in one batch (priority order, parallel where corridors are disjoint; jointly with CBS when enabled)
+    void PlanPathsInBatch(const TArray<int32>& PrioritizedIndices);
+
     // Get prioritized task indices
     TArray<int32> GetPrioritizedTaskIndices();
 
@@ -181,7 +181,8 @@ void ADroneSwarmTestActor::BeginPlay()
         GridMapSize = MapSize;
 
         // --------- 自适应分辨率 ---------
-        const int32 MaxGridCount = 500; // 最大格子数
+        // 稀疏存储的内存只随障碍物占据的空间增长，可以用更多格子换取更高的分辨率
+        const int32 MaxGridCount = GridMap && GridMap->bSparseStorage ? 10000 : 500; // 最大格子数
         float MaxMapEdge = FMath::Max(GridMapSize.X, GridMapSize.Y);
         LocalGridResolution = MaxMapEdge / MaxGridCount;
         if (LocalGridResolution < 20.0f)
@@ -1,25 +1,30 @@
 // GridMapComponent.cpp
 #include "GridMapComponent.h"
+#include "PlanningCoreConversions.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/PrimitiveComponent.h"
 #include "GameFramework/Actor.h"
 #include "Engine/StaticMeshActor.h"
 
+namespace
+{
+    // 世界坐标所在的网格坐标，允许落在地图外（用于构造随后再裁剪的包围盒）
+    DronePlanning::FIntVec3 WorldToCellUnclamped(const DronePlanning::FOccupancyGrid& Grid, const FVector& WorldPos)
+    {
+        DronePlanning::FIntVec3 Cell;
+        Grid.WorldToGrid(ToPlanningVec(WorldPos), Cell.X, Cell.Y, Cell.Z);
+        return Cell;
+    }
+}
+
 UGridMapComponent::UGridMapComponent()
 {
     PrimaryComponentTick.bCanEverTick = true;
     
-    // Default values
-    MapOrigin = FVector::ZeroVector;
-    MapSize = FVector(50.0f, 50.0f, 10.0f);
-    CellSize = 10.0f;
+    // Default values (grid stays empty until InitializeMap)
     InflationRadius = 0.3f;
     
-    GridDimX = 0;
-    GridDimY = 0;
-    GridDimZ = 0;
-    
     bAutomaticObstacleDetection = true;
 }
 
@@ -46,36 +51,25 @@ void UGridMapComponent::BeginPlay()
 void UGridMapComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    
+    // 本帧内的所有占用变化合并为一次广播
+    FlushDirtyRegion();
 }
 
 void UGridMapComponent::InitializeMap(FVector Origin, FVector Size, float Resolution)
 {
-    MapOrigin = Origin - Size / 2.0f; // Center the map at Origin
-    MapSize = Size;
-    CellSize = Resolution;
+    // Center the map at Origin
+    Grid.Initialize(ToPlanningVec(Origin - Size / 2.0f), ToPlanningVec(Size), Resolution, bSparseStorage);
+    OccupancyLogOdds.Reset();
+    GridVersion++;
+    MarkWholeMapDirty();
     
-    // Calculate grid dimensions
-    GridDimX = FMath::CeilToInt(Size.X / CellSize);
-    GridDimY = FMath::CeilToInt(Size.Y / CellSize);
-    GridDimZ = FMath::CeilToInt(Size.Z / CellSize);
-    
-    // Initialize 3D grid
-    OccupancyGrid.SetNum(GridDimX);
-    for (int x = 0; x < GridDimX; x++)
-    {
-        OccupancyGrid[x].SetNum(GridDimY);
-        for (int y = 0; y < GridDimY; y++)
-        {
-            OccupancyGrid[x][y].SetNum(GridDimZ);
-            for (int z = 0; z < GridDimZ; z++)
-            {
-                OccupancyGrid[x][y][z] = false; // Not occupied by default
-            }
-        }
-    }
     if (GetOwner())
         UE_LOG(LogTemp, Warning, TEXT("GridMapComponent Owner: %s"), *GetOwner()->GetName());
-    UE_LOG(LogTemp, Log, TEXT("Grid map initialized: %d x %d x %d cells"), GridDimX, GridDimY, GridDimZ);
+    UE_LOG(LogTemp, Log, TEXT("Grid map initialized: %d x %d x %d cells (%s, %.1f MB)"), Grid.GetDimX(), Grid.GetDimY(), Grid.GetDimZ(),
+        Grid.IsSparse() ? TEXT("sparse") : TEXT("dense"), Grid.GetAllocatedBytes() / (1024.0 * 1024.0));
+    const FVector MapOrigin = GetMapOrigin();
+    const FVector MapSize = GetMapSize();
     UE_LOG(LogTemp, Warning, TEXT("MapOrigin: (%.2f, %.2f, %.2f), MapSize: (%.2f, %.2f, %.2f)"),
     MapOrigin.X, MapOrigin.Y, MapOrigin.Z, MapSize.X, MapSize.Y, MapSize.Z);
 }
@@ -83,7 +77,7 @@ void UGridMapComponent::InitializeMap(FVector Origin, FVector Size, float Resolu
 
 void UGridMapComponent::AddCylindricalObstacles(const TArray<FVector>& Positions, float Radius, float Height, float InInflationRadius)
 {
-    if (GridDimX == 0 || GridDimY == 0 || GridDimZ == 0)
+    if (!Grid.IsInitialized())
     {
         UE_LOG(LogTemp, Warning, TEXT("Grid map not initialized"));
         return;
@@ -93,6 +87,9 @@ void UGridMapComponent::AddCylindricalObstacles(const TArray<FVector>& Positions
     this->InflationRadius = InInflationRadius;
     
     // 閬嶅巻鎵?鏈変綅缃紝涓烘瘡涓綅缃坊鍔犲渾鏌卞舰闅滅鐗?
+    DronePlanning::FCellBounds DirtyCells;
+    int32 NumChanged = 0;
+    const float Reach = Radius + InInflationRadius;
     for (const FVector& Position : Positions)
     {
         // 淇濆瓨鐪熷疄闅滅鐗╁弬鏁?
@@ -102,64 +99,24 @@ void UGridMapComponent::AddCylindricalObstacles(const TArray<FVector>& Positions
         Obstacle.Height = Height;
         CylinderObstacles.Add(Obstacle);
         
-        // 璁＄畻搴曢儴鍜岄《閮ㄧ殑Z鍧愭爣
-        float BottomZ = Position.Z - Height/2;
-        float TopZ = Position.Z + Height/2;
-        
-        // 鑾峰彇XY骞抽潰涓婂渾鐨勮寖鍥?
-        int MinGridX, MinGridY, MinGridZ;
-        int MaxGridX, MaxGridY, MaxGridZ;
-        
-        // 鍦嗘煴鐨勬渶灏忓鍖呯洅
-        FVector MinPoint(Position.X - Radius, Position.Y - Radius, BottomZ);
-        FVector MaxPoint(Position.X + Radius, Position.Y + Radius, TopZ);
-        
-        // 杞崲涓虹綉鏍煎潗鏍?
-        WorldToGrid(MinPoint, MinGridX, MinGridY, MinGridZ);
-        WorldToGrid(MaxPoint, MaxGridX, MaxGridY, MaxGridZ);
-        
-        // 闄愬埗鍦ㄧ綉鏍艰寖鍥村唴
-        MinGridX = FMath::Clamp(MinGridX, 0, GridDimX-1);
-        MinGridY = FMath::Clamp(MinGridY, 0, GridDimY-1);
-        MinGridZ = FMath::Clamp(MinGridZ, 0, GridDimZ-1);
-        
-        MaxGridX = FMath::Clamp(MaxGridX, 0, GridDimX-1);
-        MaxGridY = FMath::Clamp(MaxGridY, 0, GridDimY-1);
-        MaxGridZ = FMath::Clamp(MaxGridZ, 0, GridDimZ-1);
-        
-        // 鍦嗘煴浣撲腑蹇冨湪XY骞抽潰鐨勭綉鏍煎潗鏍?
-        int CenterGridX, CenterGridY, TempZ;
-        WorldToGrid(Position, CenterGridX, CenterGridY, TempZ);
-        
-        // 鍗婂緞鐨勫钩鏂?(缃戞牸鍗曚綅)
-        float RadiusSquaredInCells = FMath::Square(Radius / CellSize);
-        
-        // 閬嶅巻骞舵爣璁板渾鏌变綋鍐呯殑鎵?鏈夌綉鏍?
-        for (int x = MinGridX; x <= MaxGridX; x++)
+        // 只膨胀新加入的圆柱，已有障碍物不会被重复膨胀
+        NumChanged += Grid.AddInflatedCylinder(ToPlanningVec(Position), Radius, Height, InInflationRadius);
+        if (OccupancyLogOdds.IsInitialized())
         {
-            for (int y = MinGridY; y <= MaxGridY; y++)
-            {
-                // 璁＄畻褰撳墠鐐瑰埌鍦嗗績XY骞抽潰璺濈鐨勫钩鏂?
-                float distSquared = FMath::Square(x - CenterGridX) + FMath::Square(y - CenterGridY);
-                
-                // 濡傛灉鍦ㄥ渾鍐?
-                if (distSquared <= RadiusSquaredInCells)
-                {
-                    // 鏍囪璇ュ瀭鐩寸嚎涓婂湪楂樺害鑼冨洿鍐呯殑鎵?鏈夌綉鏍?
-                    for (int z = MinGridZ; z <= MaxGridZ; z++)
-                    {
-                        OccupancyGrid[x][y][z] = true;
-                    }
-                }
-            }
+            OccupancyLogOdds.GetStaticGrid().AddInflatedCylinder(ToPlanningVec(Position), Radius, Height, InInflationRadius);
         }
+        
+        // 圆柱及其膨胀层的包围盒（超出地图部分在广播前裁剪）
+        const FVector Extent(Reach, Reach, Height / 2.0f + InInflationRadius);
+        DirtyCells.Add(WorldToCellUnclamped(Grid, Position - Extent));
+        DirtyCells.Add(WorldToCellUnclamped(Grid, Position + Extent));
     }
     
     UE_LOG(LogTemp, Log, TEXT("Added %d cylindrical obstacles with radius %f and height %f"), 
         Positions.Num(), Radius, Height);
     
-    // 搴旂敤鑶ㄨ儉
-    InflateObstacles(InInflationRadius);
+    GridVersion++;
+    AddDirtyCells(DirtyCells, NumChanged);
     
     if (OnGridMapUpdated.IsBound())
     {
@@ -169,21 +126,20 @@ void UGridMapComponent::AddCylindricalObstacles(const TArray<FVector>& Positions
 
 bool UGridMapComponent::IsOccupied(const FVector& Position)
 {
-    int32 GridX, GridY, GridZ;
-    bool real =WorldToGrid(Position, GridX, GridY, GridZ);
-    if (real)
-    {
-        return OccupancyGrid[GridX][GridY][GridZ];
-    }
-    return false;
+    return Grid.IsOccupied(ToPlanningVec(Position));
 }
 
 void UGridMapComponent::MarkAsOccupied(const FVector& Position)
 {
-    int32 GridX, GridY, GridZ;
-    if (WorldToGrid(Position, GridX, GridY, GridZ))
+    if (OccupancyLogOdds.IsInitialized())
     {
-        OccupancyGrid[GridX][GridY][GridZ] = true;
+        OccupancyLogOdds.GetStaticGrid().MarkOccupied(ToPlanningVec(Position));
+    }
+    if (Grid.MarkOccupied(ToPlanningVec(Position)))
+    {
+        GridVersion++;
+        const DronePlanning::FIntVec3 Cell = WorldToCellUnclamped(Grid, Position);
+        AddDirtyCells(DronePlanning::FCellBounds(Cell, Cell), 1);
         // UE_LOG(LogTemp, Warning, TEXT("宸茬粡鏇存柊闅滅鐗? (%.2f, %.2f, %.2f)"),Position.X, Position.Y, Position.Z);
         if (OnGridMapUpdated.IsBound())
         {
@@ -194,102 +150,313 @@ void UGridMapComponent::MarkAsOccupied(const FVector& Position)
     }
 }
 
-void UGridMapComponent::GetMapBounds(FVector& OutOrigin, FVector& OutSize)
+int32 UGridMapComponent::MarkCellsAsOccupied(const TArray<FIntVector>& Cells)
 {
-    OutOrigin = MapOrigin + MapSize / 2.0f; // Return center of map
-    OutSize = MapSize;
+    std::vector<DronePlanning::FIntVec3> PlanningCells;
+    PlanningCells.reserve(Cells.Num());
+    for (const FIntVector& Cell : Cells)
+    {
+        PlanningCells.emplace_back(Cell.X, Cell.Y, Cell.Z);
+    }
+    
+    DronePlanning::FCellBounds Changed;
+    const int32 NumChanged = Grid.MarkOccupiedCells(PlanningCells, Changed);
+    if (OccupancyLogOdds.IsInitialized())
+    {
+        DronePlanning::FCellBounds StaticChanged;
+        OccupancyLogOdds.GetStaticGrid().MarkOccupiedCells(PlanningCells, StaticChanged);
+    }
+    if (NumChanged > 0)
+    {
+        GridVersion++;
+        AddDirtyCells(Changed, NumChanged);
+    }
+    return NumChanged;
 }
 
-bool UGridMapComponent::WorldToGrid(const FVector& WorldPos, int32& GridX, int32& GridY, int32& GridZ)
+int32 UGridMapComponent::MarkInflatedHits(const TArray<FVector>& HitLocations, float HitInflationRadius, int32 MaxHalfHeightCells)
+{
+    const std::vector<DronePlanning::FVec3> Hits = ToPlanningPath(HitLocations);
+    DronePlanning::FCellBounds Changed;
+    const int32 NumChanged = Grid.IntegrateHits(Hits, HitInflationRadius, MaxHalfHeightCells, Changed);
+    if (OccupancyLogOdds.IsInitialized())
+    {
+        DronePlanning::FCellBounds StaticChanged;
+        OccupancyLogOdds.GetStaticGrid().IntegrateHits(Hits, HitInflationRadius, MaxHalfHeightCells, StaticChanged);
+    }
+    if (NumChanged > 0)
+    {
+        GridVersion++;
+        AddDirtyCells(Changed, NumChanged);
+    }
+    return NumChanged;
+}
+
+int32 UGridMapComponent::MarkBoxAsOccupied(const FVector& BoxMin, const FVector& BoxMax)
 {
-    // 璁＄畻鐩稿浜庡湴鍥惧師鐐圭殑鍋忕Щ
-    FVector RelativePos = WorldPos - MapOrigin;
+    if (!Grid.IsInitialized())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Grid map not initialized"));
+        return 0;
+    }
     
-    // 杞崲涓虹綉鏍煎潗鏍?
-    GridX = FMath::FloorToInt(RelativePos.X / CellSize);
-    GridY = FMath::FloorToInt(RelativePos.Y / CellSize);
-    GridZ = FMath::FloorToInt(RelativePos.Z / CellSize);
+    DronePlanning::FCellBounds Box;
+    Box.Add(WorldToCellUnclamped(Grid, BoxMin));
+    Box.Add(WorldToCellUnclamped(Grid, BoxMax));
     
-    // 妫?鏌ユ槸鍚﹀湪缃戞牸鑼冨洿鍐?
-    if (GridX < 0 || GridX >= GridDimX ||
-        GridY < 0 || GridY >= GridDimY ||
-        GridZ < 0 || GridZ >= GridDimZ)
+    DronePlanning::FCellBounds Changed;
+    const int32 NumChanged = Grid.MarkOccupiedBox(Box, Changed);
+    if (OccupancyLogOdds.IsInitialized())
     {
-        
-        return false;
+        DronePlanning::FCellBounds StaticChanged;
+        OccupancyLogOdds.GetStaticGrid().MarkOccupiedBox(Box, StaticChanged);
     }
-    
-    return true;
+    if (NumChanged > 0)
+    {
+        GridVersion++;
+        AddDirtyCells(Changed, NumChanged);
+    }
+    return NumChanged;
 }
 
-FVector UGridMapComponent::GridToWorld(int32 GridX, int32 GridY, int32 GridZ)
+int32 UGridMapComponent::IntegrateScanRays(const TArray<FVector>& RayStarts, const TArray<FVector>& RayEnds, const TArray<bool>& bRayHits)
 {
-    // 璁＄畻缃戞牸涓績鐐圭殑涓栫晫鍧愭爣
-    FVector WorldPos;
-    WorldPos.X = MapOrigin.X + (GridX + 0.5f) * CellSize;
-    WorldPos.Y = MapOrigin.Y + (GridY + 0.5f) * CellSize;
-    WorldPos.Z = MapOrigin.Z + (GridZ + 0.5f) * CellSize;
+    if (!Grid.IsInitialized())
+    {
+        return 0;
+    }
+    
+    // 第一次积分时以当前地图为静态底图；之后只有射线积分的结果会被清除
+    if (!OccupancyLogOdds.IsInitialized())
+    {
+        OccupancyLogOdds.Initialize(Grid, ScanInflationRadius);
+        UE_LOG(LogTemp, Log, TEXT("GridMap: log-odds occupancy enabled (%lld cells)"), Grid.GetNumCells());
+    }
+    OccupancyLogOdds.Config.HitLogOdds = LogOddsHit;
+    OccupancyLogOdds.Config.MissLogOdds = LogOddsMiss;
+    OccupancyLogOdds.Config.MinLogOdds = LogOddsMin;
+    OccupancyLogOdds.Config.MaxLogOdds = LogOddsMax;
+    
+    std::vector<uint8_t> Hits;
+    Hits.reserve(bRayHits.Num());
+    for (bool bHit : bRayHits)
+    {
+        Hits.push_back(bHit ? 1 : 0);
+    }
     
-    return WorldPos;
+    DronePlanning::FCellBounds Changed;
+    const int32 NumChanged = OccupancyLogOdds.IntegrateRays(Grid, ToPlanningPath(RayStarts), ToPlanningPath(RayEnds), Hits, Changed);
+    if (NumChanged > 0)
+    {
+        GridVersion++;
+        AddDirtyCells(Changed, NumChanged);
+    }
+    return NumChanged;
+}
+
+void UGridMapComponent::AddDirtyCells(const DronePlanning::FCellBounds& Cells, int32 NumChanged)
+{
+    PendingDirtyCells.Add(Cells);
+    PendingChangedCells += NumChanged;
+    SnapshotChangedCells += NumChanged;
+    PendingDistanceCells.Add(Cells);
+    PendingHierarchicalCells.Add(Cells);
+    // 缓存只递增涉及区域的版本，直接应用，避免多处变化合并成一个大包围盒
+    PathCache.NotifyCellsChanged(Grid, Cells);
 }
 
+void UGridMapComponent::MarkWholeMapDirty()
+{
+    bPendingWholeMap = true;
+    bSnapshotWholeMap = true;
+    bDistanceFieldRebuild = true;
+    bHierarchicalReset = true;
+    PathCache.Reset();
+}
 
-void UGridMapComponent::InflateObstacles(float Radius)
+void UGridMapComponent::FlushDirtyRegion()
 {
-    int InflationCells = FMath::CeilToInt(Radius / CellSize);
+    if (!bPendingWholeMap && PendingDirtyCells.IsEmpty())
+    {
+        return;
+    }
+    
+    // 裁剪到地图范围
+    DronePlanning::FCellBounds Cells = Grid.GetBounds();
+    if (!bPendingWholeMap)
+    {
+        Cells.Min = DronePlanning::FIntVec3(FMath::Max(PendingDirtyCells.Min.X, 0), FMath::Max(PendingDirtyCells.Min.Y, 0), FMath::Max(PendingDirtyCells.Min.Z, 0));
+        Cells.Max = DronePlanning::FIntVec3(FMath::Min(PendingDirtyCells.Max.X, Cells.Max.X), FMath::Min(PendingDirtyCells.Max.Y, Cells.Max.Y), FMath::Min(PendingDirtyCells.Max.Z, Cells.Max.Z));
+    }
     
-    // Create a copy of the grid
-    TArray<TArray<TArray<bool>>> OriginalGrid = OccupancyGrid;
+    FGridDirtyRegion Region;
+    Region.bWholeMap = bPendingWholeMap;
+    Region.NumChangedCells = bPendingWholeMap ? 0 : PendingChangedCells;
     
-    // Apply inflation
-    for (int x = 0; x < GridDimX; x++)
+    // 先清空再广播，回调中产生的新变化留到下一帧
+    PendingDirtyCells = DronePlanning::FCellBounds();
+    PendingChangedCells = 0;
+    bPendingWholeMap = false;
+    
+    if (Cells.IsEmpty())
     {
-        for (int y = 0; y < GridDimY; y++)
-        {
-            for (int z = 0; z < GridDimZ; z++)
-            {
-                if (OriginalGrid[x][y][z])
-                {
-                    // Inflate in all directions
-                    for (int dx = -InflationCells; dx <= InflationCells; dx++)
-                    {
-                        for (int dy = -InflationCells; dy <= InflationCells; dy++)
-                        {
-                            for (int dz = -InflationCells; dz <= InflationCells; dz++)
-                            {
-                                int nx = x + dx;
-                                int ny = y + dy;
-                                int nz = z + dz;
-                                
-                                // Check bounds
-                                if (nx >= 0 && nx < GridDimX &&
-                                    ny >= 0 && ny < GridDimY &&
-                                    nz >= 0 && nz < GridDimZ)
-                                {
-                                    // Check if within inflation radius
-                                    float distance = FMath::Sqrt((float)(dx*dx + dy*dy + dz*dz)) * CellSize;
-                                    if (distance <= Radius && !OccupancyGrid[nx][ny][nz])
-                                    {
-                                        OccupancyGrid[nx][ny][nz] = true;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        return;
     }
+    
+    Region.MinCell = FIntVector(Cells.Min.X, Cells.Min.Y, Cells.Min.Z);
+    Region.MaxCell = FIntVector(Cells.Max.X, Cells.Max.Y, Cells.Max.Z);
+    const float HalfCell = Grid.GetResolution() / 2.0f;
+    Region.WorldMin = GridToWorld(Cells.Min.X, Cells.Min.Y, Cells.Min.Z) - FVector(HalfCell);
+    Region.WorldMax = GridToWorld(Cells.Max.X, Cells.Max.Y, Cells.Max.Z) + FVector(HalfCell);
+    
+    if (OnGridMapUpdatedBatch.IsBound())
+    {
+        OnGridMapUpdatedBatch.Broadcast(Region);
+    }
+}
+
+void UGridMapComponent::GetMapBounds(FVector& OutOrigin, FVector& OutSize)
+{
+    OutOrigin = GetMapOrigin() + GetMapSize() / 2.0f; // Return center of map
+    OutSize = GetMapSize();
 }
 
+bool UGridMapComponent::WorldToGrid(const FVector& WorldPos, int32& GridX, int32& GridY, int32& GridZ)
+{
+    return Grid.WorldToGrid(ToPlanningVec(WorldPos), GridX, GridY, GridZ);
+}
+
+FVector UGridMapComponent::GridToWorld(int32 GridX, int32 GridY, int32 GridZ)
+{
+    // 网格中心点的世界坐标
+    return ToFVector(Grid.GridToWorld(GridX, GridY, GridZ));
+}
 
 void UGridMapComponent::ClearObstacles()
 {
-    for (int x = 0; x < GridDimX; x++)
-        for (int y = 0; y < GridDimY; y++)
-            for (int z = 0; z < GridDimZ; z++)
-                OccupancyGrid[x][y][z] = false;
+    Grid.Clear();
+    OccupancyLogOdds.Reset();
+    GridVersion++;
+    MarkWholeMapDirty();
+    if (OnGridMapUpdated.IsBound())
+        OnGridMapUpdated.Broadcast(FVector::ZeroVector);
+}
+
+bool UGridMapComponent::SaveMapToFile(const FString& FilePath)
+{
+    const bool bSaved = Grid.SaveToFile(TCHAR_TO_UTF8(*FilePath));
+    UE_LOG(LogTemp, Log, TEXT("GridMap: save map to %s %s"), *FilePath, bSaved ? TEXT("succeeded") : TEXT("failed"));
+    return bSaved;
+}
+
+bool UGridMapComponent::LoadMapFromFile(const FString& FilePath)
+{
+    // 读取失败时Grid保持原样，版本号与脏区无需更新
+    if (!Grid.LoadFromFile(TCHAR_TO_UTF8(*FilePath)))
+    {
+        UE_LOG(LogTemp, Error, TEXT("GridMap: failed to load map from %s"), *FilePath);
+        return false;
+    }
+    OccupancyLogOdds.Reset();
+    bSparseStorage = Grid.IsSparse();
+    GridVersion++;
+    MarkWholeMapDirty();
+    UE_LOG(LogTemp, Log, TEXT("GridMap: loaded %d x %d x %d map from %s"), Grid.GetDimX(), Grid.GetDimY(), Grid.GetDimZ(), *FilePath);
     if (OnGridMapUpdated.IsBound())
         OnGridMapUpdated.Broadcast(FVector::ZeroVector);
+    return true;
+}
+
+const DronePlanning::FDistanceField* UGridMapComponent::GetDistanceField()
+{
+    if (!bMaintainDistanceField || !Grid.IsInitialized() || Grid.IsSparse())
+    {
+        if (DistanceField.IsValid())
+        {
+            DistanceField.Reset();
+        }
+        bDistanceFieldRebuild = true;
+        return nullptr;
+    }
+    
+    // 截断格数决定局部更新的窗口大小，按格数限制截断距离
+    const float MaxDistance = FMath::Min(DistanceFieldMaxDistance, FMath::Clamp(DistanceFieldMaxCells, 1, 255) * Grid.GetResolution());
+    if (bDistanceFieldRebuild || !DistanceField.IsValid() || DistanceField.GetMaxDistance() != MaxDistance)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        if (!DistanceField.Build(Grid, MaxDistance))
+        {
+            return nullptr;
+        }
+        UE_LOG(LogTemp, Log, TEXT("GridMap: distance field built (max %.0f cm) in %.2f ms"),
+            MaxDistance, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+        bDistanceFieldRebuild = false;
+    }
+    else if (!PendingDistanceCells.IsEmpty())
+    {
+        DistanceField.Update(Grid, PendingDistanceCells);
+    }
+    PendingDistanceCells = DronePlanning::FCellBounds();
+    return &DistanceField;
+}
+
+DronePlanning::FHierarchicalPlanner* UGridMapComponent::GetHierarchicalPlanner()
+{
+    if (!Grid.IsInitialized())
+    {
+        return nullptr;
+    }
+    
+    HierarchicalPlanner.ClusterSize = HierarchicalClusterSize;
+    if (bHierarchicalReset)
+    {
+        HierarchicalPlanner.Reset();
+        bHierarchicalReset = false;
+    }
+    else if (!PendingHierarchicalCells.IsEmpty())
+    {
+        HierarchicalPlanner.NotifyCellsChanged(Grid, PendingHierarchicalCells);
+    }
+    PendingHierarchicalCells = DronePlanning::FCellBounds();
+    return &HierarchicalPlanner;
+}
+
+DronePlanning::FPathCache* UGridMapComponent::GetPathCache()
+{
+    if (!Grid.IsInitialized())
+    {
+        return nullptr;
+    }
+    return &PathCache;
+}
+
+float UGridMapComponent::GetDistanceToObstacle(const FVector& Position)
+{
+    const DronePlanning::FDistanceField* Field = GetDistanceField();
+    return Field ? Field->GetDistance(ToPlanningVec(Position)) : -1.0f;
+}
+
+FVector UGridMapComponent::GetDistanceGradient(const FVector& Position)
+{
+    const DronePlanning::FDistanceField* Field = GetDistanceField();
+    return Field ? ToFVector(Field->GetGradient(ToPlanningVec(Position))) : FVector::ZeroVector;
+}
+
+TSharedRef<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> UGridMapComponent::GetPlanningGridSnapshot()
+{
+    // 地图未变化时所有请求共享同一份拷贝；少量变化在GridSnapshotMinInterval内也复用旧快照
+    const double Now = FPlatformTime::Seconds();
+    const bool bStale = GridSnapshotVersion != GridVersion
+        && (bSnapshotWholeMap || SnapshotChangedCells >= GridSnapshotMaxChangedCells || Now - GridSnapshotTime >= GridSnapshotMinInterval);
+    if (!GridSnapshot.IsValid() || bStale)
+    {
+        GridSnapshot = MakeShared<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe>(Grid);
+        GridSnapshotVersion = GridVersion;
+        GridSnapshotTime = Now;
+        GridSnapshotCacheEpoch = PathCache.GetEpoch();
+        SnapshotChangedCells = 0;
+        bSnapshotWholeMap = false;
+    }
+    return GridSnapshot.ToSharedRef();
 }
 
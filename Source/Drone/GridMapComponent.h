@@ -2,6 +2,11 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "PlanningCore/DistanceField.h"
+#include "PlanningCore/HierarchicalPlanner.h"
+#include "PlanningCore/OccupancyGrid.h"
+#include "PlanningCore/OccupancyLogOdds.h"
+#include "PlanningCore/PathCache.h"
 #include "GridMapComponent.generated.h"
 
 // 障碍物结构体
@@ -14,9 +19,39 @@ struct FCylinderObstacle
     float Height;
 };
 
+// 一帧内所有占用变化的合并区域（网格坐标闭区间及对应的世界包围盒）
+USTRUCT(BlueprintType)
+struct FGridDirtyRegion
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    FIntVector MinCell = FIntVector::ZeroValue;
+
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    FIntVector MaxCell = FIntVector::ZeroValue;
+
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    FVector WorldMin = FVector::ZeroVector;
+
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    FVector WorldMax = FVector::ZeroVector;
+
+    // 本帧占用状态改变的格子数，包括log-odds层清除的格子（整图变化时为0）
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    int32 NumChangedCells = 0;
+
+    // 初始化/清空/加载等整图变化，此时区域覆盖整张地图
+    UPROPERTY(BlueprintReadOnly, Category="PathPlanning|GridMap")
+    bool bWholeMap = false;
+};
+
 // 在UCLASS前添加：
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGridMapUpdated, const FVector&, UpdatedLocation);
 
+// 每帧最多广播一次，携带本帧合并后的脏区域
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGridMapUpdatedBatch, const FGridDirtyRegion&, DirtyRegion);
+
 UCLASS(ClassGroup=(PathPlanning), meta=(BlueprintSpawnableComponent))
 class DRONE_API UGridMapComponent : public UActorComponent
 {
@@ -43,6 +78,24 @@ public:
     // 标记位置为障碍物
     UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
     void MarkAsOccupied(const FVector& Position);
+    
+    // 批量标记网格坐标为障碍物（越界格子被忽略），返回新变为占用的格子数。
+    // 只在本帧结束时广播一次OnGridMapUpdatedBatch
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    int32 MarkCellsAsOccupied(const TArray<FIntVector>& Cells);
+    
+    // 批量写入一次扫描的命中点：去重后按球形核膨胀（z方向半高不超过MaxHalfHeightCells格），返回值与广播方式同上
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    int32 MarkInflatedHits(const TArray<FVector>& HitLocations, float HitInflationRadius, int32 MaxHalfHeightCells);
+    
+    // 按log-odds积分一次扫描的全部射线（bRayHits[i]为真时RayEnds[i]为命中点），命中的格子按ScanInflationRadius膨胀，
+    // 射线穿过的格子降低占用概率，离开的动态障碍物因此逐渐被清除。返回占用状态改变的格子数，广播方式同上
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    int32 IntegrateScanRays(const TArray<FVector>& RayStarts, const TArray<FVector>& RayEnds, const TArray<bool>& bRayHits);
+    
+    // 标记世界包围盒覆盖的所有格子为障碍物，返回值与广播方式同上
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    int32 MarkBoxAsOccupied(const FVector& BoxMin, const FVector& BoxMax);
 
     
     // Get map bounds
@@ -58,17 +111,17 @@ public:
     
     // Get resolution
     UFUNCTION(BlueprintPure, Category="PathPlanning|GridMap")
-    float GetResolution() const { return CellSize; }
+    float GetResolution() const { return Grid.GetResolution(); }
     
     // Get grid dimensions
     UFUNCTION(BlueprintPure, Category="PathPlanning|GridMap")
-    int32 GetGridDimX() const { return GridDimX; }
+    int32 GetGridDimX() const { return Grid.GetDimX(); }
     
     UFUNCTION(BlueprintPure, Category="PathPlanning|GridMap")
-    int32 GetGridDimY() const { return GridDimY; }
+    int32 GetGridDimY() const { return Grid.GetDimY(); }
     
     UFUNCTION(BlueprintPure, Category="PathPlanning|GridMap")
-    int32 GetGridDimZ() const { return GridDimZ; }
+    int32 GetGridDimZ() const { return Grid.GetDimZ(); }
     
     // Config properties
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap")
@@ -77,35 +130,170 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap")
     bool bAutomaticObstacleDetection = true;
     
+    // 稀疏分块存储：只为出现过障碍物的8^3格子块分配内存，用于高分辨率的大地图（下一次InitializeMap生效）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap")
+    bool bSparseStorage = false;
+    
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap")
     TArray<AActor*> IgnoredActors;
     
-    FORCEINLINE FVector GetMapOrigin() const { return MapOrigin; }
-    FORCEINLINE FVector GetMapSize() const { return MapSize; }
+    // 扫描结果按log-odds概率积分（IntegrateScanRays），而不是只增不减地直接写入
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    bool bUseLogOddsOccupancy = false;
+    
+    // 每次命中/穿过时的log-odds增量，以及截断上下限（默认对应概率0.7/0.4，截断到[0.12, 0.97]）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    float LogOddsHit = 0.85f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    float LogOddsMiss = -0.4f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    float LogOddsMin = -2.0f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    float LogOddsMax = 3.5f;
+    
+    // log-odds占用格子的膨胀半径，只在第一次积分时读取
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|LogOdds")
+    float ScanInflationRadius = 80.0f;
+    
+    // 维护到最近障碍物的距离场（ESDF），地图变化后在下一次查询时只重算受影响的局部区域。仅支持稠密存储。
+    // 一个格子变化要重算向各方向扩展截断格数的窗口，代价随截断格数的三次方增长：500x500x50、随机2万个占用格子的地图上，
+    // 整图构建约0.5-0.7秒，单格更新在截断8/16/40格时约0.4/2.7/29毫秒。扫描每帧写图时开销可观，默认关闭；
+    // 关闭时路径平滑退回逐点检查，GetDistanceToObstacle返回-1
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|DistanceField")
+    bool bMaintainDistanceField = false;
+    
+    // 距离场的截断距离，超过该距离的格子只记录"足够远"；实际截断不超过DistanceFieldMaxCells个格子
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|DistanceField")
+    float DistanceFieldMaxDistance = 200.0f;
+    
+    // 截断格数上限，决定单格更新的窗口大小（(2*N+1)^3个格子）；5厘米分辨率下16格即80厘米
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|DistanceField", meta=(ClampMin="1", ClampMax="255"))
+    int32 DistanceFieldMaxCells = 16;
+    
+    // 到最近占用格子中心的距离，超过截断距离时返回不小于截断距离的值；距离场不可用或点在地图外时返回-1
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap|DistanceField")
+    float GetDistanceToObstacle(const FVector& Position);
+    
+    // 距离场梯度，指向远离障碍物的方向；距离场不可用时为零向量
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap|DistanceField")
+    FVector GetDistanceGradient(const FVector& Position);
+    
+    // 分层寻路（HPA*）的区块边长（格子数），修改后下一次规划时重建入口图
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap|Hierarchical", meta=(ClampMin="4", ClampMax="64"))
+    int32 HierarchicalClusterSize = 16;
+    
+    FORCEINLINE FVector GetMapOrigin() const { return FVector(Grid.GetOrigin().X, Grid.GetOrigin().Y, Grid.GetOrigin().Z); }
+    FORCEINLINE FVector GetMapSize() const { return FVector(Grid.GetSize().X, Grid.GetSize().Y, Grid.GetSize().Z); }
+    
+    // 引擎无关的占用栅格，供规划核心直接读取
+    FORCEINLINE const DronePlanning::FOccupancyGrid& GetPlanningGrid() const { return Grid; }
+    
+    // 只读快照，供后台线程规划使用。地图变化后不立即重新拷贝：距上次拷贝不足GridSnapshotMinInterval秒、
+    // 且变化的格子数未达GridSnapshotMaxChangedCells时继续返回旧快照（整张地图重建时总是重新拷贝）
+    TSharedRef<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> GetPlanningGridSnapshot();
+    
+    // 最近一次GetPlanningGridSnapshot返回的快照对应的GridVersion，与GetGridVersion()不同时说明快照已落后于地图
+    FORCEINLINE uint32 GetPlanningGridSnapshotVersion() const { return GridSnapshotVersion; }
+    
+    // 该快照拷贝时规划结果缓存的纪元，快照上的规划结果按它写入缓存
+    FORCEINLINE uint64 GetPlanningGridSnapshotCacheEpoch() const { return GridSnapshotCacheEpoch; }
+    
+    // 扫描每帧写图时，每个版本都拷贝整张地图（500x500x50的稠密位图约1.5 MB）代价过高，旧快照在这段时间内复用；
+    // 快照上规划出的路径在提交前会对照最新地图重新检查
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap", meta=(ClampMin="0.0"))
+    float GridSnapshotMinInterval = 0.5f;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|GridMap", meta=(ClampMin="0"))
+    int32 GridSnapshotMaxChangedCells = 4096;
+    
+    // 与GetPlanningGrid()同步的距离场（按需重建或局部更新），未启用或为稀疏存储时返回nullptr。
+    // 只在游戏线程上使用，后台线程的快照规划不读取它
+    const DronePlanning::FDistanceField* GetDistanceField();
+    
+    // 与GetPlanningGrid()同步的分层寻路器，所有寻路组件共享其入口图（地图变化时只丢弃受影响的区块）。
+    // 只在游戏线程上使用，地图未初始化时返回nullptr
+    DronePlanning::FHierarchicalPlanner* GetHierarchicalPlanner();
+    
+    // 与GetPlanningGrid()同步的规划结果缓存，所有寻路组件共享（地图变化时只让经过变化区域的条目失效）。
+    // 只在游戏线程上使用，地图未初始化时返回nullptr
+    DronePlanning::FPathCache* GetPathCache();
+    
+    // 每次占用状态改变时递增
+    FORCEINLINE uint32 GetGridVersion() const { return GridVersion; }
+    
+    // 网格坐标是否在地图范围内
+    FORCEINLINE bool IsValidCell(int32 X, int32 Y, int32 Z) const { return Grid.IsValidCell(X, Y, Z); }
+    
+    // 网格坐标 -> 格子索引（稠密存储时为X变化最快的线性索引）
+    FORCEINLINE int64 GetCellIndex(int32 X, int32 Y, int32 Z) const { return Grid.GetCellIndex(X, Y, Z); }
+    
+    // 快速路径：直接按网格坐标查询占用，越界视为空闲（与IsOccupied一致）
+    FORCEINLINE bool IsOccupiedCell(int32 X, int32 Y, int32 Z) const { return Grid.IsOccupiedCell(X, Y, Z); }
+    
+    FORCEINLINE bool IsOccupiedIndex(int64 Index) const { return Grid.IsOccupiedIndex(Index); }
+    
+    // 录制当前地图，供无头基准测试回放
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    bool SaveMapToFile(const FString& FilePath);
+    
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
+    bool LoadMapFromFile(const FString& FilePath);
     
     // 新增：地图更新事件
     UPROPERTY(BlueprintAssignable, Category="PathPlanning|GridMap")
     FOnGridMapUpdated OnGridMapUpdated;
     
+    // 批量地图更新事件：同一帧内的所有变化合并为一个脏区域，在本组件Tick时广播
+    UPROPERTY(BlueprintAssignable, Category="PathPlanning|GridMap")
+    FOnGridMapUpdatedBatch OnGridMapUpdatedBatch;
+    
     // 新增：清空所有障碍物并广播地图更新事件
     UFUNCTION(BlueprintCallable, Category="PathPlanning|GridMap")
     void ClearObstacles();
     
 private:
-    // Grid map data
-    TArray<TArray<TArray<bool>>> OccupancyGrid;
+    // Grid map data（位图存储，坐标转换与膨胀均在PlanningCore中实现）
+    DronePlanning::FOccupancyGrid Grid;
+    
+    uint32 GridVersion = 0;
+    
+    // 概率占用层，第一次IntegrateScanRays时创建；地图初始化/清空/加载时丢弃
+    DronePlanning::FOccupancyLogOdds OccupancyLogOdds;
+    TSharedPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> GridSnapshot;
+    uint32 GridSnapshotVersion = 0;
+    double GridSnapshotTime = 0.0;
+    uint64 GridSnapshotCacheEpoch = 0;
+    
+    // 上次拷贝快照以来变化的格子数；整张地图重建后旧快照不再复用
+    int64 SnapshotChangedCells = 0;
+    bool bSnapshotWholeMap = false;
+    
+    // 距离场及其尚未应用的占用变化
+    DronePlanning::FDistanceField DistanceField;
+    DronePlanning::FCellBounds PendingDistanceCells;
+    bool bDistanceFieldRebuild = true;
+    
+    // 分层寻路器及其尚未应用的占用变化
+    DronePlanning::FHierarchicalPlanner HierarchicalPlanner;
+    DronePlanning::FCellBounds PendingHierarchicalCells;
+    bool bHierarchicalReset = true;
+    
+    // 规划结果缓存（占用变化在AddDirtyCells中直接应用）
+    DronePlanning::FPathCache PathCache;
     
-    FVector MapOrigin;
-    FVector MapSize;
-    float CellSize;
+    // 尚未广播的脏区域
+    DronePlanning::FCellBounds PendingDirtyCells;
+    int32 PendingChangedCells = 0;
+    bool bPendingWholeMap = false;
     
-    int32 GridDimX;
-    int32 GridDimY;
-    int32 GridDimZ;
+    void AddDirtyCells(const DronePlanning::FCellBounds& Cells, int32 NumChanged);
+    void MarkWholeMapDirty();
+    void FlushDirtyRegion();
     
     // 保存所有真实圆柱障碍物
     TArray<FCylinderObstacle> CylinderObstacles;
     
-    // Helper methods
-    void InflateObstacles(float Radius);
 };
\ No newline at end of file
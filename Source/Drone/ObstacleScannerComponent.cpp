@@ -1,15 +1,48 @@
 // ObstacleScannerComponent.cpp
 #include "ObstacleScannerComponent.h"
 #include "DroneActor.h"
+#include "DroneRegistry.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
 #include "Async/ParallelFor.h"
 #include "Misc/FileHelper.h"
+#include "EngineUtils.h"
+#include "PlanningCoreConversions.h"
+#include "PlanningCore/VoxelRaycaster.h"
+#include "UObject/GarbageCollection.h"
+
+TArray<UObstacleScannerComponent::FStaticCollisionSnapshot> UObstacleScannerComponent::StaticCollisionSnapshots;
+uint32 UObstacleScannerComponent::NextStaticCollisionBuildSerial = 0;
+
+namespace
+{
+    // 扫描使用的自定义碰撞通道
+    constexpr ECollisionChannel SCAN_TRACE_CHANNEL = FDroneRegistry::ScanTraceChannel;
+
+    // 依次创建的扫描组件的定时器相位按黄金分割错开，任意数量的无人机都大致均匀分布在扫描周期内
+    int32 NextScanPhaseSlot = 0;
+
+    bool BlocksScanChannel(const UPrimitiveComponent* Primitive)
+    {
+        return Primitive && Primitive->IsQueryCollisionEnabled()
+            && Primitive->GetCollisionResponseToChannel(SCAN_TRACE_CHANNEL) == ECR_Block;
+    }
+
+    // 待体素化的静态组件及其包围盒覆盖的体素范围（已裁剪到地图内）
+    struct FStaticCollisionPrimitive
+    {
+        TWeakObjectPtr<UPrimitiveComponent> Primitive;
+        FIntVector Min;
+        FIntVector Max;
+    };
+}
 
 UObstacleScannerComponent::UObstacleScannerComponent()
 {
     PrimaryComponentTick.bCanEverTick = true;
     GridMap = nullptr;
+    AsyncTraceDelegate.BindUObject(this, &UObstacleScannerComponent::OnAsyncTraceDone);
 }
 
 void UObstacleScannerComponent::BeginPlay()
@@ -19,16 +52,25 @@ void UObstacleScannerComponent::BeginPlay()
     // 启动定时器，每0.1秒执行一次扫描
     if (bAutoScan)
     {
+        // 错开各无人机的首次扫描时间，避免所有定时器在同一帧触发
+        const float FirstDelay = ScanInterval * FMath::Frac(NextScanPhaseSlot++ * 0.618034f);
         GetWorld()->GetTimerManager().SetTimer(
             ScanTimerHandle,
             this,
             &UObstacleScannerComponent::OnScanTimer,
             ScanInterval,
-            true  // 循环执行
+            true,  // 循环执行
+            FirstDelay
         );
 
         // UE_LOG(LogTemp, Log, TEXT("[ObstacleScanner] ScanTimerHandle set!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"));
     }
+
+    // 体素模式在开始时就启动后台体素化；GridMap此时尚未初始化的话由首次扫描启动
+    if (ScanBackend == EObstacleScanBackend::VoxelRaymarch && ResolveGridMap() && GridMap->GetPlanningGrid().IsInitialized())
+    {
+        GetStaticCollisionSnapshot();
+    }
 }
 
 void UObstacleScannerComponent::OnScanTimer()
@@ -43,6 +85,12 @@ void UObstacleScannerComponent::OnScanTimer()
 void UObstacleScannerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    // 异步扫描超出单帧预算的射线留到后续帧提交
+    if (bAsyncScanInFlight && AsyncScan.NumSubmitted < AsyncScan.RayStarts.Num())
+    {
+        SubmitAsyncTraces();
+    }
 }
 
 void UObstacleScannerComponent::SetGridMap(UGridMapComponent* InGridMap)
@@ -56,7 +104,7 @@ void UObstacleScannerComponent::SetGridMap(UGridMapComponent* InGridMap)
     UE_LOG(LogTemp, Log, TEXT("ObstacleScanner: GridMap set successfully"));
 }
 
-void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
+bool UObstacleScannerComponent::ResolveGridMap()
 {
     if (!GridMap)
     {
@@ -74,12 +122,16 @@ void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
                 break;
             }
         }
-        
-        if (!GridMap)
-        {
-            UE_LOG(LogTemp, Error, TEXT("ObstacleScanner: GridMap is not valid and not found in scene"));
-            return;
-        }
+    }
+    return GridMap != nullptr;
+}
+
+void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
+{
+    if (!ResolveGridMap())
+    {
+        UE_LOG(LogTemp, Error, TEXT("ObstacleScanner: GridMap is not valid and not found in scene"));
+        return;
     }
 
     if (!GetWorld())
@@ -92,108 +144,88 @@ void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
     AActor* Owner = GetOwner();
     if (!Owner)
         return;
-    
-    // 获取所有无人机的引用，用于忽略扫描
-    TArray<AActor*> DroneActors;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), ADroneActor::StaticClass(), DroneActors);
-    
-    // UE_LOG(LogTemp, Warning, TEXT("Found %d drones to ignore"), DroneActors.Num());
-    
-    FRotator OwnerRotation = Owner->GetActorRotation();
-    FVector ForwardVector = OwnerRotation.Vector();
-    FVector RightVector = FVector::CrossProduct(FRotator(0, OwnerRotation.Yaw, 0).Vector(), FVector::UpVector);
-    FVector UpVector = FVector::CrossProduct(ForwardVector, RightVector);
 
-    // 使用可配置的高度偏移
-    FVector ScanStartPoint = Center + FVector(0, 0, ScanStartHeight);
+    // 异步模式：整套扫描射线分帧提交，结果在后续帧回调中汇总
+    if (bAsyncTraces && ScanBackend == EObstacleScanBackend::PhysicsTrace)
+    {
+        BeginAsyncScan(Center, Radius);
+        return;
+    }
 
-    // 计算扫描范围
-    float StartDistance = 80.0f;  // 从扫描起点前方80厘米开始扫描
-    float EndDistance = Radius;   // 扫描到最大半径
-    
-    // 计算垂直角度步长
-    float VerticalStep = FMath::DegreesToRadians(VerticalScanAngle) / (NumScanLines - 1);
-    float VerticalStart = -FMath::DegreesToRadians(VerticalScanAngle) / 2.0f;
-    
-    // 计算水平角度步长
-    float HorizontalStep = FMath::DegreesToRadians(HorizontalScanAngle) / (PointsPerLine - 1);
-    float HorizontalStart = -FMath::DegreesToRadians(HorizontalScanAngle) / 2.0f;
+    TArray<FVector> RayStarts;
+    TArray<FVector> RayEnds;
+    BuildScanRays(Center, Radius, RayStarts, RayEnds);
 
     // 创建扫描数据数组
     TArray<FScanData> ScanDataArray;
-    ScanDataArray.SetNum(NumScanLines * PointsPerLine);
+    ScanDataArray.SetNum(RayStarts.Num());
 
-    // 设置碰撞查询参数
-    FCollisionQueryParams QueryParams;
-    QueryParams.bTraceComplex = true;  // 启用复杂碰撞以检测所有组件
-    QueryParams.bReturnPhysicalMaterial = false;
-    QueryParams.bIgnoreTouches = true;  // 忽略Touch事件，只关注实际的碰撞
-    
-    // 忽略所有无人机及其组件
-    QueryParams.AddIgnoredActor(Owner);  // 首先忽略自身
-    
-    // 存储所有需要忽略的组件
-    TArray<UPrimitiveComponent*> AllDroneComponents;
-    
-    for (AActor* DroneActor : DroneActors)
+    // 设置碰撞查询参数（忽略所有无人机及其组件，只在无人机注册表变化时重建）
+    const FCollisionQueryParams& QueryParams = GetScanQueryParams();
+
+    // 修改碰撞检测通道
+    ECollisionChannel CollisionChannel = SCAN_TRACE_CHANNEL;  // 使用自定义通道
+
+    // 体素模式：静态碰撞走体素快照，动态物体只对扫描范围内的少数组件逐个做物理检测
+    TSharedPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> StaticVoxels;
+    TArray<UPrimitiveComponent*> DynamicBlockers;
+    if (ScanBackend == EObstacleScanBackend::VoxelRaymarch)
     {
-        if (DroneActor != Owner)  // 避免重复添加自身
+        StaticVoxels = GetStaticCollisionSnapshot();
+        if (StaticVoxels.IsValid())
         {
-            QueryParams.AddIgnoredActor(DroneActor);
-            
-            // 获取并忽略所有组件
-            TArray<USceneComponent*> Components;
-            DroneActor->GetComponents<USceneComponent*>(Components);
-            for (USceneComponent* Component : Components)
+            TArray<FOverlapResult> Overlaps;
+            GetWorld()->OverlapMultiByChannel(Overlaps, Center + FVector(0, 0, ScanStartHeight), FQuat::Identity, CollisionChannel,
+                FCollisionShape::MakeSphere(Radius), QueryParams);
+            for (const FOverlapResult& Overlap : Overlaps)
             {
-                if (UPrimitiveComponent* PrimComponent = Cast<UPrimitiveComponent>(Component))
+                UPrimitiveComponent* Primitive = Overlap.GetComponent();
+                if (Overlap.bBlockingHit && Primitive && Primitive->Mobility != EComponentMobility::Static
+                    && !Cast<ADroneActor>(Overlap.GetActor()) && !FDroneRegistry::IsDroneComponent(Primitive))
                 {
-                    QueryParams.AddIgnoredComponent(PrimComponent);
-                    AllDroneComponents.Add(PrimComponent);
-                    
-                    // 获取所有附加的子组件
-                    TArray<USceneComponent*> ChildComponents;
-                    PrimComponent->GetChildrenComponents(true, ChildComponents);
-                    for (USceneComponent* ChildComponent : ChildComponents)
-                    {
-                        if (UPrimitiveComponent* ChildPrimComponent = Cast<UPrimitiveComponent>(ChildComponent))
-                        {
-                            QueryParams.AddIgnoredComponent(ChildPrimComponent);
-                            AllDroneComponents.Add(ChildPrimComponent);
-                        }
-                    }
+                    DynamicBlockers.AddUnique(Primitive);
                 }
             }
         }
     }
-
-    // 修改碰撞检测通道
-    ECollisionChannel CollisionChannel = ECC_GameTraceChannel1;  // 使用自定义通道
+    const DronePlanning::FVoxelRaycaster VoxelRaycaster(StaticVoxels.IsValid() ? *StaticVoxels : GridMap->GetPlanningGrid());
 
     // 使用ParallelFor并行处理扫描线
     ParallelFor(NumScanLines, [&](int32 LineIndex)
     {
-        // 计算当前线的垂直角度
-        float VerticalAngle = VerticalStart + LineIndex * VerticalStep;
-        
-        // 计算当前线的垂直方向（相对于水平面）
-        FVector VerticalDirection = FVector::UpVector * FMath::Sin(VerticalAngle);
-        
         // 对当前线进行水平扫描
         for (int32 PointIndex = 0; PointIndex < PointsPerLine; PointIndex++)
         {
-            // 计算当前点的水平角度
-            float HorizontalAngle = HorizontalStart + PointIndex * HorizontalStep;
-            
-            // 计算水平方向（相对于前向方向）
-            FVector HorizontalDirection = ForwardVector * FMath::Cos(HorizontalAngle) + RightVector * FMath::Sin(HorizontalAngle);
-            
-            // 组合垂直和水平方向
-            FVector Direction = (HorizontalDirection + VerticalDirection).GetSafeNormal();
-            
-            // 计算扫描起点和终点
-            FVector Start = ScanStartPoint + Direction * StartDistance;
-            FVector End = ScanStartPoint + Direction * EndDistance;
+            const int32 ArrayIndex = LineIndex * PointsPerLine + PointIndex;
+            const FVector& Start = RayStarts[ArrayIndex];
+            const FVector& End = RayEnds[ArrayIndex];
+
+            if (StaticVoxels.IsValid())
+            {
+                bool bVoxelHit = false;
+                FVector HitLocation = End;
+                DronePlanning::FVoxelHit VoxelHit;
+                if (VoxelRaycaster.Raycast(ToPlanningVec(Start), ToPlanningVec(End), VoxelHit))
+                {
+                    bVoxelHit = true;
+                    HitLocation = ToFVector(VoxelHit.Location);
+                }
+
+                // 只检测到目前最近命中点为止
+                for (UPrimitiveComponent* DynamicBlocker : DynamicBlockers)
+                {
+                    FHitResult DynamicHit;
+                    if (DynamicBlocker->LineTraceComponent(DynamicHit, Start, HitLocation, QueryParams))
+                    {
+                        bVoxelHit = true;
+                        HitLocation = DynamicHit.Location;
+                    }
+                }
+
+                ScanDataArray[ArrayIndex].bHit = bVoxelHit;
+                ScanDataArray[ArrayIndex].HitLocation = HitLocation;
+                continue;
+            }
 
             // 执行射线检测
             FHitResult HitResult;
@@ -206,112 +238,97 @@ void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
             );
 
             // 存储扫描结果
-            int32 ArrayIndex = LineIndex * PointsPerLine + PointIndex;
-            ScanDataArray[ArrayIndex].bHit = bHit;
-            if (bHit)
-            {
-                bool bIsValidHit = true;
-                // 检查是否击中无人机或其组件
-                if (HitResult.GetActor() || HitResult.GetComponent())
-                {
-                    AActor* HitActor = HitResult.GetActor();
-                    UPrimitiveComponent* HitComponent = HitResult.GetComponent();
-                    
-                    // 检查是否击中无人机
-                    bool bIsDroneHit = false;
-                    
-                    // 检查1：直接检查Actor
-                    if (Cast<ADroneActor>(HitActor))
-                    {
-                        bIsDroneHit = true;
-                    }
-                    // 检查2：检查组件是否属于无人机
-                    else if (HitComponent)
-                    {
-                        // 检查组件是否在我们的忽略列表中
-                        if (AllDroneComponents.Contains(HitComponent))
-                        {
-                            bIsDroneHit = true;
-                        }
-                        // 检查组件的所有父级是否是无人机组件
-                        else
-                        {
-                            USceneComponent* CurrentComponent = HitComponent->GetAttachParent();
-                            while (CurrentComponent)
-                            {
-                                if (UPrimitiveComponent* ParentPrim = Cast<UPrimitiveComponent>(CurrentComponent))
-                                {
-                                    if (AllDroneComponents.Contains(ParentPrim))
-                                    {
-                                        bIsDroneHit = true;
-                                        break;
-                                    }
-                                }
-                                CurrentComponent = CurrentComponent->GetAttachParent();
-                            }
-                        }
-                    }
-                    
-                    if (bIsDroneHit)
-                    {
-                        bIsValidHit = false;
-                    }
-                }
-
-                if (bIsValidHit)
-                {
-                    ScanDataArray[ArrayIndex].HitLocation = HitResult.Location;
-                }
-                else
-                {
-                    ScanDataArray[ArrayIndex].bHit = false;
-                }
-            }
+            ScanDataArray[ArrayIndex].bHit = bHit && IsValidScanHit(HitResult);
+            ScanDataArray[ArrayIndex].HitLocation = HitResult.Location;
         }
     });
 
-    // 处理扫描结果
+    IntegrateScanResults(RayStarts, RayEnds, ScanDataArray);
+}
+
+void UObstacleScannerComponent::BuildScanRays(const FVector& Center, float Radius, TArray<FVector>& OutStarts, TArray<FVector>& OutEnds) const
+{
+    const AActor* Owner = GetOwner();
+    FRotator OwnerRotation = Owner->GetActorRotation();
+    FVector ForwardVector = OwnerRotation.Vector();
+    FVector RightVector = FVector::CrossProduct(FRotator(0, OwnerRotation.Yaw, 0).Vector(), FVector::UpVector);
+
+    // 使用可配置的高度偏移
+    FVector ScanStartPoint = Center + FVector(0, 0, ScanStartHeight);
+
+    // 计算扫描范围
+    float StartDistance = 80.0f;  // 从扫描起点前方80厘米开始扫描
+    float EndDistance = Radius;   // 扫描到最大半径
+    
+    // 计算垂直角度步长
+    float VerticalStep = FMath::DegreesToRadians(VerticalScanAngle) / (NumScanLines - 1);
+    float VerticalStart = -FMath::DegreesToRadians(VerticalScanAngle) / 2.0f;
+    
+    // 计算水平角度步长
+    float HorizontalStep = FMath::DegreesToRadians(HorizontalScanAngle) / (PointsPerLine - 1);
+    float HorizontalStart = -FMath::DegreesToRadians(HorizontalScanAngle) / 2.0f;
+
+    // 按 线序号 * PointsPerLine + 点序号 排列
+    OutStarts.Reset(NumScanLines * PointsPerLine);
+    OutEnds.Reset(NumScanLines * PointsPerLine);
+    for (int32 LineIndex = 0; LineIndex < NumScanLines; LineIndex++)
+    {
+        // 计算当前线的垂直方向（相对于水平面）
+        float VerticalAngle = VerticalStart + LineIndex * VerticalStep;
+        FVector VerticalDirection = FVector::UpVector * FMath::Sin(VerticalAngle);
+
+        for (int32 PointIndex = 0; PointIndex < PointsPerLine; PointIndex++)
+        {
+            // 计算水平方向（相对于前向方向）
+            float HorizontalAngle = HorizontalStart + PointIndex * HorizontalStep;
+            FVector HorizontalDirection = ForwardVector * FMath::Cos(HorizontalAngle) + RightVector * FMath::Sin(HorizontalAngle);
+
+            // 组合垂直和水平方向
+            FVector Direction = (HorizontalDirection + VerticalDirection).GetSafeNormal();
+            OutStarts.Add(ScanStartPoint + Direction * StartDistance);
+            OutEnds.Add(ScanStartPoint + Direction * EndDistance);
+        }
+    }
+}
+
+bool UObstacleScannerComponent::IsValidScanHit(const FHitResult& HitResult)
+{
+    // 无人机使用的碰撞预设已忽略扫描通道，这里只防御未注册或预设被覆盖的情况（哈希查找）
+    return HitResult.bBlockingHit && !Cast<ADroneActor>(HitResult.GetActor())
+        && !FDroneRegistry::IsDroneComponent(HitResult.GetComponent());
+}
+
+void UObstacleScannerComponent::IntegrateScanResults(const TArray<FVector>& RayStarts, const TArray<FVector>& RayEnds, const TArray<FScanData>& ScanDataArray)
+{
+    if (!GridMap)
+    {
+        return;
+    }
+
+    // 概率模式：命中与未命中的射线都参与积分，未命中的射线走到最大扫描距离
+    if (GridMap->bUseLogOddsOccupancy)
+    {
+        TArray<FVector> RayHitEnds;
+        TArray<bool> bRayHits;
+        RayHitEnds.SetNumUninitialized(ScanDataArray.Num());
+        bRayHits.SetNumUninitialized(ScanDataArray.Num());
+        for (int32 RayIndex = 0; RayIndex < ScanDataArray.Num(); RayIndex++)
+        {
+            const FScanData& ScanData = ScanDataArray[RayIndex];
+            RayHitEnds[RayIndex] = ScanData.bHit ? ScanData.HitLocation : RayEnds[RayIndex];
+            bRayHits[RayIndex] = ScanData.bHit;
+        }
+        GridMap->IntegrateScanRays(RayStarts, RayHitEnds, bRayHits);
+    }
+
+    // 处理扫描结果：只收集命中点，量化去重和膨胀由GridMap在网格索引空间内一次完成（每帧只广播一次地图更新）
+    TArray<FVector> HitLocations;
+    HitLocations.Reserve(ScanDataArray.Num());
     for (const FScanData& ScanData : ScanDataArray)
     {
         if (ScanData.bHit)
         {
-            // 对障碍物进行膨胀处理
-            const float InflationRadius = 80.0f; // 膨胀半径80厘米
-           
-            // 计算膨胀后的网格范围
-            int32 GridX, GridY, GridZ;
-            if (GridMap->WorldToGrid(ScanData.HitLocation, GridX, GridY, GridZ))
-            {
-                // 计算膨胀范围（以网格单位）
-                int32 InflationCells = FMath::CeilToInt(InflationRadius / GridMap->GetResolution());
-                    
-                // 在膨胀范围内标记障碍物
-                for (int32 X = -InflationCells; X <= InflationCells; X++)
-                {
-                    for (int32 Y = -InflationCells; Y <= InflationCells; Y++)
-                    {
-                        for (int32 Z = -InflationCells/2; Z <= InflationCells/2; Z++)
-                        {
-                            FVector InflatedLocation = GridMap->GridToWorld(GridX + X, GridY + Y, GridZ + Z);
-                            float Distance = FVector::Distance(InflatedLocation, ScanData.HitLocation);
-                           
-                            if (Distance <= InflationRadius)
-                            {
-                                // 检查该位置是否已经被标记为障碍物
-                                if (!GridMap->IsOccupied(InflatedLocation))
-                                {
-                                    int32 GridX2, GridY2, GridZ2;
-                                    if (GridMap->WorldToGrid(InflatedLocation,GridX2, GridY2, GridZ2))
-                                    {
-                                        UpdateGridMap(InflatedLocation, true);
-                                        // UE_LOG(LogTemp, Warning, TEXT("update obs"))
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            HitLocations.Add(ScanData.HitLocation);
 
             // 调试可视化
             if (bShowDebugVisualization)
@@ -330,11 +347,233 @@ void UObstacleScannerComponent::ScanArea(const FVector& Center, float Radius)
             }
         }
     }
-    ScanDataArray.Empty();
+
+    if (HitLocations.Num() > 0 && !GridMap->bUseLogOddsOccupancy)
+    {
+        UpdateGridMap(HitLocations);
+    }
+}
+
+void UObstacleScannerComponent::BeginAsyncScan(const FVector& Center, float Radius)
+{
+    // 上一次扫描的结果还没有全部返回时跳过本次，避免请求堆积
+    if (bAsyncScanInFlight)
+    {
+        return;
+    }
+
+    BuildScanRays(Center, Radius, AsyncScan.RayStarts, AsyncScan.RayEnds);
+    AsyncScan.Results.Reset();
+    AsyncScan.Results.SetNumZeroed(AsyncScan.RayStarts.Num());
+    AsyncScan.NumSubmitted = 0;
+    AsyncScan.NumCompleted = 0;
+    bAsyncScanInFlight = AsyncScan.RayStarts.Num() > 0;
+
+    SubmitAsyncTraces();
+}
+
+void UObstacleScannerComponent::SubmitAsyncTraces()
+{
+    UWorld* World = GetWorld();
+    if (!bAsyncScanInFlight || !World)
+    {
+        return;
+    }
+
+    // 无人机的碰撞预设已忽略扫描通道，不再为每条射线拷贝完整的忽略列表；其余设置与同步扫描相同
+    FCollisionQueryParams AsyncQueryParams(SCENE_QUERY_STAT(ObstacleScanAsync));
+    ApplyScanQuerySettings(AsyncQueryParams);
+
+    const int32 NumRays = AsyncScan.RayStarts.Num();
+    const int32 Budget = MaxAsyncTracesPerFrame > 0 ? MaxAsyncTracesPerFrame : NumRays;
+    const int32 End = FMath::Min(NumRays, AsyncScan.NumSubmitted + Budget);
+    for (int32 RayIndex = AsyncScan.NumSubmitted; RayIndex < End; ++RayIndex)
+    {
+        World->AsyncLineTraceByChannel(EAsyncTraceType::Single, AsyncScan.RayStarts[RayIndex], AsyncScan.RayEnds[RayIndex],
+            SCAN_TRACE_CHANNEL, AsyncQueryParams, FCollisionResponseParams::DefaultResponseParam, &AsyncTraceDelegate, (uint32)RayIndex);
+    }
+    AsyncScan.NumSubmitted = End;
 }
 
+void UObstacleScannerComponent::OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+    const int32 RayIndex = (int32)TraceDatum.UserData;
+    if (!bAsyncScanInFlight || !AsyncScan.Results.IsValidIndex(RayIndex))
+    {
+        return;
+    }
+
+    FScanData& ScanData = AsyncScan.Results[RayIndex];
+    ScanData.bHit = TraceDatum.OutHits.Num() > 0 && IsValidScanHit(TraceDatum.OutHits[0]);
+    ScanData.HitLocation = ScanData.bHit ? TraceDatum.OutHits[0].Location : FVector::ZeroVector;
 
-void UObstacleScannerComponent::UpdateGridMap(const FVector& HitLocation, bool bIsObstacle)
+    // 整套射线都返回后一次性写入地图
+    if (++AsyncScan.NumCompleted == AsyncScan.RayStarts.Num())
+    {
+        bAsyncScanInFlight = false;
+        IntegrateScanResults(AsyncScan.RayStarts, AsyncScan.RayEnds, AsyncScan.Results);
+    }
+}
+
+void UObstacleScannerComponent::ApplyScanQuerySettings(FCollisionQueryParams& Params) const
+{
+    Params.bTraceComplex = true;  // 启用复杂碰撞以检测所有组件
+    Params.bReturnPhysicalMaterial = false;
+    Params.bIgnoreTouches = true;  // 忽略Touch事件，只关注实际的碰撞
+    Params.AddIgnoredActor(GetOwner());  // 挂在非无人机Actor上时也忽略自身
+}
+
+const FCollisionQueryParams& UObstacleScannerComponent::GetScanQueryParams()
+{
+    if (!bScanQueryParamsValid || ScanQueryParamsVersion != FDroneRegistry::GetVersion())
+    {
+        ScanQueryParams = FDroneRegistry::GetIgnoreDronesQueryParams();
+        ApplyScanQuerySettings(ScanQueryParams);
+
+        ScanQueryParamsVersion = FDroneRegistry::GetVersion();
+        bScanQueryParamsValid = true;
+    }
+    return ScanQueryParams;
+}
+
+UObstacleScannerComponent::FStaticCollisionSnapshot& UObstacleScannerComponent::FindOrAddStaticCollisionSnapshot()
+{
+    StaticCollisionSnapshots.RemoveAll([](const FStaticCollisionSnapshot& Snapshot) { return !Snapshot.World.IsValid(); });
+
+    UWorld* World = GetWorld();
+    for (FStaticCollisionSnapshot& Snapshot : StaticCollisionSnapshots)
+    {
+        if (Snapshot.World.Get() == World && Snapshot.VoxelSize == CollisionVoxelSize)
+        {
+            return Snapshot;
+        }
+    }
+
+    FStaticCollisionSnapshot& Snapshot = StaticCollisionSnapshots.AddDefaulted_GetRef();
+    Snapshot.World = World;
+    Snapshot.VoxelSize = CollisionVoxelSize;
+    return Snapshot;
+}
+
+TSharedPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> UObstacleScannerComponent::GetStaticCollisionSnapshot()
+{
+    {
+        const FStaticCollisionSnapshot& Snapshot = FindOrAddStaticCollisionSnapshot();
+        if (Snapshot.Voxels.IsValid() || Snapshot.BuildSerial != 0)
+        {
+            return Snapshot.Voxels;
+        }
+    }
+    RebuildStaticCollisionSnapshot();
+    return nullptr;
+}
+
+void UObstacleScannerComponent::RebuildStaticCollisionSnapshot()
+{
+    UWorld* World = GetWorld();
+    if (!World || !GridMap || !GridMap->GetPlanningGrid().IsInitialized())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ObstacleScanner: cannot build collision snapshot without a world and an initialized GridMap"));
+        return;
+    }
+
+    const double BuildBegin = FPlatformTime::Seconds();
+    TSharedRef<DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> Voxels = MakeShared<DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe>();
+    // 与GridMap使用相同的存储模式，大地图上体素快照的内存同样只随静态碰撞体增长
+    Voxels->Initialize(ToPlanningVec(GridMap->GetMapOrigin()), ToPlanningVec(GridMap->GetMapSize()), CollisionVoxelSize,
+        GridMap->GetPlanningGrid().IsSparse());
+
+    // 游戏线程上只收集静态组件及其覆盖的体素范围，逐体素的重叠测试在后台线程进行
+    TArray<FStaticCollisionPrimitive> StaticPrimitives;
+    for (TActorIterator<AActor> It(World); It; ++It)
+    {
+        AActor* Actor = *It;
+        if (Cast<ADroneActor>(Actor) || GridMap->IgnoredActors.Contains(Actor))
+        {
+            continue;
+        }
+
+        TInlineComponentArray<UPrimitiveComponent*> Primitives(Actor);
+        for (UPrimitiveComponent* Primitive : Primitives)
+        {
+            if (Primitive->Mobility != EComponentMobility::Static || !BlocksScanChannel(Primitive))
+            {
+                continue;
+            }
+
+            const FBox Bounds = Primitive->Bounds.GetBox();
+            int32 MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+            Voxels->WorldToGrid(ToPlanningVec(Bounds.Min), MinX, MinY, MinZ);
+            Voxels->WorldToGrid(ToPlanningVec(Bounds.Max), MaxX, MaxY, MaxZ);
+
+            FStaticCollisionPrimitive& StaticPrimitive = StaticPrimitives.AddDefaulted_GetRef();
+            StaticPrimitive.Primitive = Primitive;
+            StaticPrimitive.Min = FIntVector(FMath::Max(MinX, 0), FMath::Max(MinY, 0), FMath::Max(MinZ, 0));
+            StaticPrimitive.Max = FIntVector(FMath::Min(MaxX, Voxels->GetDimX() - 1), FMath::Min(MaxY, Voxels->GetDimY() - 1),
+                FMath::Min(MaxZ, Voxels->GetDimZ() - 1));
+        }
+    }
+
+    // 新的构建取代尚未完成的旧构建；旧快照在新结果到达前继续使用
+    const uint32 BuildSerial = ++NextStaticCollisionBuildSerial;
+    FindOrAddStaticCollisionSnapshot().BuildSerial = BuildSerial;
+
+    const float VoxelSize = CollisionVoxelSize;
+    Async(EAsyncExecution::ThreadPool,
+        [Voxels, StaticPrimitives = MoveTemp(StaticPrimitives), VoxelSize, BuildSerial, BuildBegin]()
+        {
+            {
+                // 构建期间暂缓垃圾回收，组件在此之前已被销毁（关卡卸载）则跳过
+                FGCScopeGuard GCGuard;
+
+                // 每个静态组件只在自身包围盒内逐体素做一次重叠测试
+                const FCollisionShape VoxelShape = FCollisionShape::MakeBox(FVector(VoxelSize * 0.5f));
+                for (const FStaticCollisionPrimitive& StaticPrimitive : StaticPrimitives)
+                {
+                    UPrimitiveComponent* Primitive = StaticPrimitive.Primitive.Get();
+                    if (!Primitive)
+                    {
+                        continue;
+                    }
+
+                    for (int32 Z = StaticPrimitive.Min.Z; Z <= StaticPrimitive.Max.Z; ++Z)
+                    {
+                        for (int32 Y = StaticPrimitive.Min.Y; Y <= StaticPrimitive.Max.Y; ++Y)
+                        {
+                            for (int32 X = StaticPrimitive.Min.X; X <= StaticPrimitive.Max.X; ++X)
+                            {
+                                const int64 Index = Voxels->GetCellIndex(X, Y, Z);
+                                if (!Voxels->IsOccupiedIndex(Index)
+                                    && Primitive->OverlapComponent(ToFVector(Voxels->GridToWorld(X, Y, Z)), FQuat::Identity, VoxelShape))
+                                {
+                                    Voxels->SetOccupiedIndex(Index);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            const int32 NumComponents = StaticPrimitives.Num();
+            AsyncTask(ENamedThreads::GameThread, [Voxels, NumComponents, BuildSerial, BuildBegin]()
+            {
+                for (FStaticCollisionSnapshot& Snapshot : StaticCollisionSnapshots)
+                {
+                    if (Snapshot.BuildSerial == BuildSerial)
+                    {
+                        Snapshot.Voxels = Voxels;
+                        Snapshot.BuildSerial = 0;
+                        UE_LOG(LogTemp, Log, TEXT("ObstacleScanner: voxelized %d static components into %d x %d x %d cells (%lld occupied) in %.1f ms"),
+                            NumComponents, Voxels->GetDimX(), Voxels->GetDimY(), Voxels->GetDimZ(), Voxels->CountOccupied(),
+                            (FPlatformTime::Seconds() - BuildBegin) * 1000.0);
+                        return;
+                    }
+                }
+            });
+        });
+}
+
+void UObstacleScannerComponent::UpdateGridMap(const TArray<FVector>& HitLocations)
 {
     // UE_LOG(LogTemp,Log,TEXT("[obstaclescan]:we are going to update"));
     if (!GridMap)
@@ -343,11 +582,10 @@ void UObstacleScannerComponent::UpdateGridMap(const FVector& HitLocation, bool b
         return;
     }
     
-    // 更新网格状态
-    if (bIsObstacle)
-    {
-        GridMap->MarkAsOccupied(HitLocation);
-    }
+    // 对障碍物进行膨胀处理：膨胀半径80厘米，z方向只膨胀一半
+    const float InflationRadius = 80.0f;
+    const int32 InflationCells = FMath::CeilToInt(InflationRadius / GridMap->GetResolution());
+    GridMap->MarkInflatedHits(HitLocations, InflationRadius, InflationCells / 2);
     
 }
 
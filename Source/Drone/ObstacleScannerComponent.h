@@ -4,11 +4,24 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "GridMapComponent.h"
+#include "PlanningCore/OccupancyGrid.h"
+#include "WorldCollision.h"
 #include "HAL/PlatformFileManager.h"
 #include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
 #include "ObstacleScannerComponent.generated.h"
 
+// 射线求交方式
+UENUM(BlueprintType)
+enum class EObstacleScanBackend : uint8
+{
+    // 每条扫描线一次物理射线检测
+    PhysicsTrace    UMETA(DisplayName = "Physics Trace"),
+
+    // 静态碰撞体素化一次后在工作线程上做3D-DDA，只对动态物体做物理检测
+    VoxelRaymarch   UMETA(DisplayName = "Voxel Raymarch"),
+};
+
 // 扫描数据结构体
 struct FScanData
 {
@@ -33,6 +46,11 @@ public:
     UFUNCTION(BlueprintCallable, Category="PathPlanning|Scanner")
     void ScanArea(const FVector& Center, float Radius);
 
+    // 在后台重新体素化场景中的静态碰撞（关卡流送或静态物体变化后调用），体素边长相同的扫描组件共享同一份结果；
+    // 构建完成前继续使用旧快照
+    UFUNCTION(BlueprintCallable, Category="PathPlanning|Scanner")
+    void RebuildStaticCollisionSnapshot();
+
 
 protected:
     virtual void BeginPlay() override;
@@ -43,13 +61,68 @@ private:
     UPROPERTY()
     UGridMapComponent* GridMap;
 
+    // GridMap未设置时在场景中查找
+    bool ResolveGridMap();
+
     // 扫描计时器句柄
     FTimerHandle ScanTimerHandle;
     
     // 上次扫描后经过的时间
     float TimeSinceLastScan = 0.0f;
     void OnScanTimer();
-    void UpdateGridMap(const FVector& HitLocation, bool bIsObstacle);
+
+    // 生成扫描射线（按 线序号 * PointsPerLine + 点序号 排列）
+    void BuildScanRays(const FVector& Center, float Radius, TArray<FVector>& OutStarts, TArray<FVector>& OutEnds) const;
+
+    // 过滤掉命中无人机的结果
+    static bool IsValidScanHit(const FHitResult& HitResult);
+
+    // 把一次扫描的结果批量写入GridMap：默认只膨胀写入命中点，log-odds模式下连同未命中的射线一起积分
+    void IntegrateScanResults(const TArray<FVector>& RayStarts, const TArray<FVector>& RayEnds, const TArray<FScanData>& ScanDataArray);
+
+    // 异步扫描：射线通过AsyncLineTraceByChannel提交，每帧最多MaxAsyncTracesPerFrame条，结果在后续帧回调
+    struct FAsyncScanState
+    {
+        TArray<FVector> RayStarts;
+        TArray<FVector> RayEnds;
+        TArray<FScanData> Results;
+        int32 NumSubmitted = 0;
+        int32 NumCompleted = 0;
+    };
+    FAsyncScanState AsyncScan;
+    bool bAsyncScanInFlight = false;
+    FTraceDelegate AsyncTraceDelegate;
+
+    void BeginAsyncScan(const FVector& Center, float Radius);
+    void SubmitAsyncTraces();
+    void OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+    // 同步与异步扫描共用的查询设置，保证两种模式对同一条射线命中相同的几何体
+    void ApplyScanQuerySettings(FCollisionQueryParams& Params) const;
+
+    // 扫描查询参数缓存，无人机注册表版本变化时重建
+    FCollisionQueryParams ScanQueryParams;
+    uint32 ScanQueryParamsVersion = 0;
+    bool bScanQueryParamsValid = false;
+    const FCollisionQueryParams& GetScanQueryParams();
+
+    // 当前世界、当前体素边长的静态碰撞体素；尚未构建时在后台开始体素化并返回空，完成前按PhysicsTrace检测
+    TSharedPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> GetStaticCollisionSnapshot();
+
+    // 静态碰撞快照按（世界，体素边长）共享，CollisionVoxelSize不同的扫描组件各自使用自己的快照
+    struct FStaticCollisionSnapshot
+    {
+        TWeakObjectPtr<UWorld> World;
+        float VoxelSize = 0.0f;
+        TSharedPtr<const DronePlanning::FOccupancyGrid, ESPMode::ThreadSafe> Voxels;
+        uint32 BuildSerial = 0;  // 正在进行的后台构建，0表示没有
+    };
+    static TArray<FStaticCollisionSnapshot> StaticCollisionSnapshots;
+    static uint32 NextStaticCollisionBuildSerial;
+
+    // 同时清理已销毁世界的快照
+    FStaticCollisionSnapshot& FindOrAddStaticCollisionSnapshot();
+    void UpdateGridMap(const TArray<FVector>& HitLocations);
 
 public:
     // 扫描参数
@@ -60,6 +133,22 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|Scanner")
     bool bShowDebugVisualization = false;
 
+    // 射线求交方式
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|Scanner")
+    EObstacleScanBackend ScanBackend = EObstacleScanBackend::PhysicsTrace;
+
+    // PhysicsTrace模式下使用异步射线检测，结果在后续帧处理，不阻塞游戏线程
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|Scanner")
+    bool bAsyncTraces = false;
+
+    // 异步模式下每帧最多提交的射线数（0表示一次提交整套扫描）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|Scanner", meta = (ClampMin = "0"))
+    int32 MaxAsyncTracesPerFrame = 400;
+
+    // VoxelRaymarch模式下静态碰撞体素的边长（厘米），覆盖范围与GridMap相同
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning|Scanner", meta = (ClampMin = "1"))
+    float CollisionVoxelSize = 20.0f;
+
     // 扫描间隔（秒）
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleScanner")
     float ScanInterval = 0.1f;  // 改为1秒扫描一次
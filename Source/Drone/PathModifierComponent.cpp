@@ -3,6 +3,7 @@
 #include "GridMapComponent.h"
 #include "AStarPathFinderComponent.h"
 #include "DroneActor.h"
+#include "PlanningCoreConversions.h"
 #include "EngineUtils.h"
 
 UPathModifierComponent::UPathModifierComponent()
@@ -44,7 +45,7 @@ void UPathModifierComponent::BeginPlay()
         // 订阅GridMap更新事件
         if (GridMap)
         {
-            GridMap->OnGridMapUpdated.AddDynamic(this, &UPathModifierComponent::OnGridUpdated);
+            GridMap->OnGridMapUpdatedBatch.AddDynamic(this, &UPathModifierComponent::OnGridUpdated);
             UE_LOG(LogTemp, Log, TEXT("[PathModifier] Successfully subscribed to GridMap updates"));
         }
         else
@@ -57,10 +58,21 @@ void UPathModifierComponent::BeginPlay()
 void UPathModifierComponent::SetPath(const TArray<FVector>& InPath)
 {
     CurrentPath = InPath;
+    bPathSegmentsDirty = true;
     // UE_LOG(LogTemp, Warning, TEXT("[PathModifier] SetPath 被调用，路径点数: %d"), CurrentPath.Num());
 }
 
 void UPathModifierComponent::CheckAndModifyPath()
+{
+    if (!GridMap)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[PathModifier] GridMap component not found"));
+        return;
+    }
+    CheckAndModifyPathInRegion(GridMap->GetPlanningGrid().GetBounds());
+}
+
+void UPathModifierComponent::CheckAndModifyPathInRegion(const DronePlanning::FCellBounds& DirtyCells)
 {
     if (!GridMap)
     {
@@ -74,35 +86,97 @@ void UPathModifierComponent::CheckAndModifyPath()
         return;
     }
 
-    // 检查路径的每个点
-    bNeedsReplanning = false;  // 使用类成员变量
-    for (const FVector& Point : CurrentPath)
+    if (bPathSegmentsDirty)
     {
-        if (GridMap->IsOccupied(Point))
-        {
-            bNeedsReplanning = true;
-            // UE_LOG(LogTemp, Warning, TEXT("[PathModifier] 检测到路径点被占用: %s"), *Point.ToString());
-            break;
-        }
+        PathSegments.Build(GridMap->GetPlanningGrid(), ToPlanningPath(CurrentPath));
+        bPathSegmentsDirty = false;
     }
 
-    // 如果需要重新规划
-    if (bNeedsReplanning)
+    // 无人机正飞向CurrentPath[CurrentPathIndex]，之前的线段已经飞过
+    CurrentPathIndex = OwnerDrone ? OwnerDrone->GetCurrentPathIndex() : 0;
+    const int32 FirstSegment = FMath::Max(CurrentPathIndex - 1, 0);
+
+    // 只检查与脏区域相交的剩余线段
+    const DronePlanning::FCellBounds& CheckCells = bRecheckWholePath ? GridMap->GetPlanningGrid().GetBounds() : DirtyCells;
+    const int32 BlockedSegment = PathSegments.FindFirstBlockedSegment(GridMap->GetPlanningGrid(), CheckCells, FirstSegment);
+    bNeedsReplanning = BlockedSegment >= 0;  // 使用类成员变量
+    bRecheckWholePath = bNeedsReplanning && AStar->IsAsyncPathPending();
+    // if (bNeedsReplanning) UE_LOG(LogTemp, Warning, TEXT("[PathModifier] 检测到线段 %d 被占用"), BlockedSegment);
+
+    // 如果需要重新规划（已有规划在后台进行时不再重复提交，下一次地图更新时会检查新路径）
+    if (bNeedsReplanning && !AStar->IsAsyncPathPending())
     {
-        TArray<FVector> NewPath;
-        if (AStar && CurrentPath.Num() >= 2)
+        if (CurrentPath.Num() >= 2)
         {
             // 使用当前位置和原始目标点重新规划路径
             FVector StartPoint = GetOwner()->GetActorLocation();  // 使用当前位置作为起点
-            if (AStar->FindPath(StartPoint, OwnerDrone->GetGoalLocation(), NewPath, DroneID))
+            if (bUseIncrementalReplanning && TryIncrementalReplan(StartPoint, OwnerDrone->GetGoalLocation()))
             {
-                CurrentPath = NewPath;
-                OnPathModified.Broadcast(CurrentPath);
+                return;
             }
+
+            AStar->FindPathAsync(StartPoint, OwnerDrone->GetGoalLocation(), GetOwnerDroneID(), FOnPathPlanned::CreateWeakLambda(this,
+                [this](bool bSuccess, const TArray<FVector>& NewPath)
+                {
+                    if (bSuccess)
+                    {
+                        ApplyReplannedPath(NewPath);
+                    }
+                }));
         }
     }
 }
 
+int32 UPathModifierComponent::GetOwnerDroneID() const
+{
+    return OwnerDrone ? OwnerDrone->GetDroneID() : -1;
+}
+
+bool UPathModifierComponent::TryIncrementalReplan(const FVector& Start, const FVector& Goal)
+{
+    const int32 DroneID = GetOwnerDroneID();
+    IncrementalPlanner.Config.MaxSearchSteps = IncrementalReplanMaxSteps;
+
+    std::vector<DronePlanning::FVec3> RawPath;
+    const DronePlanning::EPlanStatus Status = IncrementalPlanner.Plan(GridMap->GetPlanningGrid(), ToPlanningVec(Start), ToPlanningVec(Goal), RawPath);
+    const DronePlanning::FSearchStats& Stats = IncrementalPlanner.GetLastStats();
+    if (Status != DronePlanning::EPlanStatus::Success)
+    {
+        UE_LOG(LogTemp, Log, TEXT("[PathModifier] DroneID: %d 增量重规划 %s (expansions: %d)，改用A*"),
+            DroneID, UTF8_TO_TCHAR(DronePlanning::LexToString(Status)), Stats.Expansions);
+        return false;
+    }
+
+    // 增量规划不考虑预约表，与其他无人机冲突时交给A*
+    TArray<FVector> NewPath;
+    if (!AStar->CommitExternalPath(RawPath, DroneID, NewPath))
+    {
+        UE_LOG(LogTemp, Log, TEXT("[PathModifier] DroneID: %d 增量重规划路径与预约冲突，改用A*"), DroneID);
+        return false;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("[PathModifier] DroneID: %d 增量重规划 (expansions: %d, updated cells: %d, cost: %.1f)"),
+        DroneID, Stats.Expansions, Stats.GeneratedNodes, Stats.PathCost);
+    ApplyReplannedPath(NewPath);
+    return true;
+}
+
+void UPathModifierComponent::ApplyReplannedPath(const TArray<FVector>& NewPath)
+{
+    CurrentPath = NewPath;
+    bPathSegmentsDirty = true;
+    OnPathModified.Broadcast(CurrentPath);
+
+    // 无人机会把新路径拼接到已飞过的部分之后，与其保持一致以便按CurrentPathIndex跳过已飞过的线段
+    if (OwnerDrone)
+    {
+        SetPath(OwnerDrone->GetCurrentPath());
+    }
+
+    // 规划期间地图可能已经变化
+    bRecheckWholePath = true;
+}
+
 void UPathModifierComponent::SetGridMap(UGridMapComponent* InGridMap)
 {
     if (!InGridMap)
@@ -114,19 +188,36 @@ void UPathModifierComponent::SetGridMap(UGridMapComponent* InGridMap)
     // 如果已经有GridMap，先取消订阅
     if (GridMap)
     {
-        GridMap->OnGridMapUpdated.RemoveDynamic(this, &UPathModifierComponent::OnGridUpdated);
+        GridMap->OnGridMapUpdatedBatch.RemoveDynamic(this, &UPathModifierComponent::OnGridUpdated);
     }
 
     GridMap = InGridMap;
+    bPathSegmentsDirty = true;
+    IncrementalPlanner.Reset();
 
     // 订阅新的GridMap更新事件
-    GridMap->OnGridMapUpdated.AddDynamic(this, &UPathModifierComponent::OnGridUpdated);
+    GridMap->OnGridMapUpdatedBatch.AddDynamic(this, &UPathModifierComponent::OnGridUpdated);
     UE_LOG(LogTemp, Log, TEXT("[PathModifier] GridMap set and subscribed to updates"));
 }
 
-void UPathModifierComponent::OnGridUpdated(const FVector& UpdatedLocation)
+void UPathModifierComponent::OnGridUpdated(const FGridDirtyRegion& DirtyRegion)
 {
-    CheckAndModifyPath();
+    const DronePlanning::FCellBounds DirtyCells(
+        DronePlanning::FIntVec3(DirtyRegion.MinCell.X, DirtyRegion.MinCell.Y, DirtyRegion.MinCell.Z),
+        DronePlanning::FIntVec3(DirtyRegion.MaxCell.X, DirtyRegion.MaxCell.Y, DirtyRegion.MaxCell.Z));
+
+    // 地图重新初始化后网格坐标可能改变，需要重建线段索引，增量规划器从头搜索
+    if (DirtyRegion.bWholeMap)
+    {
+        bPathSegmentsDirty = true;
+        IncrementalPlanner.Reset();
+    }
+    else if (GridMap)
+    {
+        IncrementalPlanner.NotifyCellsChanged(GridMap->GetPlanningGrid(), DirtyCells);
+    }
+
+    CheckAndModifyPathInRegion(DirtyCells);
 }
 
 void UPathModifierComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -226,31 +317,19 @@ void UPathModifierComponent::TickComponent(float DeltaTime, ELevelTick TickType,
     {
         if (OwnerDrone && CurrentPath.Num() >= 2)
         {
+            const int32 DroneID = OwnerDrone->GetDroneID();
+
             // 停止移动
             OwnerDrone->StopMovement();
             // UE_LOG(LogTemp, Warning, TEXT("[PathModifier] DroneID: %d 因冲突临时停止移动"), DroneID);
 
-            // 获取并修改当前无人机的预约表
-            TMap<int32, FDroneReservation>& MutableReservationTable = const_cast<TMap<int32, FDroneReservation>&>(AStar->GetReservationTable());
-            if (MutableReservationTable.Contains(DroneID))
-            {
-                FDroneReservation& Reservation = MutableReservationTable[DroneID];
-                TArray<FSpaceTimePoint>& PathPoints = Reservation.PathPoints;
-                
-                // 从当前时间开始，将所有后续路径点的时间戳增加0.5秒
-                for (int32 i = 0; i < PathPoints.Num(); ++i)
-                {
-                    if (PathPoints[i].AbsTime >= CurrentTime)
-                    {
-                        PathPoints[i].AbsTime += StopDuration;
-                    }
-                }
-            }
+            // 从当前时间开始，将当前无人机所有后续预约点的时间戳增加0.5秒
+            UAStarPathFinderComponent::DelayReservation(DroneID, CurrentTime, StopDuration);
 
             // 设置定时器在0.5秒后恢复移动
             GetWorld()->GetTimerManager().SetTimer(
                 StopTimerHandle,
-                [this]()
+                [this, DroneID]()
                 {
                     if (OwnerDrone)
                     {
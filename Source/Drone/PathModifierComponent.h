@@ -1,6 +1,9 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "GridMapComponent.h"
+#include "PlanningCore/DStarLitePlanner.h"
+#include "PlanningCore/PathSegmentIndex.h"
 #include "PathModifierComponent.generated.h"
 
 // 声明路径更新的委托
@@ -26,7 +29,7 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Path")
     void SetPath(const TArray<FVector>& InPath);
 
-    // 检查路径是否可行并自动修正
+    // 检查路径是否可行并自动修正（检查尚未飞过的全部线段）
     UFUNCTION(BlueprintCallable)
     void CheckAndModifyPath();
 
@@ -42,6 +45,15 @@ public:
     UPROPERTY(BlueprintAssignable, Category="PathPlanning")
     FOnPathModified OnPathModified;
 
+    // 路径被阻塞时先用D* Lite增量重规划（只修复地图变化影响的部分），
+    // 失败、超出步数预算或与其他无人机预约冲突时退回异步A*
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning")
+    bool bUseIncrementalReplanning = true;
+
+    // 每次增量重规划的最大扩展次数；超出时搜索状态保留，下一次重规划继续
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPlanning", meta=(ClampMin="1"))
+    int32 IncrementalReplanMaxSteps = 20000;
+
 protected:
     // 当前路径
     TArray<FVector> CurrentPath;
@@ -58,8 +70,8 @@ protected:
     UPROPERTY()
     class ADroneActor* OwnerDrone;
 
-    // 无人机ID
-    int32 DroneID;
+    // 无人机ID取自OwnerDrone（ID可能在BeginPlay之后才分配，因此每次使用时读取），没有OwnerDrone时为-1
+    int32 GetOwnerDroneID() const;
 
     // 临时停止的计时器句柄
     FTimerHandle StopTimerHandle;
@@ -68,9 +80,28 @@ protected:
     const float StopDuration = 0.5f;
 
     UFUNCTION()
-    void OnGridUpdated(const FVector& UpdatedLocation);  // 接收网格更新通知
+    void OnGridUpdated(const FGridDirtyRegion& DirtyRegion);  // 接收网格更新通知（每帧最多一次）
 
 private:
     int32 CurrentPathIndex = 0;  // 添加当前路径索引变量
     bool bNeedsReplanning = false;  // 添加重规划标志
+
+    // CurrentPath的线段空间索引，路径或地图尺寸变化后在下一次检查时重建
+    DronePlanning::FPathSegmentIndex PathSegments;
+    bool bPathSegmentsDirty = true;
+
+    // 路径来自旧地图快照、或上次发现阻塞但未能提交重规划时，下一次检查覆盖全部剩余线段
+    bool bRecheckWholePath = false;
+
+    // 只检查与DirtyCells相交、且在无人机当前位置之后的线段，有线段被占用时才重规划
+    void CheckAndModifyPathInRegion(const DronePlanning::FCellBounds& DirtyCells);
+
+    // 跨重规划保留搜索树的增量规划器，地图变化通过OnGridUpdated通知
+    DronePlanning::FDStarLitePlanner IncrementalPlanner;
+
+    // 同步增量重规划并提交，成功时已应用新路径
+    bool TryIncrementalReplan(const FVector& Start, const FVector& Goal);
+
+    // 采用新路径（已写入预约表）并通知无人机
+    void ApplyReplannedPath(const TArray<FVector>& NewPath);
 };
@@ -0,0 +1,140 @@
+// AStarNodePool.cpp
+#include "AStarNodePool.h"
+
+namespace DronePlanning
+{
+    namespace
+    {
+        constexpr uint32_t INITIAL_SLOT_BITS = 10;
+    }
+
+    FAStarNodePool::FAStarNodePool()
+        : Slots(size_t(1) << INITIAL_SLOT_BITS),
+          SlotMask((1u << INITIAL_SLOT_BITS) - 1),
+          SlotShift(64 - INITIAL_SLOT_BITS)
+    {
+    }
+
+    void FAStarNodePool::Reset()
+    {
+        NumNodes = 0;
+        if (++Generation == 0)
+        {
+            // 代数回绕时才需要真正清空哈希表
+            for (FSlot& Entry : Slots)
+            {
+                Entry.Generation = 0;
+            }
+            Generation = 1;
+        }
+    }
+
+    FAStarNode* FAStarNodePool::Add(int64_t CellIndex, const FVec3& Position, int32_t X, int32_t Y, int32_t Z)
+    {
+        const size_t BlockIndex = (size_t)(NumNodes >> BLOCK_SHIFT);
+        if (BlockIndex == Blocks.size())
+        {
+            Blocks.emplace_back(new FAStarNode[BLOCK_SIZE]);
+        }
+
+        FAStarNode* Node = &Blocks[BlockIndex][NumNodes & (BLOCK_SIZE - 1)];
+        NumNodes++;
+        *Node = FAStarNode();
+        Node->Position = Position;
+        Node->GridX = X;
+        Node->GridY = Y;
+        Node->GridZ = Z;
+
+        // 负载因子保持在1/2以下
+        if ((uint32_t)NumNodes * 2 > SlotMask + 1)
+        {
+            GrowSlots();
+        }
+        Insert(CellIndex, Node);
+        return Node;
+    }
+
+    void FAStarNodePool::Insert(int64_t CellIndex, FAStarNode* Node)
+    {
+        uint32_t Slot = Hash(CellIndex);
+        while (Slots[Slot].Generation == Generation)
+        {
+            Slot = (Slot + 1) & SlotMask;
+        }
+        Slots[Slot].CellIndex = CellIndex;
+        Slots[Slot].Generation = Generation;
+        Slots[Slot].Node = Node;
+    }
+
+    void FAStarNodePool::GrowSlots()
+    {
+        std::vector<FSlot> OldSlots(Slots.size() * 2);
+        OldSlots.swap(Slots);
+        SlotMask = (uint32_t)Slots.size() - 1;
+        SlotShift--;
+
+        // 新表的代数全为0，只需重新插入本次搜索的条目
+        for (const FSlot& Entry : OldSlots)
+        {
+            if (Entry.Generation == Generation)
+            {
+                Insert(Entry.CellIndex, Entry.Node);
+            }
+        }
+    }
+
+    FAStarNode* FAStarOpenHeap::Pop()
+    {
+        FAStarNode* Top = Heap[0];
+        Top->HeapIndex = -1;
+        FAStarNode* Last = Heap.back();
+        Heap.pop_back();
+        if (!Heap.empty())
+        {
+            Place(0, Last);
+            SiftDown(0);
+        }
+        return Top;
+    }
+
+    void FAStarOpenHeap::SiftUp(int32_t Index)
+    {
+        FAStarNode* Node = Heap[Index];
+        while (Index > 0)
+        {
+            const int32_t ParentIndex = (Index - 1) / 2;
+            if (!Less(Node, Heap[ParentIndex]))
+            {
+                break;
+            }
+            Place(Index, Heap[ParentIndex]);
+            Index = ParentIndex;
+        }
+        Place(Index, Node);
+    }
+
+    void FAStarOpenHeap::SiftDown(int32_t Index)
+    {
+        FAStarNode* Node = Heap[Index];
+        const int32_t Count = (int32_t)Heap.size();
+        while (true)
+        {
+            int32_t Child = Index * 2 + 1;
+            if (Child >= Count)
+            {
+                break;
+            }
+            if (Child + 1 < Count && Less(Heap[Child + 1], Heap[Child]))
+            {
+                Child++;
+            }
+            if (!Less(Heap[Child], Node))
+            {
+                break;
+            }
+            Place(Index, Heap[Child]);
+            Index = Child;
+        }
+        Place(Index, Node);
+    }
+}
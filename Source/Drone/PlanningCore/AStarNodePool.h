@@ -0,0 +1,148 @@
+// AStarNodePool.h
+// A*搜索节点的内存池与开放堆，由FAStarPlanner持有并在多次FindPath之间复用
+#pragma once
+
+#include "PlanningTypes.h"
+#include <cfloat>
+#include <memory>
+#include <vector>
+
+namespace DronePlanning
+{
+    struct FAStarNode
+    {
+        FVec3 Position;                   // World position
+        int32_t GridX = 0;                // Grid coordinates
+        int32_t GridY = 0;
+        int32_t GridZ = 0;
+        float GScore = FLT_MAX;           // Cost from start
+        float FScore = FLT_MAX;           // Total cost (GScore + Heuristic)
+        FAStarNode* Parent = nullptr;     // Parent node
+        int32_t HeapIndex = -1;           // 在开放堆中的位置，-1表示不在开放集中
+        bool bClosed = false;             // 是否已在关闭集中
+        bool bExpandAllDirections = false; // JPS：跳跃被预约冲突截断的跳点，扩展时不剪枝
+        bool bInconsistent = false;       // ARA*：关闭后G值又变小，等待下一轮重新打开
+    };
+
+    // 节点按块分配（地址稳定），并用开放寻址哈希表按线性网格索引查找。
+    // Reset只递增代数，不释放也不清零内存，代价为O(1)
+    class FAStarNodePool
+    {
+    public:
+        FAStarNodePool();
+
+        void Reset();
+
+        // 查找本次搜索中该格子已生成的节点（CellIndex为FOccupancyGrid::GetCellIndex），没有则返回nullptr
+        FAStarNode* Find(int64_t CellIndex) const
+        {
+            for (uint32_t Slot = Hash(CellIndex); ; Slot = (Slot + 1) & SlotMask)
+            {
+                const FSlot& Entry = Slots[Slot];
+                if (Entry.Generation != Generation)
+                {
+                    return nullptr;
+                }
+                if (Entry.CellIndex == CellIndex)
+                {
+                    return Entry.Node;
+                }
+            }
+        }
+
+        // 为格子分配新节点（调用前须确认Find返回nullptr）
+        FAStarNode* Add(int64_t CellIndex, const FVec3& Position, int32_t X, int32_t Y, int32_t Z);
+
+        int32_t Num() const { return NumNodes; }
+
+    private:
+        static constexpr int32_t BLOCK_SHIFT = 12;
+        static constexpr int32_t BLOCK_SIZE = 1 << BLOCK_SHIFT;
+
+        struct FSlot
+        {
+            int64_t CellIndex = 0;
+            uint32_t Generation = 0;
+            FAStarNode* Node = nullptr;
+        };
+
+        std::vector<std::unique_ptr<FAStarNode[]>> Blocks;
+        int32_t NumNodes = 0;
+
+        std::vector<FSlot> Slots;
+        uint32_t SlotMask = 0;
+        uint32_t SlotShift = 0;
+        uint32_t Generation = 1;
+
+        uint32_t Hash(int64_t CellIndex) const
+        {
+            return (uint32_t)(((uint64_t)CellIndex * 0x9E3779B97F4A7C15ull) >> SlotShift);
+        }
+
+        void Insert(int64_t CellIndex, FAStarNode* Node);
+        void GrowSlots();
+    };
+
+    // 带索引的二叉最小堆，节点记录自身在堆中的位置以支持O(log n)的decrease-key。
+    // F值相同时优先弹出G值更大（更靠近目标）的节点
+    class FAStarOpenHeap
+    {
+    public:
+        bool IsEmpty() const { return Heap.empty(); }
+
+        // 清空但保留容量
+        void Reset() { Heap.clear(); }
+
+        void Push(FAStarNode* Node)
+        {
+            Node->HeapIndex = (int32_t)Heap.size();
+            Heap.push_back(Node);
+            SiftUp(Node->HeapIndex);
+        }
+
+        // F值最小的节点（调用前须确认非空）
+        FAStarNode* Top() const { return Heap[0]; }
+
+        FAStarNode* Pop();
+
+        // 节点F值变小后恢复堆序
+        void DecreaseKey(FAStarNode* Node)
+        {
+            SiftUp(Node->HeapIndex);
+        }
+
+        // 对堆中每个节点调用UpdateKey(Node)重新计算F值，再整体重建堆，O(n)
+        template <typename FUpdateKey>
+        void Rebuild(FUpdateKey&& UpdateKey)
+        {
+            for (FAStarNode* Node : Heap)
+            {
+                UpdateKey(Node);
+            }
+            for (int32_t Index = (int32_t)Heap.size() / 2 - 1; Index >= 0; --Index)
+            {
+                SiftDown(Index);
+            }
+        }
+
+        // 遍历堆中的节点（无序）
+        const std::vector<FAStarNode*>& GetNodes() const { return Heap; }
+
+    private:
+        std::vector<FAStarNode*> Heap;
+
+        static bool Less(const FAStarNode* A, const FAStarNode* B)
+        {
+            return A->FScore < B->FScore || (A->FScore == B->FScore && A->GScore > B->GScore);
+        }
+
+        void Place(int32_t Index, FAStarNode* Node)
+        {
+            Heap[Index] = Node;
+            Node->HeapIndex = Index;
+        }
+
+        void SiftUp(int32_t Index);
+        void SiftDown(int32_t Index);
+    };
+}
@@ -0,0 +1,435 @@
+// AStarPlanner.cpp
+#include "AStarPlanner.h"
+#include "JumpPointSearch.h"
+#include "OccupancyGrid.h"
+#include "ReservationTable.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace DronePlanning
+{
+    const char* LexToString(EPlanStatus Status)
+    {
+        switch (Status)
+        {
+        case EPlanStatus::Success:          return "Success";
+        case EPlanStatus::StartOutsideGrid: return "Start position is outside the grid";
+        case EPlanStatus::GoalOutsideGrid:  return "Goal position is outside the grid";
+        case EPlanStatus::StartOccupied:    return "Start position is occupied";
+        case EPlanStatus::GoalOccupied:     return "Goal position is occupied";
+        case EPlanStatus::NoPath:           return "No path";
+        case EPlanStatus::StepLimit:        return "Exceeded max steps";
+        case EPlanStatus::TimeLimit:        return "Exceeded max search time";
+        case EPlanStatus::Cancelled:        return "Cancelled";
+        }
+        return "Unknown";
+    }
+
+    const char* LexToString(ESearchMode Mode)
+    {
+        switch (Mode)
+        {
+        case ESearchMode::AStar:     return "A*";
+        case ESearchMode::JumpPoint: return "JPS";
+        }
+        return "Unknown";
+    }
+
+    EPlanStatus FAStarPlanner::FindPath(const FOccupancyGrid& Grid, const FReservationTable* Reservations,
+        const FPlanRequest& Request, std::vector<FVec3>& OutPath)
+    {
+        OutPath.clear();
+        LastStats = FSearchStats();
+
+        int32_t StartX, StartY, StartZ;
+        int32_t GoalX, GoalY, GoalZ;
+        if (!Grid.WorldToGrid(Request.Start, StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOutsideGrid;
+        }
+        if (!Grid.WorldToGrid(Request.Goal, GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOutsideGrid;
+        }
+        if (Grid.IsOccupiedCell(StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOccupied;
+        }
+        if (Grid.IsOccupiedCell(GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOccupied;
+        }
+
+        const FIntVec3 StartCell(StartX, StartY, StartZ);
+        const FIntVec3 GoalCell(GoalX, GoalY, GoalZ);
+        const EGridConnectivity Connectivity = Config.SearchMode == ESearchMode::JumpPoint ? EGridConnectivity::Corner26 : Config.Connectivity;
+        switch (Connectivity)
+        {
+        case EGridConnectivity::Face6:
+            return Search<EGridConnectivity::Face6>(Grid, Reservations, Request, StartCell, GoalCell, OutPath);
+        case EGridConnectivity::Edge18:
+            return Search<EGridConnectivity::Edge18>(Grid, Reservations, Request, StartCell, GoalCell, OutPath);
+        case EGridConnectivity::Corner26:
+            break;
+        }
+        return Search<EGridConnectivity::Corner26>(Grid, Reservations, Request, StartCell, GoalCell, OutPath);
+    }
+
+    template <EGridConnectivity Connectivity>
+    EPlanStatus FAStarPlanner::Search(const FOccupancyGrid& Grid, const FReservationTable* Reservations, const FPlanRequest& Request,
+        const FIntVec3& StartCell, const FIntVec3& GoalCell, std::vector<FVec3>& OutPath)
+    {
+        using FNeighborhood = TGridNeighborhood<Connectivity>;
+        const float Resolution = Grid.GetResolution();
+        const int32_t GoalX = GoalCell.X;
+        const int32_t GoalY = GoalCell.Y;
+        const int32_t GoalZ = GoalCell.Z;
+        auto Heuristic = [&](int32_t X, int32_t Y, int32_t Z)
+        {
+            return FNeighborhood::GetHeuristic(GoalX - X, GoalY - Y, GoalZ - Z) * Resolution;
+        };
+
+        float StepCosts[FNeighborhood::NumDirections];
+        for (int32_t Direction = 0; Direction < FNeighborhood::NumDirections; ++Direction)
+        {
+            StepCosts[Direction] = GridDirections[Direction].Length * Resolution;
+        }
+        const FGridIndexOffsets IndexOffsets(Grid);
+
+        // 复用上次搜索的节点池与开放堆，O(1)重置
+        NodePool.Reset();
+        OpenSet.Reset();
+        ClosedNodes.clear();
+        InconsistentNodes.clear();
+
+        const bool bJumpPoint = Connectivity == EGridConnectivity::Corner26 && Config.SearchMode == ESearchMode::JumpPoint;
+        const bool bAnytime = !bJumpPoint && Config.AnytimeInitialWeight > 1.0f;
+        float Weight = bAnytime ? Config.AnytimeInitialWeight : 1.0f;
+
+        FAStarNode* StartNode = NodePool.Add(Grid.GetCellIndex(StartCell.X, StartCell.Y, StartCell.Z), Request.Start, StartCell.X, StartCell.Y, StartCell.Z);
+        StartNode->GScore = 0;
+        StartNode->FScore = Weight * Heuristic(StartCell.X, StartCell.Y, StartCell.Z);
+        OpenSet.Push(StartNode);
+
+        // ARA*：目标区域（目标格子及与其共面的相邻格子）内到目标格子代价最小的节点。
+        // 节点生成或G值变小时更新，每轮搜索在开放集最小F值不小于该代价时结束
+        FAStarNode* BestGoal = nullptr;
+        float BestGoalCost = FLT_MAX;
+        auto UpdateBestGoal = [&](FAStarNode* Node)
+        {
+            const int32_t GoalDX = Node->GridX - GoalX;
+            const int32_t GoalDY = Node->GridY - GoalY;
+            const int32_t GoalDZ = Node->GridZ - GoalZ;
+            const int32_t SquaredDistanceToGoal = GoalDX * GoalDX + GoalDY * GoalDY + GoalDZ * GoalDZ;
+            if (SquaredDistanceToGoal <= 1)
+            {
+                const float Cost = Node->GScore + (SquaredDistanceToGoal > 0 ? Resolution : 0.0f);
+                if (Cost < BestGoalCost)
+                {
+                    BestGoalCost = Cost;
+                    BestGoal = Node;
+                }
+            }
+        };
+        if (bAnytime)
+        {
+            UpdateBestGoal(StartNode);
+        }
+
+        FSearchDeadline Deadline(Config.MaxSearchMicros);
+        int32_t Steps = 0;
+        EPlanStatus Status = EPlanStatus::NoPath;
+        FAStarNode* GoalNode = nullptr;
+        FJumpSuccessor JumpSuccessors[26];
+        FJumpPointSearch JumpPointSearch(Grid, Reservations, Request, Config.DroneSpeed, GoalCell);
+        while (true)
+        {
+            while (!OpenSet.IsEmpty())
+            {
+                // ARA*本轮结束：已找到的路径代价在当前权重的Weight倍以内
+                if (bAnytime && OpenSet.Top()->FScore >= BestGoalCost)
+                {
+                    break;
+                }
+
+                if (Config.CancelFlag && Config.CancelFlag->load(std::memory_order_relaxed))
+                {
+                    return EPlanStatus::Cancelled;
+                }
+
+                if (Deadline.IsExpired())
+                {
+                    Status = EPlanStatus::TimeLimit;
+                    break;
+                }
+
+                // 检查步数限制
+                if (++Steps > Config.MaxSearchSteps)
+                {
+                    Status = EPlanStatus::StepLimit;
+                    break;
+                }
+
+                // 获取F值最小的节点
+                FAStarNode* Current = OpenSet.Pop();
+                LastStats.Expansions++;
+
+                // 检查是否到达目标（允许1个网格单位的误差，即目标格子或与其共面的相邻格子）
+                if (!bAnytime)
+                {
+                    const int32_t GoalDX = Current->GridX - GoalX;
+                    const int32_t GoalDY = Current->GridY - GoalY;
+                    const int32_t GoalDZ = Current->GridZ - GoalZ;
+                    if (GoalDX * GoalDX + GoalDY * GoalDY + GoalDZ * GoalDZ <= 1)
+                    {
+                        GoalNode = Current;
+                        break;
+                    }
+                }
+
+                Current->bClosed = true;
+                if (bAnytime)
+                {
+                    ClosedNodes.push_back(Current);
+                }
+
+                if (bJumpPoint)
+                {
+                    const int32_t NumSuccessors = JumpPointSearch.GetSuccessors(*Current, JumpSuccessors);
+                    LastStats.GeneratedNodes += NumSuccessors;
+
+                    // 沿途格子的预约冲突已在跳跃时检查
+                    for (int32_t i = 0; i < NumSuccessors; i++)
+                    {
+                        const FJumpSuccessor& Successor = JumpSuccessors[i];
+                        const FIntVec3& Cell = Successor.Cell;
+                        const int64_t CellIndex = Grid.GetCellIndex(Cell.X, Cell.Y, Cell.Z);
+                        FAStarNode* Existing = NodePool.Find(CellIndex);
+                        if (Existing && Existing->bClosed)
+                        {
+                            continue;
+                        }
+
+                        const float TentativeGScore = Current->GScore + Successor.Cost;
+                        FAStarNode* Neighbor = Existing;
+                        if (!Neighbor)
+                        {
+                            Neighbor = NodePool.Add(CellIndex, Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z), Cell.X, Cell.Y, Cell.Z);
+                        }
+                        else if (TentativeGScore >= Neighbor->GScore)
+                        {
+                            continue;
+                        }
+                        Neighbor->GScore = TentativeGScore;
+                        Neighbor->FScore = TentativeGScore + Heuristic(Cell.X, Cell.Y, Cell.Z);
+                        Neighbor->Parent = Current;
+                        Neighbor->bExpandAllDirections = Successor.bExpandAllDirections;
+                        if (Existing)
+                        {
+                            OpenSet.DecreaseKey(Neighbor);
+                        }
+                        else
+                        {
+                            OpenSet.Push(Neighbor);
+                        }
+                    }
+                    continue;
+                }
+
+                const int64_t CurrentIndex = Grid.GetCellIndex(Current->GridX, Current->GridY, Current->GridZ);
+                for (int32_t Direction = 0; Direction < FNeighborhood::NumDirections; ++Direction)
+                {
+                    const FGridDirection& Step = GridDirections[Direction];
+                    const int32_t X = Current->GridX + Step.X;
+                    const int32_t Y = Current->GridY + Step.Y;
+                    const int32_t Z = Current->GridZ + Step.Z;
+                    if (!Grid.IsValidCell(X, Y, Z))
+                    {
+                        continue;
+                    }
+                    const int64_t CellIndex = CurrentIndex + IndexOffsets.Offsets[Direction];
+                    if (Grid.IsOccupiedIndex(CellIndex))
+                    {
+                        continue;
+                    }
+                    LastStats.GeneratedNodes++;
+
+                    // 检查是否在关闭集中（ARA*的启发式被放大后不再一致，已关闭的节点仍可能被改进）
+                    FAStarNode* Existing = NodePool.Find(CellIndex);
+                    if (Existing && Existing->bClosed && !bAnytime)
+                    {
+                        continue;
+                    }
+
+                    // 起点不一定在格子中心，第一步按实际距离；其余节点都在格子中心，步长查表
+                    const FVec3 NeighborPosition = Existing ? Existing->Position : Grid.GridToWorld(X, Y, Z);
+                    const float SegmentDistance = Current == StartNode ? (float)FVec3::Dist(Current->Position, NeighborPosition) : StepCosts[Direction];
+                    const float TentativeGScore = Current->GScore + SegmentDistance;
+                    if (Existing && TentativeGScore >= Existing->GScore)
+                    {
+                        continue;
+                    }
+                    // ARA*：只是浮点累加误差造成的微小改进不重新打开已关闭的节点，否则这些节点会使代价下界变得过松
+                    if (Existing && Existing->bClosed && TentativeGScore > Existing->GScore * (1.0f - 1e-5f))
+                    {
+                        continue;
+                    }
+
+                    // 时空冲突检测：从当前节点飞到邻居的这一段与其他无人机的预约线段求最近距离
+                    const float DepartTime = Request.StartTime + Current->GScore / Config.DroneSpeed;
+                    const float AbsTime = DepartTime + SegmentDistance / Config.DroneSpeed;
+                    if (Reservations && Reservations->IsSegmentConflict(Current->Position, DepartTime, NeighborPosition, AbsTime, Request.DroneID))
+                    {
+                        continue;
+                    }
+
+                    FAStarNode* Neighbor = Existing;
+                    if (!Existing)
+                    {
+                        Neighbor = NodePool.Add(CellIndex, NeighborPosition, X, Y, Z);
+                        Neighbor->GScore = TentativeGScore;
+                        Neighbor->FScore = TentativeGScore + Weight * Heuristic(X, Y, Z);
+                        Neighbor->Parent = Current;
+                        OpenSet.Push(Neighbor);
+                    }
+                    else
+                    {
+                        Existing->GScore = TentativeGScore;
+                        Existing->FScore = TentativeGScore + Weight * Heuristic(X, Y, Z);
+                        Existing->Parent = Current;
+                        if (Existing->HeapIndex >= 0)
+                        {
+                            OpenSet.DecreaseKey(Existing);
+                        }
+                        else if (!Existing->bClosed)
+                        {
+                            // ARA*前几轮已扩展过的节点
+                            OpenSet.Push(Existing);
+                        }
+                        else if (!Existing->bInconsistent)
+                        {
+                            // 本轮不再扩展，留到下一轮重新打开
+                            Existing->bInconsistent = true;
+                            InconsistentNodes.push_back(Existing);
+                        }
+                    }
+                    if (bAnytime)
+                    {
+                        UpdateBestGoal(Neighbor);
+                    }
+                }
+            }
+
+            // 普通A*只有一轮；ARA*在预算用完、无解或权重已降到1时结束
+            if (!bAnytime || Status != EPlanStatus::NoPath || !BestGoal || Weight <= 1.0f)
+            {
+                break;
+            }
+
+            // 减小权重，重新打开上一轮关闭后又被改进的节点，并按新权重重建开放堆。
+            // 有预约表时，关闭后G值变小会使其后继的实际到达时间早于冲突检测时使用的时间
+            Weight = Config.AnytimeWeightStep > 0.0f ? std::max(1.0f, Weight - Config.AnytimeWeightStep) : 1.0f;
+            for (FAStarNode* Node : ClosedNodes)
+            {
+                Node->bClosed = false;
+            }
+            for (FAStarNode* Node : InconsistentNodes)
+            {
+                Node->bInconsistent = false;
+                OpenSet.Push(Node);
+            }
+            ClosedNodes.clear();
+            InconsistentNodes.clear();
+            OpenSet.Rebuild([&](FAStarNode* Node)
+            {
+                Node->FScore = Node->GScore + Weight * Heuristic(Node->GridX, Node->GridY, Node->GridZ);
+            });
+        }
+
+        if (bAnytime)
+        {
+            if (!BestGoal)
+            {
+                return Status;
+            }
+
+            // 最优代价不小于开放集与待重新打开节点中 G + h 的最小值
+            float LowerBound = FLT_MAX;
+            auto AccumulateLowerBound = [&](const FAStarNode* Node)
+            {
+                LowerBound = std::min(LowerBound, Node->GScore + Heuristic(Node->GridX, Node->GridY, Node->GridZ));
+            };
+            for (const FAStarNode* Node : OpenSet.GetNodes())
+            {
+                AccumulateLowerBound(Node);
+            }
+            for (const FAStarNode* Node : InconsistentNodes)
+            {
+                AccumulateLowerBound(Node);
+            }
+            GoalNode = BestGoal;
+            LastStats.PathCost = BestGoalCost;
+            LastStats.SuboptimalityBound = LowerBound > 0.0f && LowerBound < BestGoalCost ? BestGoalCost / LowerBound : 1.0f;
+        }
+        else
+        {
+            if (!GoalNode)
+            {
+                return Status;
+            }
+            LastStats.PathCost = GoalNode->FScore;
+        }
+
+        // 如果非常接近目标，直接使用目标点作为终点（网格坐标保留，用于补齐跳点间的格子）
+        if (GoalNode->GridX != GoalX || GoalNode->GridY != GoalY || GoalNode->GridZ != GoalZ)
+        {
+            GoalNode->Position = Grid.GridToWorld(GoalX, GoalY, GoalZ);
+        }
+        ReconstructPath(Grid, GoalNode, OutPath);
+        return EPlanStatus::Success;
+    }
+
+    void FAStarPlanner::ReconstructPath(const FOccupancyGrid& Grid, const FAStarNode* GoalNode, std::vector<FVec3>& OutPath)
+    {
+        OutPath.clear();
+        for (const FAStarNode* Current = GoalNode; Current; Current = Current->Parent)
+        {
+            OutPath.push_back(Current->Position);
+            if (!Current->Parent)
+            {
+                break;
+            }
+
+            // 跳点与父节点在同一条直线/对角线上，逐格补齐（A*的相邻节点之间没有中间格子）
+            const int32_t DX = Current->GridX - Current->Parent->GridX;
+            const int32_t DY = Current->GridY - Current->Parent->GridY;
+            const int32_t DZ = Current->GridZ - Current->Parent->GridZ;
+            const int32_t NumSteps = std::max({ std::abs(DX), std::abs(DY), std::abs(DZ) });
+            for (int32_t Step = NumSteps - 1; Step > 0; --Step)
+            {
+                OutPath.push_back(Grid.GridToWorld(Current->Parent->GridX + DX / NumSteps * Step,
+                    Current->Parent->GridY + DY / NumSteps * Step, Current->Parent->GridZ + DZ / NumSteps * Step));
+            }
+        }
+        std::reverse(OutPath.begin(), OutPath.end());
+    }
+
+    float FAStarPlanner::GetDiagonalHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2)
+    {
+        return TGridNeighborhood<EGridConnectivity::Corner26>::GetHeuristic(X2 - X1, Y2 - Y1, Z2 - Z1) * Resolution;
+    }
+
+    float FAStarPlanner::GetManhattanHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2)
+    {
+        return (float)(std::abs(X2 - X1) + std::abs(Y2 - Y1) + std::abs(Z2 - Z1)) * Resolution;
+    }
+
+    float FAStarPlanner::GetEuclideanHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2)
+    {
+        const float DX = (float)(X2 - X1);
+        const float DY = (float)(Y2 - Y1);
+        const float DZ = (float)(Z2 - Z1);
+        return std::sqrt(DX * DX + DY * DY + DZ * DZ) * Resolution;
+    }
+}
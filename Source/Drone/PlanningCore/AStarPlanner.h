@@ -0,0 +1,162 @@
+// AStarPlanner.h
+#pragma once
+
+#include "AStarNodePool.h"
+#include "GridNeighborhood.h"
+#include "PlanningTypes.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+    class FReservationTable;
+
+    enum class EPlanStatus : uint8_t
+    {
+        Success,
+        StartOutsideGrid,
+        GoalOutsideGrid,
+        StartOccupied,
+        GoalOccupied,
+        NoPath,
+        StepLimit,
+        TimeLimit,
+        Cancelled,
+    };
+
+    const char* LexToString(EPlanStatus Status);
+
+    enum class ESearchMode : uint8_t
+    {
+        // 逐格扩展全部26个邻居
+        AStar,
+
+        // 跳点搜索：沿直线/对角线跳过无强迫邻居的格子，只把跳点放入开放堆；
+        // 无预约冲突时路径代价与AStar相同
+        JumpPoint,
+    };
+
+    const char* LexToString(ESearchMode Mode);
+
+    struct FPlannerConfig
+    {
+        // 无人机速度（厘米/秒），用于估算到达时间
+        float DroneSpeed = 100.0f;
+
+        ESearchMode SearchMode = ESearchMode::AStar;
+
+        // 逐格搜索的邻域；JumpPoint模式固定为26邻域
+        EGridConnectivity Connectivity = EGridConnectivity::Corner26;
+
+        // 最大搜索步数（JumpPoint模式下为跳点扩展次数）
+        int32_t MaxSearchSteps = 100000;
+
+        // 每次搜索的时间预算（微秒），<=0表示不限时。按单调时钟计实际耗时，
+        // 游戏线程上的同步搜索同样有效（游戏时间在搜索期间不会前进）
+        int64_t MaxSearchMicros = 1000000;
+
+        // 任意时间（anytime）模式的初始启发式权重，>1时启用ARA*：先用放大的启发式快速找到路径，
+        // 之后每轮减小AnytimeWeightStep并复用已有搜索继续改进，直到权重为1（最优）或预算用完，
+        // 返回预算内找到的最好路径。JumpPoint模式不使用
+        float AnytimeInitialWeight = 1.0f;
+        float AnytimeWeightStep = 0.5f;
+
+        // 置为true时搜索尽快返回Cancelled（后台线程规划被取代时使用）
+        const std::atomic<bool>* CancelFlag = nullptr;
+    };
+
+    struct FPlanRequest
+    {
+        FVec3 Start;
+        FVec3 Goal;
+        int32_t DroneID = -1;
+
+        // 路径起点对应的绝对时间，用于时空冲突检测
+        float StartTime = 0.0f;
+    };
+
+    struct FSearchStats
+    {
+        int32_t Expansions = 0;
+        int32_t GeneratedNodes = 0;
+
+        // 成功时到目标格子的路径代价（世界单位）：终点节点的F值，
+        // 到达目标相邻格子时包含其到目标格子的一步
+        float PathCost = 0.0f;
+
+        // 路径代价不超过最优代价的倍数：完整的A*搜索为1，ARA*在预算用完时可能大于1
+        float SuboptimalityBound = 1.0f;
+    };
+
+    // 一次搜索的截止时间（单调时钟）。IsExpired每CHECK_INTERVAL次调用才读取一次时钟
+    class FSearchDeadline
+    {
+    public:
+        explicit FSearchDeadline(int64_t InBudgetMicros)
+            : Begin(FClock::now())
+            , BudgetMicros(InBudgetMicros)
+        {
+        }
+
+        bool IsExpired()
+        {
+            if (BudgetMicros <= 0 || (++NumCalls & (CHECK_INTERVAL - 1)) != 0)
+            {
+                return false;
+            }
+            return GetElapsedMicros() > BudgetMicros;
+        }
+
+        int64_t GetElapsedMicros() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(FClock::now() - Begin).count();
+        }
+
+    private:
+        using FClock = std::chrono::steady_clock;
+        static constexpr uint32_t CHECK_INTERVAL = 16;
+
+        FClock::time_point Begin;
+        int64_t BudgetMicros;
+        uint32_t NumCalls = 0;
+    };
+
+    // 三维A*（默认26邻域，可选6/18邻域或跳点搜索），带时空预约表冲突检测
+    class FAStarPlanner
+    {
+    public:
+        FPlannerConfig Config;
+
+        // 搜索原始网格路径（未平滑，两种模式都输出逐格的路径点）。Reservations可为空
+        EPlanStatus FindPath(const FOccupancyGrid& Grid, const FReservationTable* Reservations,
+            const FPlanRequest& Request, std::vector<FVec3>& OutPath);
+
+        const FSearchStats& GetLastStats() const { return LastStats; }
+
+        // 启发式函数（返回世界单位）。Diagonal为26邻域的八分距离（octile），与TGridNeighborhood<Corner26>相同
+        static float GetDiagonalHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2);
+        static float GetManhattanHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2);
+        static float GetEuclideanHeuristic(float Resolution, int32_t X1, int32_t Y1, int32_t Z1, int32_t X2, int32_t Y2, int32_t Z2);
+
+    private:
+        FSearchStats LastStats;
+
+        // 跨FindPath调用复用，避免每个邻居一次new/delete
+        FAStarNodePool NodePool;
+        FAStarOpenHeap OpenSet;
+
+        // 按邻域在编译期展开的搜索主循环（方向、步长与启发式均为常量表）
+        template <EGridConnectivity Connectivity>
+        EPlanStatus Search(const FOccupancyGrid& Grid, const FReservationTable* Reservations, const FPlanRequest& Request,
+            const FIntVec3& StartCell, const FIntVec3& GoalCell, std::vector<FVec3>& OutPath);
+
+        // ARA*每轮结束后暂存的节点：本轮关闭的节点，以及关闭后G值又变小的节点
+        std::vector<FAStarNode*> ClosedNodes;
+        std::vector<FAStarNode*> InconsistentNodes;
+
+        // 跳点之间补齐中间格子
+        static void ReconstructPath(const FOccupancyGrid& Grid, const FAStarNode* GoalNode, std::vector<FVec3>& OutPath);
+    };
+}
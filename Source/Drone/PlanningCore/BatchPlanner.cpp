@@ -0,0 +1,241 @@
+// BatchPlanner.cpp
+#include "BatchPlanner.h"
+#include "OccupancyGrid.h"
+#include "PathSmoother.h"
+#include "ReservationTable.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        // 时空包围盒
+        struct FCorridorBox
+        {
+            FVec3 Min;
+            FVec3 Max;
+            double BeginTime = 0.0;
+            double EndTime = 0.0;
+
+            bool Intersects(const FCorridorBox& Other) const
+            {
+                return Min.X <= Other.Max.X && Max.X >= Other.Min.X
+                    && Min.Y <= Other.Max.Y && Max.Y >= Other.Min.Y
+                    && Min.Z <= Other.Max.Z && Max.Z >= Other.Min.Z
+                    && BeginTime <= Other.EndTime && EndTime >= Other.BeginTime;
+            }
+
+            void Expand(const FCorridorBox& Other)
+            {
+                Min = FVec3(std::min(Min.X, Other.Min.X), std::min(Min.Y, Other.Min.Y), std::min(Min.Z, Other.Min.Z));
+                Max = FVec3(std::max(Max.X, Other.Max.X), std::max(Max.Y, Other.Max.Y), std::max(Max.Z, Other.Max.Z));
+                BeginTime = std::min(BeginTime, Other.BeginTime);
+                EndTime = std::max(EndTime, Other.EndTime);
+            }
+        };
+
+        // 起终点连线按长度切成若干段，每段一个时空盒：只在飞到该段附近的那段时间内占用该段周围的空间，
+        // 不同时经过同一区域的两架无人机互不相交。Bounds为所有段的并，用于快速排除
+        struct FPlanCorridor
+        {
+            FCorridorBox Bounds;
+            std::vector<FCorridorBox> Pieces;
+
+            bool Intersects(const FPlanCorridor& Other) const
+            {
+                if (!Bounds.Intersects(Other.Bounds))
+                {
+                    return false;
+                }
+                for (const FCorridorBox& Piece : Pieces)
+                {
+                    if (!Piece.Intersects(Other.Bounds))
+                    {
+                        continue;
+                    }
+                    for (const FCorridorBox& OtherPiece : Other.Pieces)
+                    {
+                        if (Piece.Intersects(OtherPiece))
+                        {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+        };
+
+        FPlanCorridor MakeCorridor(const FBatchQuery& Query, float ConflictRadius, float SegmentLength, float Margin, float TimeSlack)
+        {
+            const FVec3& Start = Query.Request.Start;
+            const FVec3& Goal = Query.Request.Goal;
+            const double Distance = FVec3::Dist(Start, Goal);
+            const double Speed = std::max(Query.DroneSpeed, 1.0f);
+            const int32_t NumPieces = SegmentLength > 0.0f ? std::max(1, (int32_t)std::ceil(Distance / SegmentLength)) : 1;
+
+            FPlanCorridor Corridor;
+            Corridor.Pieces.reserve(NumPieces);
+            for (int32_t i = 0; i < NumPieces; ++i)
+            {
+                // 到达段内任一点不早于按直线飞行的时刻；绕行使离开时刻最多推迟到 直线时刻 * TimeSlack
+                const double Begin = Distance * i / NumPieces;
+                const double End = Distance * (i + 1) / NumPieces;
+                const FVec3 From = Start + (Goal - Start) * (Begin / std::max(Distance, 1.e-6));
+                const FVec3 To = Start + (Goal - Start) * (End / std::max(Distance, 1.e-6));
+                const double Expand = ConflictRadius + (End - Begin) * Margin;
+
+                FCorridorBox Piece;
+                Piece.Min = FVec3(std::min(From.X, To.X) - Expand, std::min(From.Y, To.Y) - Expand, std::min(From.Z, To.Z) - Expand);
+                Piece.Max = FVec3(std::max(From.X, To.X) + Expand, std::max(From.Y, To.Y) + Expand, std::max(From.Z, To.Z) + Expand);
+                Piece.BeginTime = Query.Request.StartTime + Begin / Speed;
+                Piece.EndTime = Query.Request.StartTime + End / Speed * TimeSlack + 1.0;
+                if (i == 0)
+                {
+                    Corridor.Bounds = Piece;
+                }
+                Corridor.Bounds.Expand(Piece);
+                Corridor.Pieces.push_back(Piece);
+            }
+            return Corridor;
+        }
+
+        // 路径是否与表中其他无人机的预约冲突（逐段检查，与A*搜索时一致）
+        bool HasReservationConflict(const FReservationTable& Reservations, const FBatchQuery& Query, const std::vector<FVec3>& Path)
+        {
+            return Reservations.IsPathConflict(
+                FReservationTable::BuildSamples(Path, Query.DroneSpeed, Query.Request.StartTime), Query.Request.DroneID);
+        }
+    }
+
+    FBatchStats FBatchPlanner::PlanBatch(const FOccupancyGrid& Grid, FReservationTable& Reservations,
+        const std::vector<FBatchQuery>& Queries, std::vector<FBatchResult>& OutResults)
+    {
+        using FClock = std::chrono::steady_clock;
+        const FClock::time_point BatchBegin = FClock::now();
+
+        FBatchStats Stats;
+        const int32_t NumQueries = (int32_t)Queries.size();
+        OutResults.assign(Queries.size(), FBatchResult());
+
+        // 分批：与更高优先级无人机的走廊相交时，必须排在它之后的批次
+        std::vector<FPlanCorridor> Corridors;
+        Corridors.reserve(Queries.size());
+        for (const FBatchQuery& Query : Queries)
+        {
+            Corridors.push_back(MakeCorridor(Query, Reservations.GetConflictRadius(), CorridorSegmentLength, CorridorMargin, CorridorTimeSlack));
+        }
+        for (int32_t i = 0; i < NumQueries; ++i)
+        {
+            int32_t Wave = 0;
+            for (int32_t j = 0; j < i; ++j)
+            {
+                if (OutResults[j].Wave >= Wave && Corridors[i].Intersects(Corridors[j]))
+                {
+                    Wave = OutResults[j].Wave + 1;
+                }
+            }
+            OutResults[i].Wave = Wave;
+            Stats.NumWaves = std::max(Stats.NumWaves, Wave + 1);
+        }
+
+        std::vector<std::vector<int32_t>> Waves(Stats.NumWaves);
+        for (int32_t i = 0; i < NumQueries; ++i)
+        {
+            Waves[OutResults[i].Wave].push_back(i);
+        }
+
+        std::vector<std::vector<FVec3>> RawPaths(Queries.size());
+        for (const std::vector<int32_t>& WaveQueries : Waves)
+        {
+            if (Planners.size() < WaveQueries.size())
+            {
+                Planners.resize(WaveQueries.size());
+            }
+
+            // 同一批次只读预约表，互不可见
+            auto PlanWaveMember = [&](int32_t Member)
+            {
+                const int32_t QueryIndex = WaveQueries[Member];
+                FBatchResult& Result = OutResults[QueryIndex];
+                PlanOne(Planners[Member], Grid, Reservations, Queries[QueryIndex], Result);
+                RawPaths[QueryIndex] = Result.Path;
+                if (Result.Status == EPlanStatus::Success && Queries[QueryIndex].SafetyDistance > 0.0f)
+                {
+                    FPathSmoother(Grid, Queries[QueryIndex].SafetyDistance, DistanceField).SmoothPath(Result.Path);
+                }
+            };
+            if (ParallelFor && WaveQueries.size() > 1)
+            {
+                ParallelFor((int32_t)WaveQueries.size(), PlanWaveMember);
+            }
+            else
+            {
+                for (int32_t Member = 0; Member < (int32_t)WaveQueries.size(); ++Member)
+                {
+                    PlanWaveMember(Member);
+                }
+            }
+
+            // 按优先级提交，检查的是实际写入预约表的路径：平滑后的路径冲突时退回原始路径；
+            // 原始路径也冲突（走廊估计失准，与同批次已提交路径相撞）的，改为顺序重规划
+            for (int32_t QueryIndex : WaveQueries)
+            {
+                const FBatchQuery& Query = Queries[QueryIndex];
+                FBatchResult& Result = OutResults[QueryIndex];
+                const bool bSmoothed = Result.Status == EPlanStatus::Success && Query.SafetyDistance > 0.0f;
+                if (bSmoothed && HasReservationConflict(Reservations, Query, Result.Path))
+                {
+                    Result.Path = std::move(RawPaths[QueryIndex]);
+                    Stats.NumUnsmoothed++;
+                }
+                if (Result.Status == EPlanStatus::Success && (WaveQueries.size() > 1 || bSmoothed)
+                    && HasReservationConflict(Reservations, Query, Result.Path))
+                {
+                    const int32_t PreviousExpansions = Result.Expansions;
+                    PlanOne(Planners[0], Grid, Reservations, Query, Result);
+                    Result.Expansions += PreviousExpansions;
+                    Result.bReplanned = true;
+                    Stats.NumReplanned++;
+                    if (Result.Status == EPlanStatus::Success && Query.SafetyDistance > 0.0f)
+                    {
+                        std::vector<FVec3> SmoothedPath = Result.Path;
+                        FPathSmoother(Grid, Query.SafetyDistance, DistanceField).SmoothPath(SmoothedPath);
+                        if (!HasReservationConflict(Reservations, Query, SmoothedPath))
+                        {
+                            Result.Path = std::move(SmoothedPath);
+                        }
+                        else
+                        {
+                            Stats.NumUnsmoothed++;
+                        }
+                    }
+                }
+
+                Stats.Expansions += Result.Expansions;
+                if (Result.Status == EPlanStatus::Success)
+                {
+                    Stats.NumSucceeded++;
+                    Reservations.Reserve(Query.Request.DroneID,
+                        FReservationTable::BuildSamples(Result.Path, Query.DroneSpeed, Query.Request.StartTime));
+                }
+            }
+        }
+
+        Stats.WallSeconds = std::chrono::duration<double>(FClock::now() - BatchBegin).count();
+        return Stats;
+    }
+
+    void FBatchPlanner::PlanOne(FAStarPlanner& Planner, const FOccupancyGrid& Grid, const FReservationTable& Reservations,
+        const FBatchQuery& Query, FBatchResult& OutResult) const
+    {
+        Planner.Config = Config;
+        Planner.Config.DroneSpeed = Query.DroneSpeed;
+        Planner.Config.SearchMode = Query.SearchMode;
+        Planner.Config.MaxSearchMicros = Query.MaxSearchMicros;
+        Planner.Config.AnytimeInitialWeight = Query.AnytimeInitialWeight;
+        OutResult.Status = Planner.FindPath(Grid, &Reservations, Query.Request, OutResult.Path);
+        OutResult.Expansions = Planner.GetLastStats().Expansions;
+    }
+}
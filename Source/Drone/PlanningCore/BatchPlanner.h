@@ -0,0 +1,90 @@
+// BatchPlanner.h
+// 群体批量规划：按优先级顺序为每架无人机规划一次，时空走廊互不相交的无人机并行规划
+#pragma once
+
+#include "AStarPlanner.h"
+#include "PlanningTypes.h"
+#include <functional>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FDistanceField;
+    class FOccupancyGrid;
+    class FReservationTable;
+
+    struct FBatchQuery
+    {
+        FPlanRequest Request;
+
+        // 每架无人机自己的速度与平滑安全距离（SafetyDistance<=0时不平滑）
+        float DroneSpeed = 100.0f;
+        float SafetyDistance = 0.0f;
+
+        ESearchMode SearchMode = ESearchMode::AStar;
+
+        // 每架无人机自己的单次搜索预算（微秒，<=0不限时）与任意时间搜索的初始权重，含义同FPlannerConfig
+        int64_t MaxSearchMicros = 1000000;
+        float AnytimeInitialWeight = 1.0f;
+    };
+
+    struct FBatchResult
+    {
+        EPlanStatus Status = EPlanStatus::NoPath;
+        std::vector<FVec3> Path;
+
+        // 所在批次（同一批次内并行规划）
+        int32_t Wave = 0;
+
+        // 并行结果与同批次更高优先级的路径冲突，已按顺序重新规划
+        bool bReplanned = false;
+        int32_t Expansions = 0;
+    };
+
+    struct FBatchStats
+    {
+        double WallSeconds = 0.0;
+        int32_t NumWaves = 0;
+        int32_t NumReplanned = 0;
+
+        // 平滑后的路径与已提交的预约冲突、因而保留原始A*路径的无人机数
+        int32_t NumUnsmoothed = 0;
+        int32_t NumSucceeded = 0;
+        int64_t Expansions = 0;
+    };
+
+    // Body(i)对i in [0, Count)各调用一次，可在多个线程上同时执行
+    using FParallelFor = std::function<void(int32_t Count, const std::function<void(int32_t)>& Body)>;
+
+    class FBatchPlanner
+    {
+    public:
+        // 步数/时钟等对每次搜索生效；DroneSpeed、SearchMode、MaxSearchMicros与AnytimeInitialWeight取自各自的FBatchQuery
+        FPlannerConfig Config;
+
+        // 走廊 = 起终点连线按CorridorSegmentLength（厘米，<=0时不切分）切成的若干段，
+        // 每段的包围盒向外扩展 冲突半径 + 段长 * CorridorMargin
+        float CorridorSegmentLength = 500.0f;
+        float CorridorMargin = 0.25f;
+
+        // 每段的时间区间 = [StartTime + 段起点距离 / 速度, StartTime + 段终点距离 / 速度 * CorridorTimeSlack + 1]
+        float CorridorTimeSlack = 2.0f;
+
+        // 为空时串行执行
+        FParallelFor ParallelFor;
+
+        // 与PlanBatch的Grid同步的距离场（可为空），用于加速路径平滑的安全检查
+        const FDistanceField* DistanceField = nullptr;
+
+        // Queries按优先级从高到低排列。结果按优先级顺序写入Reservations，
+        // 与逐个调用FAStarPlanner + Reserve的优先级规划语义一致
+        FBatchStats PlanBatch(const FOccupancyGrid& Grid, FReservationTable& Reservations,
+            const std::vector<FBatchQuery>& Queries, std::vector<FBatchResult>& OutResults);
+
+    private:
+        std::vector<FAStarPlanner> Planners;
+
+        void PlanOne(FAStarPlanner& Planner, const FOccupancyGrid& Grid, const FReservationTable& Reservations,
+            const FBatchQuery& Query, FBatchResult& OutResult) const;
+    };
+}
@@ -0,0 +1,324 @@
+// ConflictBasedPlanner.cpp
+#include "ConflictBasedPlanner.h"
+#include "OccupancyGrid.h"
+#include "PathSmoother.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <limits>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        // 底层搜索时约束线段在工作预约表中的占位ID（依次递增），不与任何无人机ID相同
+        constexpr int32_t CONSTRAINT_DRONE_ID = INT32_MIN;
+    }
+
+    FConflictSearchStats FConflictBasedPlanner::PlanGroup(const FOccupancyGrid& Grid, FReservationTable& Reservations,
+        const std::vector<FBatchQuery>& Queries, std::vector<FBatchResult>& OutResults)
+    {
+        using FClock = std::chrono::steady_clock;
+        const FClock::time_point SolveBegin = FClock::now();
+        const FSearchDeadline Deadline(MaxSolveMicros);
+
+        FConflictSearchStats Stats;
+        const int32_t NumAgents = (int32_t)Queries.size();
+        OutResults.assign(Queries.size(), FBatchResult());
+        PathStore.clear();
+        Nodes.clear();
+        AgentExpansions.assign(Queries.size(), 0);
+
+        auto IsOutOfBudget = [&]()
+        {
+            return MaxSolveMicros > 0 && Deadline.GetElapsedMicros() > MaxSolveMicros;
+        };
+        auto GetRemainingMicros = [&]() -> int64_t
+        {
+            return MaxSolveMicros > 0 ? std::max<int64_t>(1, MaxSolveMicros - Deadline.GetElapsedMicros()) : 0;
+        };
+
+        // 本组无人机的旧预约不再有效，其余预约视为静态障碍
+        FReservationTable Working = Reservations;
+        for (const FBatchQuery& Query : Queries)
+        {
+            Working.Remove(Query.Request.DroneID);
+        }
+        const float ConflictRadius = Reservations.GetConflictRadius();
+        const float TimeWindow = Reservations.GetTimeWindow();
+
+        // 根节点：各自单独规划。无约束时也找不到路径的无人机不参与联合规划（PathIndices为-1）
+        FConstraintNode Root;
+        Root.PathIndices.assign(Queries.size(), -1);
+        Root.PathCosts.assign(Queries.size(), 0.0f);
+        std::vector<EPlanStatus> RootStatus(Queries.size(), EPlanStatus::NoPath);
+        for (int32_t Agent = 0; Agent < NumAgents && !IsOutOfBudget(); ++Agent)
+        {
+            RootStatus[Agent] = PlanAgent(Grid, Working, Queries[Agent], Agent, Root.Constraints, GetRemainingMicros(),
+                Root.PathIndices[Agent], Root.PathCosts[Agent], Stats);
+            Root.Cost += Root.PathCosts[Agent];
+        }
+
+        int32_t SolutionNode = -1;
+        std::vector<int32_t> Open;
+        if (!IsOutOfBudget())
+        {
+            DetectConflicts(Queries, ConflictRadius, TimeWindow, Root);
+            Stats.RootConflicts = Root.NumConflicts;
+            Nodes.push_back(std::move(Root));
+            Open.push_back(0);
+            Stats.HighLevelNodes = 1;
+        }
+
+        while (!Open.empty() && !IsOutOfBudget() && Stats.HighLevelNodes < MaxHighLevelNodes)
+        {
+            // 焦点选择：代价在界内的节点中取冲突最少的，相同时取代价小的
+            float MinCost = std::numeric_limits<float>::max();
+            for (int32_t NodeIndex : Open)
+            {
+                MinCost = std::min(MinCost, Nodes[NodeIndex].Cost);
+            }
+            const float FocalCost = MinCost * std::max(1.0f, SuboptimalityBound);
+            size_t Best = 0;
+            for (size_t i = 1; i < Open.size(); ++i)
+            {
+                const FConstraintNode& Candidate = Nodes[Open[i]];
+                const FConstraintNode& Current = Nodes[Open[Best]];
+                if (Candidate.Cost <= FocalCost
+                    && (Current.Cost > FocalCost || Candidate.NumConflicts < Current.NumConflicts
+                        || (Candidate.NumConflicts == Current.NumConflicts && Candidate.Cost < Current.Cost)))
+                {
+                    Best = i;
+                }
+            }
+            const int32_t ParentIndex = Open[Best];
+            Open[Best] = Open.back();
+            Open.pop_back();
+            Stats.HighLevelExpansions++;
+
+            if (Nodes[ParentIndex].NumConflicts == 0)
+            {
+                SolutionNode = ParentIndex;
+                Stats.CostLowerBound = MinCost;
+                break;
+            }
+
+            // Nodes在生成子节点时会扩容，先复制父节点
+            const FConstraintNode Parent = Nodes[ParentIndex];
+            const FConflict& Conflict = Parent.FirstConflict;
+            for (int32_t Branch = 0; Branch < 2; ++Branch)
+            {
+                FConstraint Constraint;
+                Constraint.Agent = Branch == 0 ? Conflict.AgentA : Conflict.AgentB;
+                Constraint.Segment = Branch == 0 ? Conflict.SegmentB : Conflict.SegmentA;
+
+                FConstraintNode Child;
+                Child.Constraints = Parent.Constraints;
+                Child.Constraints.push_back(Constraint);
+                Child.PathIndices = Parent.PathIndices;
+                Child.PathCosts = Parent.PathCosts;
+                if (PlanAgent(Grid, Working, Queries[Constraint.Agent], Constraint.Agent, Child.Constraints, GetRemainingMicros(),
+                    Child.PathIndices[Constraint.Agent], Child.PathCosts[Constraint.Agent], Stats) != EPlanStatus::Success)
+                {
+                    continue;
+                }
+                for (float PathCost : Child.PathCosts)
+                {
+                    Child.Cost += PathCost;
+                }
+                DetectConflicts(Queries, ConflictRadius, TimeWindow, Child);
+                Nodes.push_back(std::move(Child));
+                Open.push_back((int32_t)Nodes.size() - 1);
+                Stats.HighLevelNodes++;
+            }
+        }
+
+        if (SolutionNode < 0)
+        {
+            // 预算内未消解全部冲突（或约束树上已无可行节点）
+            FallbackPlanner.Config = Config;
+            FallbackPlanner.DistanceField = DistanceField;
+            const FBatchStats FallbackStats = FallbackPlanner.PlanBatch(Grid, Reservations, Queries, OutResults);
+            Stats.bFellBack = true;
+            Stats.NumSucceeded = FallbackStats.NumSucceeded;
+            Stats.Expansions += FallbackStats.Expansions;
+            Stats.WallSeconds = std::chrono::duration<double>(FClock::now() - SolveBegin).count();
+            return Stats;
+        }
+
+        const FConstraintNode& Solution = Nodes[SolutionNode];
+        Stats.SolutionCost = Solution.Cost;
+
+        // 冲突只在原始A*路径上消解过，平滑会改变路径形状与到达时间：先登记全部原始路径，
+        // 再逐架检查平滑后的路径与其他无人机（已确定的路径或原始路径）以及组外预约是否冲突，冲突时保留原始路径。
+        // 原始路径之间、原始路径与已接受的平滑路径之间都无冲突，因此最终结果仍然无冲突
+        for (int32_t Agent = 0; Agent < NumAgents; ++Agent)
+        {
+            if (Solution.PathIndices[Agent] >= 0)
+            {
+                const FBatchQuery& Query = Queries[Agent];
+                Working.Reserve(Query.Request.DroneID,
+                    FReservationTable::BuildSamples(PathStore[Solution.PathIndices[Agent]], Query.DroneSpeed, Query.Request.StartTime));
+            }
+        }
+
+        for (int32_t Agent = 0; Agent < NumAgents; ++Agent)
+        {
+            const FBatchQuery& Query = Queries[Agent];
+            FBatchResult& Result = OutResults[Agent];
+            Result.Expansions = AgentExpansions[Agent];
+            if (Solution.PathIndices[Agent] < 0)
+            {
+                Result.Status = RootStatus[Agent];
+                continue;
+            }
+            Result.Status = EPlanStatus::Success;
+            Result.Path = PathStore[Solution.PathIndices[Agent]];
+            Result.bReplanned = std::any_of(Solution.Constraints.begin(), Solution.Constraints.end(),
+                [Agent](const FConstraint& Constraint) { return Constraint.Agent == Agent; });
+
+            FReservationTable::FSampleList Samples = FReservationTable::BuildSamples(Result.Path, Query.DroneSpeed, Query.Request.StartTime);
+            if (Query.SafetyDistance > 0.0f)
+            {
+                std::vector<FVec3> SmoothedPath = Result.Path;
+                FPathSmoother(Grid, Query.SafetyDistance, DistanceField).SmoothPath(SmoothedPath);
+                FReservationTable::FSampleList SmoothedSamples =
+                    FReservationTable::BuildSamples(SmoothedPath, Query.DroneSpeed, Query.Request.StartTime);
+                if (!Working.IsPathConflict(SmoothedSamples, Query.Request.DroneID))
+                {
+                    Result.Path = std::move(SmoothedPath);
+                    Samples = std::move(SmoothedSamples);
+                }
+                else
+                {
+                    Stats.NumUnsmoothed++;
+                }
+            }
+            Working.Reserve(Query.Request.DroneID, Samples);
+            Reservations.Reserve(Query.Request.DroneID, std::move(Samples));
+            Stats.NumSucceeded++;
+        }
+
+        Stats.WallSeconds = std::chrono::duration<double>(FClock::now() - SolveBegin).count();
+        return Stats;
+    }
+
+    EPlanStatus FConflictBasedPlanner::PlanAgent(const FOccupancyGrid& Grid, FReservationTable& Working, const FBatchQuery& Query, int32_t Agent,
+        const std::vector<FConstraint>& Constraints, int64_t RemainingMicros, int32_t& OutPathIndex, float& OutCost,
+        FConflictSearchStats& Stats)
+    {
+        // 每条约束线段单独登记，避免首尾相连成一条折线
+        std::vector<FSpaceTimeSegment> ConstraintSegments;
+        for (const FConstraint& Constraint : Constraints)
+        {
+            if (Constraint.Agent == Agent)
+            {
+                const FSpaceTimeSegment& Segment = Constraint.Segment;
+                Working.Reserve(CONSTRAINT_DRONE_ID + (int32_t)ConstraintSegments.size(),
+                    { FSpaceTimeSample(Segment.From, Segment.BeginTime), FSpaceTimeSample(Segment.To, Segment.EndTime) });
+                ConstraintSegments.push_back(Segment);
+            }
+        }
+
+        Planner.Config = Config;
+        Planner.Config.DroneSpeed = Query.DroneSpeed;
+        Planner.Config.SearchMode = Query.SearchMode;
+        Planner.Config.MaxSearchMicros = Query.MaxSearchMicros;
+        Planner.Config.AnytimeInitialWeight = Query.AnytimeInitialWeight;
+        if (RemainingMicros > 0 && (Query.MaxSearchMicros <= 0 || RemainingMicros < Query.MaxSearchMicros))
+        {
+            Planner.Config.MaxSearchMicros = RemainingMicros;
+        }
+
+        std::vector<FVec3> Path;
+        const EPlanStatus Status = Planner.FindPath(Grid, &Working, Query.Request, Path);
+        Stats.LowLevelSearches++;
+        Stats.Expansions += Planner.GetLastStats().Expansions;
+        AgentExpansions[Agent] += Planner.GetLastStats().Expansions;
+        for (int32_t i = 0; i < (int32_t)ConstraintSegments.size(); ++i)
+        {
+            Working.Remove(CONSTRAINT_DRONE_ID + i);
+        }
+        if (Status != EPlanStatus::Success)
+        {
+            return Status;
+        }
+
+        // A*把到达目标相邻格子的节点移到目标中心，最后一段没有经过预约检查；违反约束时视为无解，避免重复生成同一冲突
+        if (!ConstraintSegments.empty())
+        {
+            std::vector<FSpaceTimeSegment> Segments;
+            Working.BuildSegments(FReservationTable::BuildSamples(Path, Query.DroneSpeed, Query.Request.StartTime), Segments);
+            for (const FSpaceTimeSegment& Segment : Segments)
+            {
+                for (const FSpaceTimeSegment& Constraint : ConstraintSegments)
+                {
+                    if (FReservationTable::IsSegmentPairConflict(Segment, Constraint, Working.GetConflictRadius()))
+                    {
+                        return EPlanStatus::NoPath;
+                    }
+                }
+            }
+        }
+
+        OutCost = Planner.GetLastStats().PathCost;
+        OutPathIndex = (int32_t)PathStore.size();
+        PathStore.push_back(std::move(Path));
+        return EPlanStatus::Success;
+    }
+
+    void FConflictBasedPlanner::DetectConflicts(const std::vector<FBatchQuery>& Queries, float ConflictRadius, float TimeWindow,
+        FConstraintNode& Node) const
+    {
+        // 冲突判定与A*搜索时相同：路径的每一段与其他无人机的预约线段求最近距离
+        const int32_t NumAgents = (int32_t)Queries.size();
+        FReservationTable Table(ConflictRadius, TimeWindow);
+        std::vector<std::vector<FSpaceTimeSegment>> AgentSegments(Queries.size());
+        for (int32_t Agent = 0; Agent < NumAgents; ++Agent)
+        {
+            if (Node.PathIndices[Agent] < 0)
+            {
+                continue;
+            }
+            const FBatchQuery& Query = Queries[Agent];
+            FReservationTable::FSampleList Samples =
+                FReservationTable::BuildSamples(PathStore[Node.PathIndices[Agent]], Query.DroneSpeed, Query.Request.StartTime);
+            Table.BuildSegments(Samples, AgentSegments[Agent]);
+            Table.Reserve(Agent, std::move(Samples));
+        }
+
+        Node.NumConflicts = 0;
+        std::vector<bool> PairCounted((size_t)NumAgents * NumAgents, false);
+        float EarliestTime = std::numeric_limits<float>::max();
+        for (int32_t Agent = 0; Agent < NumAgents; ++Agent)
+        {
+            for (const FSpaceTimeSegment& Segment : AgentSegments[Agent])
+            {
+                FSpaceTimeSegment Other;
+                int32_t OtherAgent = -1;
+                if (!Table.FindConflict(Segment, Agent, Other, OtherAgent))
+                {
+                    continue;
+                }
+
+                const size_t Pair = (size_t)std::min(Agent, OtherAgent) * NumAgents + std::max(Agent, OtherAgent);
+                if (!PairCounted[Pair])
+                {
+                    PairCounted[Pair] = true;
+                    Node.NumConflicts++;
+                }
+
+                const float ConflictTime = std::max(Segment.BeginTime, Other.BeginTime);
+                if (ConflictTime < EarliestTime)
+                {
+                    EarliestTime = ConflictTime;
+                    Node.FirstConflict.AgentA = Agent;
+                    Node.FirstConflict.AgentB = OtherAgent;
+                    Node.FirstConflict.SegmentA = Segment;
+                    Node.FirstConflict.SegmentB = Other;
+                }
+            }
+        }
+    }
+}
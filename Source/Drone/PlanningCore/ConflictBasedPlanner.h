@@ -0,0 +1,117 @@
+// ConflictBasedPlanner.h
+// 基于冲突的群体联合规划（CBS，SuboptimalityBound>1时为ECBS式的有界次优搜索）。
+// 底层为FAStarPlanner：先为每架无人机单独规划，再在约束树上逐个消解路径之间的时空冲突——
+// 冲突的两架无人机各生成一个子节点，其中一架不得与对方冲突的那一段运动相撞（约束以预约线段的形式交给A*）。
+// 超出时间预算或约束树节点上限时，退回按优先级的批量规划（FBatchPlanner）
+#pragma once
+
+#include "AStarPlanner.h"
+#include "BatchPlanner.h"
+#include "PlanningTypes.h"
+#include "ReservationTable.h"
+#include <vector>
+
+namespace DronePlanning
+{
+    class FDistanceField;
+    class FOccupancyGrid;
+
+    struct FConflictSearchStats
+    {
+        double WallSeconds = 0.0;
+
+        // 约束树上展开/生成的节点数
+        int32_t HighLevelExpansions = 0;
+        int32_t HighLevelNodes = 0;
+
+        // 底层A*的调用次数与总扩展数
+        int32_t LowLevelSearches = 0;
+        int64_t Expansions = 0;
+
+        // 各自单独规划时无人机之间的冲突数（按无人机对计）
+        int32_t RootConflicts = 0;
+        int32_t NumSucceeded = 0;
+
+        // 解的代价（各路径PathCost之和）与结束时约束树开放节点代价的下界
+        float SolutionCost = 0.0f;
+        float CostLowerBound = 0.0f;
+
+        // 平滑后与其他路径冲突、因而保留原始A*路径的无人机数
+        int32_t NumUnsmoothed = 0;
+
+        // 未在预算内找到无冲突解，结果来自FallbackPlanner
+        bool bFellBack = false;
+    };
+
+    class FConflictBasedPlanner
+    {
+    public:
+        // 每次底层搜索的配置；DroneSpeed、SearchMode、MaxSearchMicros与AnytimeInitialWeight取自各自的FBatchQuery，
+        // MaxSearchMicros不超过剩余预算
+        FPlannerConfig Config;
+
+        // 高层焦点搜索的次优界：从代价不超过 最小代价 * SuboptimalityBound 的节点中选冲突最少的展开。
+        // 1为标准CBS（按代价最小展开），解的代价不超过约束树最优解代价的SuboptimalityBound倍
+        float SuboptimalityBound = 1.0f;
+
+        // 整次联合规划的时间预算（微秒，<=0不限时）与约束树节点上限
+        int64_t MaxSolveMicros = 200000;
+        int32_t MaxHighLevelNodes = 4096;
+
+        // 与PlanGroup的Grid同步的距离场（可为空），用于加速路径平滑的安全检查
+        const FDistanceField* DistanceField = nullptr;
+
+        // 退回的优先级规划器；Config与DistanceField在退回时从本对象复制，ParallelFor等由调用方设置
+        FBatchPlanner FallbackPlanner;
+
+        // Queries按优先级从高到低排列（只影响退回时的规划顺序）。Reservations中其他无人机的预约视为静态障碍，
+        // Queries中无人机的旧预约不参与规划；结果写入Reservations，与FBatchPlanner::PlanBatch一致。
+        // 平滑后的路径仍满足无冲突，否则该无人机保留原始路径
+        FConflictSearchStats PlanGroup(const FOccupancyGrid& Grid, FReservationTable& Reservations,
+            const std::vector<FBatchQuery>& Queries, std::vector<FBatchResult>& OutResults);
+
+    private:
+        // 约束：Agent不得与Segment（另一架无人机的一段预约）发生时空冲突
+        struct FConstraint
+        {
+            int32_t Agent = 0;
+            FSpaceTimeSegment Segment;
+        };
+
+        // 两架无人机路径上最早的一次冲突，Segment为各自路径上相撞的那一段
+        struct FConflict
+        {
+            int32_t AgentA = -1;
+            int32_t AgentB = -1;
+            FSpaceTimeSegment SegmentA;
+            FSpaceTimeSegment SegmentB;
+        };
+
+        struct FConstraintNode
+        {
+            std::vector<FConstraint> Constraints;
+
+            // 每架无人机的路径在PathStore中的下标
+            std::vector<int32_t> PathIndices;
+            std::vector<float> PathCosts;
+            float Cost = 0.0f;
+            int32_t NumConflicts = 0;
+            FConflict FirstConflict;
+        };
+
+        FAStarPlanner Planner;
+        std::vector<std::vector<FVec3>> PathStore;
+        std::vector<FConstraintNode> Nodes;
+
+        // 每架无人机在所有底层搜索中的扩展数之和
+        std::vector<int32_t> AgentExpansions;
+
+        // 在Working（已去掉本组无人机的预约）上为Agent在Constraints约束下规划，成功时写入PathStore
+        EPlanStatus PlanAgent(const FOccupancyGrid& Grid, FReservationTable& Working, const FBatchQuery& Query, int32_t Agent,
+            const std::vector<FConstraint>& Constraints, int64_t RemainingMicros, int32_t& OutPathIndex, float& OutCost,
+            FConflictSearchStats& Stats);
+
+        // 统计Node中路径两两之间的冲突，记录时间最早的一次（跳过没有路径的无人机）
+        void DetectConflicts(const std::vector<FBatchQuery>& Queries, float ConflictRadius, float TimeWindow, FConstraintNode& Node) const;
+    };
+}
@@ -0,0 +1,468 @@
+// DStarLitePlanner.cpp
+#include "DStarLitePlanner.h"
+#include "GridNeighborhood.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        constexpr float DSTAR_INFINITY = std::numeric_limits<float>::infinity();
+
+        bool IsBlockedCell(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Z)
+        {
+            return !Grid.IsValidCell(X, Y, Z) || Grid.IsOccupiedCell(X, Y, Z);
+        }
+    }
+
+    void FDStarLitePlanner::Reset()
+    {
+        bInitialized = false;
+        Nodes.clear();
+        Heap.clear();
+        KeyModifier = 0.0f;
+        UpdatedSinceLastPlan = 0;
+    }
+
+    bool FDStarLitePlanner::MatchesGrid(const FOccupancyGrid& Grid) const
+    {
+        return GridResolution == Grid.GetResolution()
+            && GridOrigin.X == Grid.GetOrigin().X && GridOrigin.Y == Grid.GetOrigin().Y && GridOrigin.Z == Grid.GetOrigin().Z
+            && GridDims[0] == Grid.GetDimX() && GridDims[1] == Grid.GetDimY() && GridDims[2] == Grid.GetDimZ();
+    }
+
+    void FDStarLitePlanner::Initialize(const FOccupancyGrid& Grid, const FIntVec3& Goal, const FIntVec3& Start)
+    {
+        Reset();
+        bInitialized = true;
+        GridOrigin = Grid.GetOrigin();
+        GridResolution = Grid.GetResolution();
+        GridDims[0] = Grid.GetDimX();
+        GridDims[1] = Grid.GetDimY();
+        GridDims[2] = Grid.GetDimZ();
+        GoalCell = Goal;
+        LastStartCell = Start;
+
+        FNode& GoalNode = FindOrAddNode(Grid, Goal.X, Goal.Y, Goal.Z);
+        GoalNode.RHS = 0.0f;
+        UpdateVertex(GoalNode);
+    }
+
+    FDStarLitePlanner::FNode* FDStarLitePlanner::FindNode(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Z)
+    {
+        const auto It = Nodes.find(Grid.GetCellIndex(X, Y, Z));
+        return It != Nodes.end() ? &It->second : nullptr;
+    }
+
+    FDStarLitePlanner::FNode& FDStarLitePlanner::FindOrAddNode(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Z)
+    {
+        // unordered_map扩容不会移动元素，堆中的指针保持有效
+        const auto Result = Nodes.try_emplace(Grid.GetCellIndex(X, Y, Z));
+        FNode& Node = Result.first->second;
+        if (Result.second)
+        {
+            Node.X = X;
+            Node.Y = Y;
+            Node.Z = Z;
+        }
+        return Node;
+    }
+
+    float FDStarLitePlanner::Heuristic(const FNode& Node) const
+    {
+        return FAStarPlanner::GetDiagonalHeuristic(GridResolution, LastStartCell.X, LastStartCell.Y, LastStartCell.Z, Node.X, Node.Y, Node.Z);
+    }
+
+    void FDStarLitePlanner::CalculateKey(const FNode& Node, float& OutKey1, float& OutKey2) const
+    {
+        OutKey2 = std::min(Node.G, Node.RHS);
+        OutKey1 = OutKey2 + Heuristic(Node) + KeyModifier;
+    }
+
+    float FDStarLitePlanner::ComputeRHS(const FOccupancyGrid& Grid, const FNode& Node)
+    {
+        if (Node.X == GoalCell.X && Node.Y == GoalCell.Y && Node.Z == GoalCell.Z)
+        {
+            return 0.0f;
+        }
+        if (IsBlockedCell(Grid, Node.X, Node.Y, Node.Z))
+        {
+            return DSTAR_INFINITY;
+        }
+
+        float Best = DSTAR_INFINITY;
+        for (int32_t Direction = 0; Direction < 26; ++Direction)
+        {
+            const FGridDirection& D = GridDirections[Direction];
+            const FNode* Successor = FindNode(Grid, Node.X + D.X, Node.Y + D.Y, Node.Z + D.Z);
+            if (Successor && Successor->G != DSTAR_INFINITY && !IsBlockedCell(Grid, Successor->X, Successor->Y, Successor->Z))
+            {
+                Best = std::min(Best, GridDirections[Direction].Length * GridResolution + Successor->G);
+            }
+        }
+        return Best;
+    }
+
+    void FDStarLitePlanner::UpdateVertex(FNode& Node)
+    {
+        const bool bConsistent = Node.G == Node.RHS;
+        if (Node.HeapIndex >= 0)
+        {
+            if (bConsistent)
+            {
+                HeapRemove(&Node);
+            }
+            else
+            {
+                CalculateKey(Node, Node.Key1, Node.Key2);
+                HeapUpdate(&Node);
+            }
+        }
+        else if (!bConsistent)
+        {
+            CalculateKey(Node, Node.Key1, Node.Key2);
+            HeapPush(&Node);
+        }
+    }
+
+    EPlanStatus FDStarLitePlanner::ComputeShortestPath(const FOccupancyGrid& Grid, FNode& StartNode)
+    {
+        FSearchDeadline Deadline(Config.MaxSearchMicros);
+        int32_t Steps = 0;
+        while (!Heap.empty())
+        {
+            FNode StartKey;
+            CalculateKey(StartNode, StartKey.Key1, StartKey.Key2);
+            FNode* Top = Heap[0];
+            // 起点一致且堆顶键值大于起点时，起点的G值已确定。
+            // 启发值在最优路径上是紧的，这些格子的Key1与起点理论上相等，但舍入误差（KeyModifier累加）
+            // 会打乱堆中的先后顺序，因此Key1在容差内的格子全部处理，不再按Key2区分
+            const float Tolerance = std::max(1e-3f * GridResolution, 1e-5f * std::fabs(StartKey.Key1));
+            if (Top->Key1 > StartKey.Key1 + Tolerance && StartNode.RHS == StartNode.G)
+            {
+                break;
+            }
+
+            if (Config.CancelFlag && Config.CancelFlag->load(std::memory_order_relaxed))
+            {
+                return EPlanStatus::Cancelled;
+            }
+            if (Deadline.IsExpired())
+            {
+                return EPlanStatus::TimeLimit;
+            }
+            if (++Steps > Config.MaxSearchSteps)
+            {
+                return EPlanStatus::StepLimit;
+            }
+            LastStats.Expansions++;
+
+            FNode NewKey;
+            CalculateKey(*Top, NewKey.Key1, NewKey.Key2);
+            if (KeyLess(Top, &NewKey))
+            {
+                // 起点移动后键值变大，重新排序
+                Top->Key1 = NewKey.Key1;
+                Top->Key2 = NewKey.Key2;
+                HeapUpdate(Top);
+                continue;
+            }
+
+            const bool bTopBlocked = IsBlockedCell(Grid, Top->X, Top->Y, Top->Z);
+            if (Top->G > Top->RHS)
+            {
+                // 过一致：确定G值，放松所有前驱
+                Top->G = Top->RHS;
+                HeapRemove(Top);
+                for (int32_t Direction = 0; Direction < 26 && !bTopBlocked; ++Direction)
+                {
+                    const FGridDirection& D = GridDirections[Direction];
+                    const int32_t X = Top->X + D.X;
+                    const int32_t Y = Top->Y + D.Y;
+                    const int32_t Z = Top->Z + D.Z;
+                    if (IsBlockedCell(Grid, X, Y, Z))
+                    {
+                        continue;
+                    }
+                    FNode& Predecessor = FindOrAddNode(Grid, X, Y, Z);
+                    const float Candidate = GridDirections[Direction].Length * GridResolution + Top->G;
+                    if (Candidate < Predecessor.RHS)
+                    {
+                        Predecessor.RHS = Candidate;
+                        UpdateVertex(Predecessor);
+                    }
+                }
+            }
+            else
+            {
+                // 欠一致：G置为无穷，以它为最优后继的前驱重新计算RHS
+                const float OldG = Top->G;
+                Top->G = DSTAR_INFINITY;
+                for (int32_t Direction = 0; Direction < 26; ++Direction)
+                {
+                    const FGridDirection& D = GridDirections[Direction];
+                    FNode* Predecessor = FindNode(Grid, Top->X + D.X, Top->Y + D.Y, Top->Z + D.Z);
+                    if (Predecessor && Predecessor->RHS == GridDirections[Direction].Length * GridResolution + OldG)
+                    {
+                        Predecessor->RHS = ComputeRHS(Grid, *Predecessor);
+                        UpdateVertex(*Predecessor);
+                    }
+                }
+                Top->RHS = ComputeRHS(Grid, *Top);
+                UpdateVertex(*Top);
+            }
+        }
+        return EPlanStatus::Success;
+    }
+
+    EPlanStatus FDStarLitePlanner::Plan(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& Goal, std::vector<FVec3>& OutPath)
+    {
+        OutPath.clear();
+        LastStats = FSearchStats();
+        LastStats.GeneratedNodes = UpdatedSinceLastPlan;
+        UpdatedSinceLastPlan = 0;
+
+        int32_t StartX, StartY, StartZ;
+        int32_t GoalX, GoalY, GoalZ;
+        if (!Grid.WorldToGrid(Start, StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOutsideGrid;
+        }
+        if (!Grid.WorldToGrid(Goal, GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOutsideGrid;
+        }
+        if (Grid.IsOccupiedCell(StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOccupied;
+        }
+        if (Grid.IsOccupiedCell(GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOccupied;
+        }
+
+        const FIntVec3 StartCell(StartX, StartY, StartZ);
+        if (!bInitialized || !MatchesGrid(Grid) || GoalCell.X != GoalX || GoalCell.Y != GoalY || GoalCell.Z != GoalZ)
+        {
+            Initialize(Grid, FIntVec3(GoalX, GoalY, GoalZ), StartCell);
+        }
+        else if (StartCell.X != LastStartCell.X || StartCell.Y != LastStartCell.Y || StartCell.Z != LastStartCell.Z)
+        {
+            // 起点移动：已在堆中的键值整体偏移，不必重排
+            KeyModifier += FAStarPlanner::GetDiagonalHeuristic(GridResolution,
+                LastStartCell.X, LastStartCell.Y, LastStartCell.Z, StartX, StartY, StartZ);
+            LastStartCell = StartCell;
+        }
+
+        FNode& StartNode = FindOrAddNode(Grid, StartX, StartY, StartZ);
+        const EPlanStatus Status = ComputeShortestPath(Grid, StartNode);
+        if (Status != EPlanStatus::Success)
+        {
+            return Status;
+        }
+        if (StartNode.G == DSTAR_INFINITY)
+        {
+            return EPlanStatus::NoPath;
+        }
+
+        LastStats.PathCost = StartNode.G;
+        return ExtractPath(Grid, Start, OutPath) ? EPlanStatus::Success : EPlanStatus::NoPath;
+    }
+
+    bool FDStarLitePlanner::ExtractPath(const FOccupancyGrid& Grid, const FVec3& Start, std::vector<FVec3>& OutPath)
+    {
+        OutPath.push_back(Start);
+
+        // 沿 代价 + 后继G值 最小的方向下降到目标
+        FIntVec3 Cell = LastStartCell;
+        for (size_t Step = 0; Step <= Nodes.size(); ++Step)
+        {
+            if (Cell.X == GoalCell.X && Cell.Y == GoalCell.Y && Cell.Z == GoalCell.Z)
+            {
+                if (OutPath.size() == 1)
+                {
+                    OutPath.push_back(Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z));
+                }
+                return true;
+            }
+
+            float Best = DSTAR_INFINITY;
+            FIntVec3 BestCell = Cell;
+            for (int32_t Direction = 0; Direction < 26; ++Direction)
+            {
+                const FGridDirection& D = GridDirections[Direction];
+                const FNode* Successor = FindNode(Grid, Cell.X + D.X, Cell.Y + D.Y, Cell.Z + D.Z);
+                if (!Successor || Successor->G == DSTAR_INFINITY || IsBlockedCell(Grid, Successor->X, Successor->Y, Successor->Z))
+                {
+                    continue;
+                }
+                const float Cost = GridDirections[Direction].Length * GridResolution + Successor->G;
+                if (Cost < Best)
+                {
+                    Best = Cost;
+                    BestCell = FIntVec3(Successor->X, Successor->Y, Successor->Z);
+                }
+            }
+            if (Best == DSTAR_INFINITY)
+            {
+                OutPath.clear();
+                return false;
+            }
+            Cell = BestCell;
+            OutPath.push_back(Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z));
+        }
+
+        OutPath.clear();
+        return false;
+    }
+
+    void FDStarLitePlanner::NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed)
+    {
+        if (!bInitialized || Changed.IsEmpty())
+        {
+            return;
+        }
+        if (!MatchesGrid(Grid))
+        {
+            Reset();
+            return;
+        }
+
+        // 出边代价可能改变的格子：变化范围及其一圈邻居
+        const FCellBounds WholeMap = Grid.GetBounds();
+        const FCellBounds Affected(
+            FIntVec3(std::max(Changed.Min.X - 1, WholeMap.Min.X), std::max(Changed.Min.Y - 1, WholeMap.Min.Y), std::max(Changed.Min.Z - 1, WholeMap.Min.Z)),
+            FIntVec3(std::min(Changed.Max.X + 1, WholeMap.Max.X), std::min(Changed.Max.Y + 1, WholeMap.Max.Y), std::min(Changed.Max.Z + 1, WholeMap.Max.Z)));
+        if (Affected.IsEmpty())
+        {
+            return;
+        }
+
+        // 只有搜索过的格子需要更新：范围比已有节点少时逐格查找，否则遍历节点
+        std::vector<FNode*> AffectedNodes;
+        const int64_t Volume = (int64_t)(Affected.Max.X - Affected.Min.X + 1) * (Affected.Max.Y - Affected.Min.Y + 1) * (Affected.Max.Z - Affected.Min.Z + 1);
+        if (Volume <= (int64_t)Nodes.size())
+        {
+            for (int32_t Z = Affected.Min.Z; Z <= Affected.Max.Z; ++Z)
+            {
+                for (int32_t Y = Affected.Min.Y; Y <= Affected.Max.Y; ++Y)
+                {
+                    for (int32_t X = Affected.Min.X; X <= Affected.Max.X; ++X)
+                    {
+                        if (FNode* Node = FindNode(Grid, X, Y, Z))
+                        {
+                            AffectedNodes.push_back(Node);
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (auto& Entry : Nodes)
+            {
+                if (Affected.Contains(FIntVec3(Entry.second.X, Entry.second.Y, Entry.second.Z)))
+                {
+                    AffectedNodes.push_back(&Entry.second);
+                }
+            }
+        }
+
+        // 变为空闲、此前未被搜索到的格子：与已知节点相邻时加入
+        const size_t NumExisting = AffectedNodes.size();
+        for (size_t i = 0; i < NumExisting; ++i)
+        {
+            const FNode* Node = AffectedNodes[i];
+            if (Node->G == DSTAR_INFINITY)
+            {
+                continue;
+            }
+            for (int32_t Direction = 0; Direction < 26; ++Direction)
+            {
+                const FGridDirection& D = GridDirections[Direction];
+                const FIntVec3 Cell(Node->X + D.X, Node->Y + D.Y, Node->Z + D.Z);
+                if (Changed.Contains(Cell) && !IsBlockedCell(Grid, Cell.X, Cell.Y, Cell.Z) && !FindNode(Grid, Cell.X, Cell.Y, Cell.Z))
+                {
+                    AffectedNodes.push_back(&FindOrAddNode(Grid, Cell.X, Cell.Y, Cell.Z));
+                }
+            }
+        }
+
+        for (FNode* Node : AffectedNodes)
+        {
+            Node->RHS = ComputeRHS(Grid, *Node);
+            UpdateVertex(*Node);
+        }
+        UpdatedSinceLastPlan += (int32_t)AffectedNodes.size();
+    }
+
+    void FDStarLitePlanner::HeapPush(FNode* Node)
+    {
+        Heap.push_back(Node);
+        Node->HeapIndex = (int32_t)Heap.size() - 1;
+        SiftUp(Node->HeapIndex);
+    }
+
+    void FDStarLitePlanner::HeapRemove(FNode* Node)
+    {
+        const int32_t Index = Node->HeapIndex;
+        FNode* Last = Heap.back();
+        Heap.pop_back();
+        Node->HeapIndex = -1;
+        if (Last != Node)
+        {
+            Place(Index, Last);
+            SiftUp(Index);
+            SiftDown(Last->HeapIndex);
+        }
+    }
+
+    void FDStarLitePlanner::HeapUpdate(FNode* Node)
+    {
+        SiftUp(Node->HeapIndex);
+        SiftDown(Node->HeapIndex);
+    }
+
+    void FDStarLitePlanner::SiftUp(int32_t Index)
+    {
+        FNode* Node = Heap[Index];
+        while (Index > 0)
+        {
+            const int32_t ParentIndex = (Index - 1) / 2;
+            if (!KeyLess(Node, Heap[ParentIndex]))
+            {
+                break;
+            }
+            Place(Index, Heap[ParentIndex]);
+            Index = ParentIndex;
+        }
+        Place(Index, Node);
+    }
+
+    void FDStarLitePlanner::SiftDown(int32_t Index)
+    {
+        FNode* Node = Heap[Index];
+        const int32_t Count = (int32_t)Heap.size();
+        while (true)
+        {
+            int32_t Child = Index * 2 + 1;
+            if (Child >= Count)
+            {
+                break;
+            }
+            if (Child + 1 < Count && KeyLess(Heap[Child + 1], Heap[Child]))
+            {
+                Child++;
+            }
+            if (!KeyLess(Heap[Child], Node))
+            {
+                break;
+            }
+            Place(Index, Heap[Child]);
+            Index = Child;
+        }
+        Place(Index, Node);
+    }
+}
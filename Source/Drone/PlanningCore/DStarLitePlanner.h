@@ -0,0 +1,97 @@
+// DStarLitePlanner.h
+// 增量重规划（D* Lite）：从目标向起点反向搜索并保留搜索树，无人机移动或地图变化后
+// 只修复受影响的部分。每架无人机持有一个实例，目标改变或地图重新初始化时重置
+#pragma once
+
+#include "AStarPlanner.h"
+#include "PlanningTypes.h"
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+
+    class FDStarLitePlanner
+    {
+    public:
+        // 使用MaxSearchSteps（每次Plan的扩展预算）、MaxSearchMicros与CancelFlag；不使用预约表
+        FPlannerConfig Config;
+
+        // 从Start到Goal规划（26邻域，代价与FAStarPlanner相同）。目标格子或地图尺寸与上次不同时从头搜索。
+        // 返回StepLimit/TimeLimit时搜索状态保留，下一次调用继续
+        EPlanStatus Plan(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& Goal, std::vector<FVec3>& OutPath);
+
+        // Changed范围内的格子占用发生了变化（Grid已是变化后的状态）。
+        // 只更新范围附近已搜索过的格子，代价与变化范围成正比
+        void NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed);
+
+        void Reset();
+
+        bool IsInitialized() const { return bInitialized; }
+        int32_t GetNumNodes() const { return (int32_t)Nodes.size(); }
+
+        // Expansions为本次Plan的扩展次数，GeneratedNodes为上一次Plan以来因地图变化而更新的格子数
+        const FSearchStats& GetLastStats() const { return LastStats; }
+
+    private:
+        struct FNode
+        {
+            int32_t X = 0;
+            int32_t Y = 0;
+            int32_t Z = 0;
+            float G = std::numeric_limits<float>::infinity();
+            float RHS = std::numeric_limits<float>::infinity();
+            float Key1 = 0.0f;
+            float Key2 = 0.0f;
+            int32_t HeapIndex = -1;
+        };
+
+        bool bInitialized = false;
+        FVec3 GridOrigin;
+        float GridResolution = 0.0f;
+        int32_t GridDims[3] = { 0, 0, 0 };
+
+        FIntVec3 GoalCell;
+        FIntVec3 LastStartCell;
+        float KeyModifier = 0.0f;
+
+        std::unordered_map<int64_t, FNode> Nodes;
+        std::vector<FNode*> Heap;
+        FSearchStats LastStats;
+        int32_t UpdatedSinceLastPlan = 0;
+
+        bool MatchesGrid(const FOccupancyGrid& Grid) const;
+        void Initialize(const FOccupancyGrid& Grid, const FIntVec3& Goal, const FIntVec3& Start);
+
+        FNode* FindNode(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Z);
+        FNode& FindOrAddNode(const FOccupancyGrid& Grid, int32_t X, int32_t Y, int32_t Z);
+
+        float Heuristic(const FNode& Node) const;
+        void CalculateKey(const FNode& Node, float& OutKey1, float& OutKey2) const;
+
+        // 按后继的G值重新计算RHS（目标格子除外）
+        float ComputeRHS(const FOccupancyGrid& Grid, const FNode& Node);
+        void UpdateVertex(FNode& Node);
+
+        EPlanStatus ComputeShortestPath(const FOccupancyGrid& Grid, FNode& StartNode);
+        bool ExtractPath(const FOccupancyGrid& Grid, const FVec3& Start, std::vector<FVec3>& OutPath);
+
+        // 带索引的二叉最小堆，按(Key1, Key2)字典序
+        static bool KeyLess(const FNode* A, const FNode* B)
+        {
+            return A->Key1 < B->Key1 || (A->Key1 == B->Key1 && A->Key2 < B->Key2);
+        }
+        void HeapPush(FNode* Node);
+        void HeapRemove(FNode* Node);
+        void HeapUpdate(FNode* Node);
+        void SiftUp(int32_t Index);
+        void SiftDown(int32_t Index);
+        void Place(int32_t Index, FNode* Node)
+        {
+            Heap[Index] = Node;
+            Node->HeapIndex = Index;
+        }
+    };
+}
@@ -0,0 +1,235 @@
+// DistanceField.cpp
+#include "DistanceField.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        // 远大于任何窗口内可能出现的平方距离，又不会在相加时溢出
+        constexpr int32_t DISTANCE_INFINITY = 1 << 28;
+
+        // 平方距离以uint16存储
+        constexpr int32_t MAX_TRUNCATION_CELLS = 255;
+    }
+
+    bool FDistanceField::Build(const FOccupancyGrid& Grid, float InMaxDistance)
+    {
+        if (!Grid.IsInitialized() || Grid.IsSparse())
+        {
+            Reset();
+            return false;
+        }
+
+        Origin = Grid.GetOrigin();
+        CellSize = Grid.GetResolution();
+        DimX = Grid.GetDimX();
+        DimY = Grid.GetDimY();
+        DimZ = Grid.GetDimZ();
+        MaxDistance = InMaxDistance;
+        MaxCells = std::min(std::max((int32_t)std::ceil(InMaxDistance / CellSize), 1), MAX_TRUNCATION_CELLS);
+        CapDistSq = (uint16_t)(MaxCells * MaxCells + 1);
+        DistSq.assign((size_t)Grid.GetNumCells(), CapDistSq);
+
+        const FCellBounds WholeMap = Grid.GetBounds();
+        Recompute(Grid, WholeMap, WholeMap);
+        return true;
+    }
+
+    void FDistanceField::Update(const FOccupancyGrid& Grid, const FCellBounds& Changed)
+    {
+        if (!IsValid() || Changed.IsEmpty())
+        {
+            return;
+        }
+
+        // 距离可能改变的格子：变化范围向外扩展截断格数；
+        // 这些格子的最近障碍物（在截断距离内时）一定落在再向外扩展截断格数的范围内
+        const FCellBounds WholeMap = Grid.GetBounds();
+        auto Expand = [this, &WholeMap](const FCellBounds& Bounds)
+        {
+            return FCellBounds(
+                FIntVec3(std::max(Bounds.Min.X - MaxCells, WholeMap.Min.X), std::max(Bounds.Min.Y - MaxCells, WholeMap.Min.Y),
+                    std::max(Bounds.Min.Z - MaxCells, WholeMap.Min.Z)),
+                FIntVec3(std::min(Bounds.Max.X + MaxCells, WholeMap.Max.X), std::min(Bounds.Max.Y + MaxCells, WholeMap.Max.Y),
+                    std::min(Bounds.Max.Z + MaxCells, WholeMap.Max.Z)));
+        };
+        const FCellBounds Target = Expand(Changed);
+        if (Target.IsEmpty())
+        {
+            return;
+        }
+        Recompute(Grid, Target, Expand(Target));
+    }
+
+    void FDistanceField::Reset()
+    {
+        std::vector<uint16_t>().swap(DistSq);
+        std::vector<int32_t>().swap(Window);
+        DimX = DimY = DimZ = 0;
+    }
+
+    bool FDistanceField::WorldToCell(const FVec3& WorldPos, int32_t& X, int32_t& Y, int32_t& Z) const
+    {
+        X = (int32_t)std::floor((WorldPos.X - Origin.X) / CellSize);
+        Y = (int32_t)std::floor((WorldPos.Y - Origin.Y) / CellSize);
+        Z = (int32_t)std::floor((WorldPos.Z - Origin.Z) / CellSize);
+        return X >= 0 && X < DimX && Y >= 0 && Y < DimY && Z >= 0 && Z < DimZ;
+    }
+
+    float FDistanceField::GetDistance(const FVec3& WorldPos) const
+    {
+        int32_t X, Y, Z;
+        if (!IsValid() || !WorldToCell(WorldPos, X, Y, Z))
+        {
+            return -1.0f;
+        }
+        return GetCellDistance(X, Y, Z);
+    }
+
+    FVec3 FDistanceField::GetGradient(const FVec3& WorldPos) const
+    {
+        int32_t X, Y, Z;
+        if (!IsValid() || !WorldToCell(WorldPos, X, Y, Z))
+        {
+            return FVec3();
+        }
+
+        // 边界上退化为单侧差分
+        auto Derivative = [this](int32_t Lo[3], int32_t Hi[3], int32_t Steps)
+        {
+            return Steps > 0
+                ? (GetCellDistance(Hi[0], Hi[1], Hi[2]) - GetCellDistance(Lo[0], Lo[1], Lo[2])) / (Steps * CellSize)
+                : 0.0;
+        };
+        const int32_t Cell[3] = { X, Y, Z };
+        const int32_t Dim[3] = { DimX, DimY, DimZ };
+        double Gradient[3];
+        for (int32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            int32_t Lo[3] = { Cell[0], Cell[1], Cell[2] };
+            int32_t Hi[3] = { Cell[0], Cell[1], Cell[2] };
+            Lo[Axis] = std::max(Cell[Axis] - 1, 0);
+            Hi[Axis] = std::min(Cell[Axis] + 1, Dim[Axis] - 1);
+            Gradient[Axis] = Derivative(Lo, Hi, Hi[Axis] - Lo[Axis]);
+        }
+        return FVec3(Gradient[0], Gradient[1], Gradient[2]);
+    }
+
+    void FDistanceField::Recompute(const FOccupancyGrid& Grid, const FCellBounds& Target, const FCellBounds& Source)
+    {
+        const int32_t SizeX = Source.Max.X - Source.Min.X + 1;
+        const int32_t SizeY = Source.Max.Y - Source.Min.Y + 1;
+        const int32_t SizeZ = Source.Max.Z - Source.Min.Z + 1;
+        Window.resize((size_t)SizeX * SizeY * SizeZ);
+        const int32_t MaxLength = std::max(SizeX, std::max(SizeY, SizeZ));
+        LineIn.resize(MaxLength);
+        LineOut.resize(MaxLength);
+        Envelope.resize(MaxLength);
+        Boundaries.resize(MaxLength + 1);
+
+        auto WindowIndex = [SizeX, SizeY](int32_t X, int32_t Y, int32_t Z)
+        {
+            return ((size_t)Z * SizeY + Y) * SizeX + X;
+        };
+
+        // 沿X：占用格子为0，其余为无穷远
+        for (int32_t Z = 0; Z < SizeZ; ++Z)
+        {
+            for (int32_t Y = 0; Y < SizeY; ++Y)
+            {
+                for (int32_t X = 0; X < SizeX; ++X)
+                {
+                    LineIn[X] = Grid.IsOccupiedCell(Source.Min.X + X, Source.Min.Y + Y, Source.Min.Z + Z) ? 0 : DISTANCE_INFINITY;
+                }
+                Transform1D(SizeX);
+                std::copy(LineOut.begin(), LineOut.begin() + SizeX, Window.begin() + WindowIndex(0, Y, Z));
+            }
+        }
+
+        // 沿Y
+        for (int32_t Z = 0; Z < SizeZ; ++Z)
+        {
+            for (int32_t X = 0; X < SizeX; ++X)
+            {
+                for (int32_t Y = 0; Y < SizeY; ++Y)
+                {
+                    LineIn[Y] = Window[WindowIndex(X, Y, Z)];
+                }
+                Transform1D(SizeY);
+                for (int32_t Y = 0; Y < SizeY; ++Y)
+                {
+                    Window[WindowIndex(X, Y, Z)] = LineOut[Y];
+                }
+            }
+        }
+
+        // 沿Z，只写回目标范围
+        for (int32_t Y = Target.Min.Y - Source.Min.Y; Y <= Target.Max.Y - Source.Min.Y; ++Y)
+        {
+            for (int32_t X = Target.Min.X - Source.Min.X; X <= Target.Max.X - Source.Min.X; ++X)
+            {
+                for (int32_t Z = 0; Z < SizeZ; ++Z)
+                {
+                    LineIn[Z] = Window[WindowIndex(X, Y, Z)];
+                }
+                Transform1D(SizeZ);
+                for (int32_t Z = Target.Min.Z - Source.Min.Z; Z <= Target.Max.Z - Source.Min.Z; ++Z)
+                {
+                    const size_t Index = ((size_t)(Source.Min.Z + Z) * DimY + (Source.Min.Y + Y)) * DimX + (Source.Min.X + X);
+                    DistSq[Index] = (uint16_t)std::min(LineOut[Z], (int32_t)CapDistSq);
+                }
+            }
+        }
+    }
+
+    void FDistanceField::Transform1D(int32_t Count)
+    {
+        // 抛物线下包络（Felzenszwalb & Huttenlocher），Envelope为包络上各抛物线的顶点，
+        // Boundaries[k]为第k条抛物线开始占优的位置
+        int32_t NumParabolas = 0;
+        for (int32_t Q = 0; Q < Count; ++Q)
+        {
+            if (LineIn[Q] >= DISTANCE_INFINITY)
+            {
+                continue;
+            }
+            double Intersection = -std::numeric_limits<double>::infinity();
+            while (NumParabolas > 0)
+            {
+                const int32_t P = Envelope[NumParabolas - 1];
+                Intersection = ((double)LineIn[Q] + (double)Q * Q - (double)LineIn[P] - (double)P * P) / (2.0 * (Q - P));
+                if (Intersection > Boundaries[NumParabolas - 1])
+                {
+                    break;
+                }
+                NumParabolas--;
+                Intersection = -std::numeric_limits<double>::infinity();
+            }
+            Envelope[NumParabolas] = Q;
+            Boundaries[NumParabolas] = Intersection;
+            NumParabolas++;
+        }
+
+        if (NumParabolas == 0)
+        {
+            std::fill(LineOut.begin(), LineOut.begin() + Count, DISTANCE_INFINITY);
+            return;
+        }
+
+        int32_t K = 0;
+        for (int32_t Q = 0; Q < Count; ++Q)
+        {
+            while (K + 1 < NumParabolas && Boundaries[K + 1] < Q)
+            {
+                K++;
+            }
+            const int32_t P = Envelope[K];
+            const int64_t Value = (int64_t)(Q - P) * (Q - P) + LineIn[P];
+            LineOut[Q] = (int32_t)std::min<int64_t>(Value, DISTANCE_INFINITY);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// DistanceField.h
+// 占用栅格的截断欧氏距离场（ESDF）：每个格子保存到最近占用格子中心的平方距离（格子单位）。
+// 用可分离的精确距离变换（Felzenszwalb）构建；占用变化后只重算受影响的局部窗口，结果与整图重建相同
+#pragma once
+
+#include "PlanningTypes.h"
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+
+    class FDistanceField
+    {
+    public:
+        // 整图构建。MaxDistance为截断距离（世界单位），超过截断距离的格子只记录"大于截断距离"。
+        // 只支持稠密存储的栅格，稀疏栅格返回false
+        bool Build(const FOccupancyGrid& Grid, float MaxDistance);
+
+        // Grid中Changed范围内的占用发生变化（置位或清除）后调用，只重算距离可能改变的格子
+        void Update(const FOccupancyGrid& Grid, const FCellBounds& Changed);
+
+        void Reset();
+
+        bool IsValid() const { return !DistSq.empty(); }
+        float GetMaxDistance() const { return MaxDistance; }
+
+        // 格子中心到最近占用格子中心的距离（世界单位）。超过截断距离时返回截断格数 * 分辨率，
+        // 它不小于MaxDistance且严格小于真实距离，可直接作为安全距离的下界使用
+        float GetCellDistance(int32_t X, int32_t Y, int32_t Z) const
+        {
+            const uint16_t Value = DistSq[((size_t)Z * DimY + Y) * DimX + X];
+            return Value >= CapDistSq ? MaxCells * CellSize : std::sqrt((float)Value) * CellSize;
+        }
+
+        // 世界坐标所在格子的距离，点在地图外时返回-1
+        float GetDistance(const FVec3& WorldPos) const;
+
+        // 距离场梯度（中心差分，单位为距离/距离），指向远离障碍物的方向；点在地图外时为零向量
+        FVec3 GetGradient(const FVec3& WorldPos) const;
+
+    private:
+        FVec3 Origin;
+        float CellSize = 0.0f;
+        int32_t DimX = 0;
+        int32_t DimY = 0;
+        int32_t DimZ = 0;
+        float MaxDistance = 0.0f;
+
+        // 截断格数；平方距离>=CapDistSq表示超过截断距离
+        int32_t MaxCells = 0;
+        uint16_t CapDistSq = 0;
+
+        std::vector<uint16_t> DistSq;
+
+        // 重算时复用的临时数组
+        std::vector<int32_t> Window;
+        std::vector<int32_t> LineIn;
+        std::vector<int32_t> LineOut;
+        std::vector<int32_t> Envelope;
+        std::vector<double> Boundaries;
+
+        bool WorldToCell(const FVec3& WorldPos, int32_t& X, int32_t& Y, int32_t& Z) const;
+
+        // 用Source范围内的占用重算Target范围内格子的距离（Target须包含在Source内）
+        void Recompute(const FOccupancyGrid& Grid, const FCellBounds& Target, const FCellBounds& Source);
+
+        // 一维平方距离变换：Out[q] = min_p (q - p)^2 + In[p]
+        void Transform1D(int32_t Count);
+    };
+}
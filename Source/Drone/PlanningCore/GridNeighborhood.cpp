@@ -0,0 +1,28 @@
+// GridNeighborhood.cpp
+#include "GridNeighborhood.h"
+#include "OccupancyGrid.h"
+
+namespace DronePlanning
+{
+    const char* LexToString(EGridConnectivity Connectivity)
+    {
+        switch (Connectivity)
+        {
+        case EGridConnectivity::Face6:    return "6-connected";
+        case EGridConnectivity::Edge18:   return "18-connected";
+        case EGridConnectivity::Corner26: return "26-connected";
+        }
+        return "Unknown";
+    }
+
+    FGridIndexOffsets::FGridIndexOffsets(const FOccupancyGrid& Grid)
+    {
+        // 两种索引编码对坐标都是线性的，以(1, 1, 1)为基准求差即可
+        const int64_t Base = Grid.GetCellIndex(1, 1, 1);
+        for (int32_t Direction = 0; Direction < 26; ++Direction)
+        {
+            const FGridDirection& D = GridDirections[Direction];
+            Offsets[Direction] = Grid.GetCellIndex(1 + D.X, 1 + D.Y, 1 + D.Z) - Base;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// GridNeighborhood.h
+// 三维栅格邻域的编译期表：方向偏移与步长（以格子为单位）、与邻域匹配的无分支启发式，
+// 以及按格子线性索引的邻居偏移。方向按 面(6) -> 棱(12) -> 角(8) 排列，前N个即N邻域
+#pragma once
+
+#include "PlanningTypes.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+
+    enum class EGridConnectivity : uint8_t
+    {
+        Face6 = 6,
+        Edge18 = 18,
+        Corner26 = 26,
+    };
+
+    const char* LexToString(EGridConnectivity Connectivity);
+
+    struct FGridDirection
+    {
+        int32_t X;
+        int32_t Y;
+        int32_t Z;
+
+        // 步长（格子数），乘以分辨率为世界单位
+        float Length;
+    };
+
+    constexpr float GRID_SQRT2 = 1.41421356237f;
+    constexpr float GRID_SQRT3 = 1.73205080757f;
+
+    constexpr FGridDirection GridDirections[26] = {
+        // 面
+        {1, 0, 0, 1.0f}, {-1, 0, 0, 1.0f}, {0, 1, 0, 1.0f}, {0, -1, 0, 1.0f}, {0, 0, 1, 1.0f}, {0, 0, -1, 1.0f},
+        // 棱
+        {1, 1, 0, GRID_SQRT2}, {1, -1, 0, GRID_SQRT2}, {-1, 1, 0, GRID_SQRT2}, {-1, -1, 0, GRID_SQRT2},
+        {1, 0, 1, GRID_SQRT2}, {1, 0, -1, GRID_SQRT2}, {-1, 0, 1, GRID_SQRT2}, {-1, 0, -1, GRID_SQRT2},
+        {0, 1, 1, GRID_SQRT2}, {0, 1, -1, GRID_SQRT2}, {0, -1, 1, GRID_SQRT2}, {0, -1, -1, GRID_SQRT2},
+        // 角
+        {1, 1, 1, GRID_SQRT3}, {1, 1, -1, GRID_SQRT3}, {1, -1, 1, GRID_SQRT3}, {1, -1, -1, GRID_SQRT3},
+        {-1, 1, 1, GRID_SQRT3}, {-1, 1, -1, GRID_SQRT3}, {-1, -1, 1, GRID_SQRT3}, {-1, -1, -1, GRID_SQRT3}
+    };
+
+    // 邻居的格子索引 = 当前格子索引 + Offsets[方向]（稠密与稀疏编码都成立，调用方须先确认邻居在地图内）
+    struct FGridIndexOffsets
+    {
+        int64_t Offsets[26] = {};
+
+        FGridIndexOffsets() = default;
+        explicit FGridIndexOffsets(const FOccupancyGrid& Grid);
+    };
+
+    template <EGridConnectivity Connectivity>
+    struct TGridNeighborhood
+    {
+        static constexpr int32_t NumDirections = (int32_t)Connectivity;
+
+        // 无障碍物时的最短距离（格子数），对该邻域是一致（consistent）的启发式。
+        // 三个分量排序为 A >= B >= C 后按公式计算，只用min/max，没有分支
+        static float GetHeuristic(int32_t DX, int32_t DY, int32_t DZ)
+        {
+            const float X = (float)std::abs(DX);
+            const float Y = (float)std::abs(DY);
+            const float Z = (float)std::abs(DZ);
+            const float A = std::max(std::max(X, Y), Z);
+            const float C = std::min(std::min(X, Y), Z);
+            const float B = X + Y + Z - A - C;
+            if constexpr (Connectivity == EGridConnectivity::Corner26)
+            {
+                // 先走C步体对角，再走B-C步面对角，最后A-B步直线
+                return GRID_SQRT3 * C + GRID_SQRT2 * (B - C) + (A - B);
+            }
+            else if constexpr (Connectivity == EGridConnectivity::Edge18)
+            {
+                // 每步最多改变两个分量：A >= B + C时用B + C步对角，否则全部分量两两配对
+                const float Pairable = B + C;
+                return GRID_SQRT2 * std::min(Pairable, 0.5f * (A + Pairable)) + std::max(A - Pairable, 0.0f);
+            }
+            else
+            {
+                return X + Y + Z;
+            }
+        }
+    };
+}
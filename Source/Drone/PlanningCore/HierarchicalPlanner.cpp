@@ -0,0 +1,675 @@
+// HierarchicalPlanner.cpp
+#include "HierarchicalPlanner.h"
+#include "GridNeighborhood.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        constexpr float HPA_INFINITY = std::numeric_limits<float>::infinity();
+
+        // 入口图节点键：区块索引 << 16 | 入口序号；起点与终点使用负数
+        constexpr int64_t HPA_START_KEY = -1;
+        constexpr int64_t HPA_GOAL_KEY = -2;
+        constexpr int32_t HPA_PORTAL_BITS = 16;
+
+        int32_t GetAxis(const FIntVec3& V, int32_t Axis)
+        {
+            return Axis == 0 ? V.X : (Axis == 1 ? V.Y : V.Z);
+        }
+
+        FIntVec3 OffsetAlong(const FIntVec3& V, int32_t Axis, int32_t Delta)
+        {
+            return FIntVec3(V.X + (Axis == 0 ? Delta : 0), V.Y + (Axis == 1 ? Delta : 0), V.Z + (Axis == 2 ? Delta : 0));
+        }
+
+        bool IsFreeCell(const FOccupancyGrid& Grid, const FIntVec3& Cell)
+        {
+            return Grid.IsValidCell(Cell.X, Cell.Y, Cell.Z) && !Grid.IsOccupiedCell(Cell.X, Cell.Y, Cell.Z);
+        }
+
+        bool CellLess(const FIntVec3& A, const FIntVec3& B)
+        {
+            return A.Z != B.Z ? A.Z < B.Z : (A.Y != B.Y ? A.Y < B.Y : A.X < B.X);
+        }
+
+        struct FAbstractNode
+        {
+            FIntVec3 Cell;
+            float G = HPA_INFINITY;
+            int64_t Parent = 0;
+            bool bClosed = false;
+        };
+    }
+
+    void FHierarchicalPlanner::Reset()
+    {
+        bInitialized = false;
+        Faces.clear();
+        Clusters.clear();
+    }
+
+    bool FHierarchicalPlanner::MatchesGrid(const FOccupancyGrid& Grid) const
+    {
+        return BuiltClusterSize == std::min(std::max(ClusterSize, 4), 64)
+            && GridResolution == Grid.GetResolution()
+            && GridOrigin.X == Grid.GetOrigin().X && GridOrigin.Y == Grid.GetOrigin().Y && GridOrigin.Z == Grid.GetOrigin().Z
+            && GridDims[0] == Grid.GetDimX() && GridDims[1] == Grid.GetDimY() && GridDims[2] == Grid.GetDimZ();
+    }
+
+    void FHierarchicalPlanner::Initialize(const FOccupancyGrid& Grid)
+    {
+        Reset();
+        bInitialized = true;
+        GridOrigin = Grid.GetOrigin();
+        GridResolution = Grid.GetResolution();
+        GridDims[0] = Grid.GetDimX();
+        GridDims[1] = Grid.GetDimY();
+        GridDims[2] = Grid.GetDimZ();
+        BuiltClusterSize = std::min(std::max(ClusterSize, 4), 64);
+        for (int32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            NumClusters[Axis] = (GridDims[Axis] + BuiltClusterSize - 1) / BuiltClusterSize;
+        }
+    }
+
+    FIntVec3 FHierarchicalPlanner::GetClusterCoord(const FIntVec3& Cell) const
+    {
+        return FIntVec3(Cell.X / BuiltClusterSize, Cell.Y / BuiltClusterSize, Cell.Z / BuiltClusterSize);
+    }
+
+    int64_t FHierarchicalPlanner::GetClusterIndex(const FIntVec3& ClusterCoord) const
+    {
+        return ((int64_t)ClusterCoord.Z * NumClusters[1] + ClusterCoord.Y) * NumClusters[0] + ClusterCoord.X;
+    }
+
+    FIntVec3 FHierarchicalPlanner::GetClusterCoordFromIndex(int64_t ClusterIndex) const
+    {
+        return FIntVec3((int32_t)(ClusterIndex % NumClusters[0]), (int32_t)((ClusterIndex / NumClusters[0]) % NumClusters[1]),
+            (int32_t)(ClusterIndex / ((int64_t)NumClusters[0] * NumClusters[1])));
+    }
+
+    FCellBounds FHierarchicalPlanner::GetClusterBounds(const FIntVec3& ClusterCoord) const
+    {
+        const FIntVec3 Min(ClusterCoord.X * BuiltClusterSize, ClusterCoord.Y * BuiltClusterSize, ClusterCoord.Z * BuiltClusterSize);
+        return FCellBounds(Min, FIntVec3(std::min(Min.X + BuiltClusterSize, GridDims[0]) - 1,
+            std::min(Min.Y + BuiltClusterSize, GridDims[1]) - 1, std::min(Min.Z + BuiltClusterSize, GridDims[2]) - 1));
+    }
+
+    const std::vector<FIntVec3>& FHierarchicalPlanner::GetFace(const FOccupancyGrid& Grid, const FIntVec3& LowerCluster, int32_t Axis)
+    {
+        const int64_t Key = GetClusterIndex(LowerCluster) * 3 + Axis;
+        const auto Found = Faces.find(Key);
+        if (Found != Faces.end())
+        {
+            return Found->second;
+        }
+
+        std::vector<FIntVec3>& Entrances = Faces[Key];
+
+        // 面上的两个方向U、V；下侧格子位于下侧区块沿Axis的最后一层
+        const FCellBounds Bounds = GetClusterBounds(LowerCluster);
+        const int32_t AxisU = Axis == 0 ? 1 : 0;
+        const int32_t AxisV = Axis == 2 ? 1 : 2;
+        const int32_t MinU = GetAxis(Bounds.Min, AxisU);
+        const int32_t MinV = GetAxis(Bounds.Min, AxisV);
+        const int32_t SizeU = GetAxis(Bounds.Max, AxisU) - MinU + 1;
+        const int32_t SizeV = GetAxis(Bounds.Max, AxisV) - MinV + 1;
+        const int32_t Plane = GetAxis(Bounds.Max, Axis);
+
+        auto MakeCell = [&](int32_t U, int32_t V)
+        {
+            int32_t Coord[3];
+            Coord[Axis] = Plane;
+            Coord[AxisU] = MinU + U;
+            Coord[AxisV] = MinV + V;
+            return FIntVec3(Coord[0], Coord[1], Coord[2]);
+        };
+
+        // 两侧格子都空闲的位置按4邻接分为连通区域
+        std::vector<int32_t> Component(SizeU * SizeV, -2);
+        for (int32_t V = 0; V < SizeV; ++V)
+        {
+            for (int32_t U = 0; U < SizeU; ++U)
+            {
+                const FIntVec3 Lower = MakeCell(U, V);
+                if (IsFreeCell(Grid, Lower) && IsFreeCell(Grid, OffsetAlong(Lower, Axis, 1)))
+                {
+                    Component[V * SizeU + U] = -1;
+                }
+            }
+        }
+
+        // 每个连通区域一个入口，取最接近区域重心的格子
+        std::vector<int32_t> Stack;
+        std::vector<int32_t> Members;
+        int32_t NumComponents = 0;
+        for (int32_t Seed = 0; Seed < SizeU * SizeV; ++Seed)
+        {
+            if (Component[Seed] != -1)
+            {
+                continue;
+            }
+
+            Members.clear();
+            Stack.push_back(Seed);
+            Component[Seed] = NumComponents;
+            double SumU = 0.0;
+            double SumV = 0.0;
+            while (!Stack.empty())
+            {
+                const int32_t Current = Stack.back();
+                Stack.pop_back();
+                Members.push_back(Current);
+                const int32_t U = Current % SizeU;
+                const int32_t V = Current / SizeU;
+                SumU += U;
+                SumV += V;
+                const int32_t Neighbors[4][2] = { {U - 1, V}, {U + 1, V}, {U, V - 1}, {U, V + 1} };
+                for (const auto& Neighbor : Neighbors)
+                {
+                    if (Neighbor[0] >= 0 && Neighbor[0] < SizeU && Neighbor[1] >= 0 && Neighbor[1] < SizeV
+                        && Component[Neighbor[1] * SizeU + Neighbor[0]] == -1)
+                    {
+                        Component[Neighbor[1] * SizeU + Neighbor[0]] = NumComponents;
+                        Stack.push_back(Neighbor[1] * SizeU + Neighbor[0]);
+                    }
+                }
+            }
+            NumComponents++;
+
+            const double CenterU = SumU / Members.size();
+            const double CenterV = SumV / Members.size();
+            double BestDistance = HPA_INFINITY;
+            int32_t BestMember = Seed;
+            for (int32_t Member : Members)
+            {
+                const double DU = Member % SizeU - CenterU;
+                const double DV = Member / SizeU - CenterV;
+                if (DU * DU + DV * DV < BestDistance)
+                {
+                    BestDistance = DU * DU + DV * DV;
+                    BestMember = Member;
+                }
+            }
+            Entrances.push_back(MakeCell(BestMember % SizeU, BestMember / SizeU));
+        }
+        return Entrances;
+    }
+
+    const FHierarchicalPlanner::FCluster& FHierarchicalPlanner::GetCluster(const FOccupancyGrid& Grid, int64_t ClusterIndex)
+    {
+        const auto Found = Clusters.find(ClusterIndex);
+        if (Found != Clusters.end())
+        {
+            return Found->second;
+        }
+
+        LastStats.GeneratedNodes++;
+        FCluster& Cluster = Clusters[ClusterIndex];
+        const FIntVec3 Coord = GetClusterCoordFromIndex(ClusterIndex);
+        for (int32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            if (GetAxis(Coord, Axis) + 1 < NumClusters[Axis])
+            {
+                const std::vector<FIntVec3>& Face = GetFace(Grid, Coord, Axis);
+                Cluster.Portals.insert(Cluster.Portals.end(), Face.begin(), Face.end());
+            }
+            if (GetAxis(Coord, Axis) > 0)
+            {
+                for (const FIntVec3& Lower : GetFace(Grid, OffsetAlong(Coord, Axis, -1), Axis))
+                {
+                    Cluster.Portals.push_back(OffsetAlong(Lower, Axis, 1));
+                }
+            }
+        }
+        std::sort(Cluster.Portals.begin(), Cluster.Portals.end(), CellLess);
+        Cluster.Portals.erase(std::unique(Cluster.Portals.begin(), Cluster.Portals.end()), Cluster.Portals.end());
+
+        Cluster.Edges.resize(Cluster.Portals.size());
+        Cluster.EdgesBuilt.assign(Cluster.Portals.size(), 0);
+        return Cluster;
+    }
+
+    const std::vector<FHierarchicalPlanner::FPortalEdge>& FHierarchicalPlanner::GetPortalEdges(const FOccupancyGrid& Grid, int64_t ClusterIndex, int32_t Portal)
+    {
+        GetCluster(Grid, ClusterIndex);
+        FCluster& Cluster = Clusters[ClusterIndex];
+        if (Cluster.EdgesBuilt[Portal])
+        {
+            return Cluster.Edges[Portal];
+        }
+
+        // 一次局部搜索得到到区块内其余入口的代价；已构建的入口直接复用其反向边
+        Cluster.EdgesBuilt[Portal] = 1;
+        std::vector<FIntVec3> Targets;
+        for (int32_t Other = 0; Other < (int32_t)Cluster.Portals.size(); ++Other)
+        {
+            if (Other != Portal && !Cluster.EdgesBuilt[Other])
+            {
+                Targets.push_back(Cluster.Portals[Other]);
+            }
+        }
+        for (int32_t Other = 0; Other < (int32_t)Cluster.Portals.size(); ++Other)
+        {
+            if (Other == Portal || !Cluster.EdgesBuilt[Other])
+            {
+                continue;
+            }
+            for (const FPortalEdge& Edge : Cluster.Edges[Other])
+            {
+                if (Edge.To == Portal)
+                {
+                    Cluster.Edges[Portal].push_back({ Other, Edge.Cost });
+                }
+            }
+        }
+        if (!Targets.empty())
+        {
+            RunLocalSearch(Grid, GetClusterBounds(GetClusterCoordFromIndex(ClusterIndex)), Cluster.Portals[Portal], Targets);
+            for (int32_t Other = 0; Other < (int32_t)Cluster.Portals.size(); ++Other)
+            {
+                if (Other != Portal && !Cluster.EdgesBuilt[Other] && GetLocalCost(Cluster.Portals[Other]) != HPA_INFINITY)
+                {
+                    Cluster.Edges[Portal].push_back({ Other, GetLocalCost(Cluster.Portals[Other]) });
+                }
+            }
+        }
+        return Cluster.Edges[Portal];
+    }
+
+    int32_t FHierarchicalPlanner::GetLocalIndex(const FIntVec3& Cell) const
+    {
+        const int32_t SizeX = LocalBounds.Max.X - LocalBounds.Min.X + 1;
+        const int32_t SizeY = LocalBounds.Max.Y - LocalBounds.Min.Y + 1;
+        return ((Cell.Z - LocalBounds.Min.Z) * SizeY + (Cell.Y - LocalBounds.Min.Y)) * SizeX + (Cell.X - LocalBounds.Min.X);
+    }
+
+    void FHierarchicalPlanner::RunLocalSearch(const FOccupancyGrid& Grid, const FCellBounds& Bounds, const FIntVec3& From, const std::vector<FIntVec3>& Targets)
+    {
+        LocalBounds = Bounds;
+        const int32_t SizeX = Bounds.Max.X - Bounds.Min.X + 1;
+        const int32_t SizeY = Bounds.Max.Y - Bounds.Min.Y + 1;
+        const int32_t SizeZ = Bounds.Max.Z - Bounds.Min.Z + 1;
+        LocalCost.assign((size_t)SizeX * SizeY * SizeZ, HPA_INFINITY);
+        LocalParent.assign(LocalCost.size(), -1);
+        LocalFlags.assign(LocalCost.size(), 0);
+        LocalHeap.clear();
+
+        float StepCosts[26];
+        for (int32_t Direction = 0; Direction < 26; ++Direction)
+        {
+            StepCosts[Direction] = GridDirections[Direction].Length * GridResolution;
+        }
+
+        // 目标全部出堆后提前结束；Targets为空时搜索整个区块。只有一个目标时加上对角距离启发（A*）
+        constexpr uint8_t TargetFlag = 1;
+        constexpr uint8_t ClosedFlag = 2;
+        int32_t Remaining = 0;
+        for (const FIntVec3& Target : Targets)
+        {
+            if (Bounds.Contains(Target) && !(LocalFlags[GetLocalIndex(Target)] & TargetFlag))
+            {
+                LocalFlags[GetLocalIndex(Target)] |= TargetFlag;
+                Remaining++;
+            }
+        }
+        const bool bStopAtTargets = !Targets.empty();
+        const bool bUseHeuristic = Targets.size() == 1;
+        auto Heuristic = [&](const FIntVec3& Cell)
+        {
+            return bUseHeuristic ? FAStarPlanner::GetDiagonalHeuristic(GridResolution, Cell.X, Cell.Y, Cell.Z, Targets[0].X, Targets[0].Y, Targets[0].Z) : 0.0f;
+        };
+
+        const std::greater<std::pair<float, int32_t>> HeapOrder;
+        const int32_t FromIndex = GetLocalIndex(From);
+        LocalCost[FromIndex] = 0.0f;
+        LocalHeap.emplace_back(Heuristic(From), FromIndex);
+        while (!LocalHeap.empty())
+        {
+            std::pop_heap(LocalHeap.begin(), LocalHeap.end(), HeapOrder);
+            const int32_t Index = LocalHeap.back().second;
+            LocalHeap.pop_back();
+            if (LocalFlags[Index] & ClosedFlag)
+            {
+                continue;
+            }
+            LocalFlags[Index] |= ClosedFlag;
+            LastStats.Expansions++;
+
+            if (bStopAtTargets && (LocalFlags[Index] & TargetFlag) && --Remaining <= 0)
+            {
+                break;
+            }
+
+            const FIntVec3 Cell(Bounds.Min.X + Index % SizeX, Bounds.Min.Y + (Index / SizeX) % SizeY, Bounds.Min.Z + Index / (SizeX * SizeY));
+            for (int32_t Direction = 0; Direction < 26; ++Direction)
+            {
+                const FGridDirection& D = GridDirections[Direction];
+                const FIntVec3 Next(Cell.X + D.X, Cell.Y + D.Y, Cell.Z + D.Z);
+                if (!Bounds.Contains(Next) || Grid.IsOccupiedCell(Next.X, Next.Y, Next.Z))
+                {
+                    continue;
+                }
+                const int32_t NextIndex = GetLocalIndex(Next);
+                const float NextCost = LocalCost[Index] + StepCosts[Direction];
+                if (NextCost < LocalCost[NextIndex] && !(LocalFlags[NextIndex] & ClosedFlag))
+                {
+                    LocalCost[NextIndex] = NextCost;
+                    LocalParent[NextIndex] = Index;
+                    LocalHeap.emplace_back(NextCost + Heuristic(Next), NextIndex);
+                    std::push_heap(LocalHeap.begin(), LocalHeap.end(), HeapOrder);
+                }
+            }
+        }
+    }
+
+    bool FHierarchicalPlanner::AppendLocalPath(const FOccupancyGrid& Grid, const FCellBounds& Bounds, const FIntVec3& From, const FIntVec3& To, std::vector<FIntVec3>& OutCells)
+    {
+        if (From == To)
+        {
+            return true;
+        }
+        RunLocalSearch(Grid, Bounds, From, std::vector<FIntVec3>(1, To));
+        if (GetLocalCost(To) == HPA_INFINITY)
+        {
+            return false;
+        }
+
+        const int32_t SizeX = Bounds.Max.X - Bounds.Min.X + 1;
+        const int32_t SizeY = Bounds.Max.Y - Bounds.Min.Y + 1;
+        const size_t FirstNew = OutCells.size();
+        const int32_t FromIndex = GetLocalIndex(From);
+        for (int32_t Index = GetLocalIndex(To); Index != FromIndex; Index = LocalParent[Index])
+        {
+            OutCells.push_back(FIntVec3(Bounds.Min.X + Index % SizeX, Bounds.Min.Y + (Index / SizeX) % SizeY, Bounds.Min.Z + Index / (SizeX * SizeY)));
+        }
+        std::reverse(OutCells.begin() + FirstNew, OutCells.end());
+        return true;
+    }
+
+    EPlanStatus FHierarchicalPlanner::Plan(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& Goal, std::vector<FVec3>& OutPath)
+    {
+        OutPath.clear();
+        LastStats = FSearchStats();
+
+        int32_t StartX, StartY, StartZ;
+        int32_t GoalX, GoalY, GoalZ;
+        if (!Grid.WorldToGrid(Start, StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOutsideGrid;
+        }
+        if (!Grid.WorldToGrid(Goal, GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOutsideGrid;
+        }
+        if (Grid.IsOccupiedCell(StartX, StartY, StartZ))
+        {
+            return EPlanStatus::StartOccupied;
+        }
+        if (Grid.IsOccupiedCell(GoalX, GoalY, GoalZ))
+        {
+            return EPlanStatus::GoalOccupied;
+        }
+        if (!bInitialized || !MatchesGrid(Grid))
+        {
+            Initialize(Grid);
+        }
+
+        const FIntVec3 StartCell(StartX, StartY, StartZ);
+        const FIntVec3 GoalCell(GoalX, GoalY, GoalZ);
+        const int64_t StartCluster = GetClusterIndex(GetClusterCoord(StartCell));
+        const int64_t GoalCluster = GetClusterIndex(GetClusterCoord(GoalCell));
+        const FCellBounds StartBounds = GetClusterBounds(GetClusterCoord(StartCell));
+        const FCellBounds GoalBounds = GetClusterBounds(GetClusterCoord(GoalCell));
+
+        // 起点、终点临时接入所在区块的入口
+        std::vector<float> StartCosts;
+        std::vector<float> GoalCosts;
+        float DirectCost = HPA_INFINITY;
+        {
+            std::vector<FIntVec3> Targets = GetCluster(Grid, StartCluster).Portals;
+            if (StartCluster == GoalCluster)
+            {
+                Targets.push_back(GoalCell);
+            }
+            RunLocalSearch(Grid, StartBounds, StartCell, Targets);
+            for (const FIntVec3& Portal : GetCluster(Grid, StartCluster).Portals)
+            {
+                StartCosts.push_back(GetLocalCost(Portal));
+            }
+            if (StartCluster == GoalCluster)
+            {
+                DirectCost = GetLocalCost(GoalCell);
+            }
+
+            const std::vector<FIntVec3>& GoalPortals = GetCluster(Grid, GoalCluster).Portals;
+            RunLocalSearch(Grid, GoalBounds, GoalCell, GoalPortals);
+            for (const FIntVec3& Portal : GoalPortals)
+            {
+                GoalCosts.push_back(GetLocalCost(Portal));
+            }
+        }
+
+        // 入口图上的A*
+        std::unordered_map<int64_t, FAbstractNode> Nodes;
+        std::vector<std::pair<float, int64_t>> Open;
+        const std::greater<std::pair<float, int64_t>> OpenOrder;
+        auto Heuristic = [&](const FIntVec3& Cell)
+        {
+            return FAStarPlanner::GetDiagonalHeuristic(GridResolution, Cell.X, Cell.Y, Cell.Z, GoalX, GoalY, GoalZ);
+        };
+        auto Relax = [&](int64_t Key, const FIntVec3& Cell, float G, int64_t Parent)
+        {
+            FAbstractNode& Node = Nodes[Key];
+            if (Node.bClosed || G >= Node.G)
+            {
+                return;
+            }
+            Node.Cell = Cell;
+            Node.G = G;
+            Node.Parent = Parent;
+            Open.emplace_back(G + Heuristic(Cell), Key);
+            std::push_heap(Open.begin(), Open.end(), OpenOrder);
+        };
+
+        Relax(HPA_START_KEY, StartCell, 0.0f, HPA_START_KEY);
+        FSearchDeadline Deadline(Config.MaxSearchMicros);
+        int32_t Steps = 0;
+        bool bFound = false;
+        while (!Open.empty())
+        {
+            std::pop_heap(Open.begin(), Open.end(), OpenOrder);
+            const int64_t Key = Open.back().second;
+            Open.pop_back();
+            FAbstractNode& Current = Nodes[Key];
+            if (Current.bClosed)
+            {
+                continue;
+            }
+            Current.bClosed = true;
+            if (Key == HPA_GOAL_KEY)
+            {
+                bFound = true;
+                break;
+            }
+
+            if (Config.CancelFlag && Config.CancelFlag->load(std::memory_order_relaxed))
+            {
+                return EPlanStatus::Cancelled;
+            }
+            if (Deadline.IsExpired())
+            {
+                return EPlanStatus::TimeLimit;
+            }
+            if (++Steps > Config.MaxSearchSteps)
+            {
+                return EPlanStatus::StepLimit;
+            }
+            LastStats.Expansions++;
+
+            const FIntVec3 CurrentCell = Current.Cell;
+            const float CurrentG = Current.G;
+            if (Key == HPA_START_KEY)
+            {
+                const FCluster& Cluster = GetCluster(Grid, StartCluster);
+                for (int32_t Portal = 0; Portal < (int32_t)Cluster.Portals.size(); ++Portal)
+                {
+                    if (StartCosts[Portal] != HPA_INFINITY)
+                    {
+                        Relax((StartCluster << HPA_PORTAL_BITS) | Portal, Cluster.Portals[Portal], StartCosts[Portal], Key);
+                    }
+                }
+                if (DirectCost != HPA_INFINITY)
+                {
+                    Relax(HPA_GOAL_KEY, GoalCell, DirectCost, Key);
+                }
+                continue;
+            }
+
+            const int64_t ClusterIndex = Key >> HPA_PORTAL_BITS;
+            const int32_t PortalIndex = (int32_t)(Key & ((1 << HPA_PORTAL_BITS) - 1));
+            const FCluster& Cluster = GetCluster(Grid, ClusterIndex);
+            for (const FPortalEdge& Edge : GetPortalEdges(Grid, ClusterIndex, PortalIndex))
+            {
+                Relax((ClusterIndex << HPA_PORTAL_BITS) | Edge.To, Cluster.Portals[Edge.To], CurrentG + Edge.Cost, Key);
+            }
+            if (ClusterIndex == GoalCluster && GoalCosts[PortalIndex] != HPA_INFINITY)
+            {
+                Relax(HPA_GOAL_KEY, GoalCell, CurrentG + GoalCosts[PortalIndex], Key);
+            }
+
+            // 穿过入口面到相邻区块中对应的入口
+            const FIntVec3 Coord = GetClusterCoordFromIndex(ClusterIndex);
+            const FCellBounds Bounds = GetClusterBounds(Coord);
+            for (int32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                for (int32_t Delta = -1; Delta <= 1; Delta += 2)
+                {
+                    const int32_t Boundary = GetAxis(Delta > 0 ? Bounds.Max : Bounds.Min, Axis);
+                    const int32_t NeighborCoord = GetAxis(Coord, Axis) + Delta;
+                    if (GetAxis(CurrentCell, Axis) != Boundary || NeighborCoord < 0 || NeighborCoord >= NumClusters[Axis])
+                    {
+                        continue;
+                    }
+                    const FIntVec3 LowerCluster = Delta > 0 ? Coord : OffsetAlong(Coord, Axis, -1);
+                    const FIntVec3 LowerCell = Delta > 0 ? CurrentCell : OffsetAlong(CurrentCell, Axis, -1);
+                    const std::vector<FIntVec3>& Face = GetFace(Grid, LowerCluster, Axis);
+                    if (std::find(Face.begin(), Face.end(), LowerCell) == Face.end())
+                    {
+                        continue;
+                    }
+
+                    const FIntVec3 PartnerCell = OffsetAlong(CurrentCell, Axis, Delta);
+                    const int64_t PartnerCluster = GetClusterIndex(OffsetAlong(Coord, Axis, Delta));
+                    const std::vector<FIntVec3>& PartnerPortals = GetCluster(Grid, PartnerCluster).Portals;
+                    const auto Partner = std::lower_bound(PartnerPortals.begin(), PartnerPortals.end(), PartnerCell, CellLess);
+                    if (Partner != PartnerPortals.end() && *Partner == PartnerCell)
+                    {
+                        Relax((PartnerCluster << HPA_PORTAL_BITS) | (int64_t)(Partner - PartnerPortals.begin()),
+                            PartnerCell, CurrentG + GridResolution, Key);
+                    }
+                }
+            }
+        }
+        if (!bFound)
+        {
+            return EPlanStatus::NoPath;
+        }
+        LastStats.PathCost = Nodes[HPA_GOAL_KEY].G;
+
+        // 细化：同一区块内的相邻入口之间做局部搜索，跨区块的入口之间只有一步
+        std::vector<int64_t> AbstractPath;
+        for (int64_t Key = HPA_GOAL_KEY; Key != HPA_START_KEY; Key = Nodes[Key].Parent)
+        {
+            AbstractPath.push_back(Key);
+        }
+        AbstractPath.push_back(HPA_START_KEY);
+        std::reverse(AbstractPath.begin(), AbstractPath.end());
+
+        std::vector<FIntVec3> Cells;
+        for (size_t i = 1; i < AbstractPath.size(); ++i)
+        {
+            const FIntVec3& From = Nodes[AbstractPath[i - 1]].Cell;
+            const FIntVec3& To = Nodes[AbstractPath[i]].Cell;
+            const FIntVec3 FromCluster = GetClusterCoord(From);
+            if (FromCluster == GetClusterCoord(To))
+            {
+                if (!AppendLocalPath(Grid, GetClusterBounds(FromCluster), From, To, Cells))
+                {
+                    return EPlanStatus::NoPath;
+                }
+            }
+            else
+            {
+                Cells.push_back(To);
+            }
+        }
+
+        OutPath.push_back(Start);
+        for (const FIntVec3& Cell : Cells)
+        {
+            OutPath.push_back(Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z));
+        }
+        if (OutPath.size() > 1)
+        {
+            OutPath.back() = Goal;
+        }
+        else
+        {
+            OutPath.push_back(Goal);
+        }
+        return EPlanStatus::Success;
+    }
+
+    void FHierarchicalPlanner::NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed)
+    {
+        if (!bInitialized || Changed.IsEmpty())
+        {
+            return;
+        }
+        if (!MatchesGrid(Grid))
+        {
+            Reset();
+            return;
+        }
+
+        const FCellBounds WholeMap = Grid.GetBounds();
+        const FCellBounds Clamped(
+            FIntVec3(std::max(Changed.Min.X, WholeMap.Min.X), std::max(Changed.Min.Y, WholeMap.Min.Y), std::max(Changed.Min.Z, WholeMap.Min.Z)),
+            FIntVec3(std::min(Changed.Max.X, WholeMap.Max.X), std::min(Changed.Max.Y, WholeMap.Max.Y), std::min(Changed.Max.Z, WholeMap.Max.Z)));
+        if (Clamped.IsEmpty())
+        {
+            return;
+        }
+
+        // 变化区块及其相邻区块的入口集合改变；入口面只涉及下侧区块在[Min-1, Max]内的面
+        const FIntVec3 MinCluster = GetClusterCoord(Clamped.Min);
+        const FIntVec3 MaxCluster = GetClusterCoord(Clamped.Max);
+        const FCellBounds StaleClusters(FIntVec3(MinCluster.X - 1, MinCluster.Y - 1, MinCluster.Z - 1), FIntVec3(MaxCluster.X + 1, MaxCluster.Y + 1, MaxCluster.Z + 1));
+        const FCellBounds StaleFaces(StaleClusters.Min, MaxCluster);
+        auto IsStaleCluster = [&](int64_t ClusterIndex)
+        {
+            const FIntVec3 Coord = GetClusterCoordFromIndex(ClusterIndex);
+            int32_t NumOutside = 0;
+            for (int32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                NumOutside += (GetAxis(Coord, Axis) < GetAxis(MinCluster, Axis) || GetAxis(Coord, Axis) > GetAxis(MaxCluster, Axis)) ? 1 : 0;
+            }
+            return StaleClusters.Contains(Coord) && NumOutside <= 1;
+        };
+
+        for (auto It = Clusters.begin(); It != Clusters.end();)
+        {
+            It = IsStaleCluster(It->first) ? Clusters.erase(It) : std::next(It);
+        }
+        for (auto It = Faces.begin(); It != Faces.end();)
+        {
+            It = StaleFaces.Contains(GetClusterCoordFromIndex(It->first / 3)) ? Faces.erase(It) : std::next(It);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+// HierarchicalPlanner.h
+// 分层寻路（HPA*）：栅格按固定边长划分为立方体区块，相邻区块共享面上的每个可通行连通区域放置入口（portal），
+// 区块内入口之间的代价由区块内的局部搜索得到。查询时先在入口图上搜索粗路径，再只在粗路径经过的区块内细化，
+// 耗时随路线长度而不是地图体积增长。区块在第一次被查询用到时才构建，地图变化后只丢弃受影响的区块
+#pragma once
+
+#include "AStarPlanner.h"
+#include "PlanningTypes.h"
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+
+    class FHierarchicalPlanner
+    {
+    public:
+        // 使用MaxSearchSteps（入口图上的扩展次数）、MaxSearchMicros与CancelFlag；不使用预约表
+        FPlannerConfig Config;
+
+        // 区块边长（格子数，限制在4~64）；修改后下一次Plan时丢弃已构建的区块
+        int32_t ClusterSize = 16;
+
+        // 从Start到Goal规划，路径由Start、逐格的格子中心与Goal组成。
+        // 区块内只在区块范围内搜索、跨区块只经过入口，代价略高于全局最优
+        EPlanStatus Plan(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& Goal, std::vector<FVec3>& OutPath);
+
+        // Changed范围内的格子占用发生了变化（Grid已是变化后的状态），丢弃涉及这些格子的区块与入口面
+        void NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed);
+
+        void Reset();
+
+        int32_t GetNumBuiltClusters() const { return (int32_t)Clusters.size(); }
+
+        // Expansions为入口图与区块内局部搜索的扩展次数之和，GeneratedNodes为本次Plan新构建的区块数
+        const FSearchStats& GetLastStats() const { return LastStats; }
+
+    private:
+        struct FPortalEdge
+        {
+            int32_t To = 0;
+            float Cost = 0.0f;
+        };
+
+        struct FCluster
+        {
+            // 区块内的入口格子，及入口之间在区块内的最短代价（入口第一次被扩展时才计算）
+            std::vector<FIntVec3> Portals;
+            std::vector<std::vector<FPortalEdge>> Edges;
+            std::vector<uint8_t> EdgesBuilt;
+        };
+
+        bool bInitialized = false;
+        FVec3 GridOrigin;
+        float GridResolution = 0.0f;
+        int32_t GridDims[3] = { 0, 0, 0 };
+        int32_t BuiltClusterSize = 0;
+        int32_t NumClusters[3] = { 0, 0, 0 };
+
+        // 键为 下侧区块索引 * 3 + 轴：该面上入口在下侧区块中的格子（另一侧为沿轴+1的格子）
+        std::unordered_map<int64_t, std::vector<FIntVec3>> Faces;
+        std::unordered_map<int64_t, FCluster> Clusters;
+
+        FSearchStats LastStats;
+
+        // 区块内局部搜索（Dijkstra，单一目标时为A*）复用的数组，按区块包围盒内的局部索引
+        FCellBounds LocalBounds;
+        std::vector<float> LocalCost;
+        std::vector<int32_t> LocalParent;
+        std::vector<uint8_t> LocalFlags;
+        std::vector<std::pair<float, int32_t>> LocalHeap;
+
+        bool MatchesGrid(const FOccupancyGrid& Grid) const;
+        void Initialize(const FOccupancyGrid& Grid);
+
+        FIntVec3 GetClusterCoord(const FIntVec3& Cell) const;
+        int64_t GetClusterIndex(const FIntVec3& ClusterCoord) const;
+        FIntVec3 GetClusterCoordFromIndex(int64_t ClusterIndex) const;
+        FCellBounds GetClusterBounds(const FIntVec3& ClusterCoord) const;
+
+        const std::vector<FIntVec3>& GetFace(const FOccupancyGrid& Grid, const FIntVec3& LowerCluster, int32_t Axis);
+        const FCluster& GetCluster(const FOccupancyGrid& Grid, int64_t ClusterIndex);
+        const std::vector<FPortalEdge>& GetPortalEdges(const FOccupancyGrid& Grid, int64_t ClusterIndex, int32_t Portal);
+
+        // 从From出发在Bounds内搜索，直到Targets全部确定代价或搜索结束；结果留在LocalCost/LocalParent中
+        void RunLocalSearch(const FOccupancyGrid& Grid, const FCellBounds& Bounds, const FIntVec3& From, const std::vector<FIntVec3>& Targets);
+        int32_t GetLocalIndex(const FIntVec3& Cell) const;
+        float GetLocalCost(const FIntVec3& Cell) const { return LocalCost[GetLocalIndex(Cell)]; }
+
+        // 在Bounds内从From到To的逐格路径（不含From），追加到OutCells
+        bool AppendLocalPath(const FOccupancyGrid& Grid, const FCellBounds& Bounds, const FIntVec3& From, const FIntVec3& To, std::vector<FIntVec3>& OutCells);
+    };
+}
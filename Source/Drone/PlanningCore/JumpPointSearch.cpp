@@ -0,0 +1,339 @@
+// JumpPointSearch.cpp
+#include "JumpPointSearch.h"
+#include "AStarPlanner.h"
+#include "OccupancyGrid.h"
+#include "ReservationTable.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        // 方向编号 = (DX+1) + 3*(DY+1) + 9*(DZ+1)，13为零向量
+        constexpr int32_t NUM_DIRECTION_SLOTS = 27;
+        constexpr int32_t ZERO_DIRECTION = 13;
+
+        int32_t DirectionIndex(int32_t DX, int32_t DY, int32_t DZ)
+        {
+            return (DX + 1) + 3 * (DY + 1) + 9 * (DZ + 1);
+        }
+
+        int32_t Sign(int32_t Value)
+        {
+            return (Value > 0) - (Value < 0);
+        }
+
+        // 每个方向的后继规则，首次使用时生成
+        struct FJumpTables
+        {
+            FIntVec3 Offsets[NUM_DIRECTION_SLOTS];
+            float StepLengths[NUM_DIRECTION_SLOTS] = {};
+
+            // 无障碍物时保留的自然后继（d的分量子方向，含d本身）
+            uint32_t NaturalDirections[NUM_DIRECTION_SLOTS] = {};
+
+            // 对角方向的真子方向，沿对角跳跃时每一步都要先沿它们跳跃
+            int32_t SubDirections[NUM_DIRECTION_SLOTS][6] = {};
+            int32_t NumSubDirections[NUM_DIRECTION_SLOTS] = {};
+
+            // 可能成为强迫邻居的方向e，及父格子到x+e的规范路径经过的中间格子（位掩码）
+            int32_t ForcedCandidates[NUM_DIRECTION_SLOTS][26] = {};
+            uint32_t ForcedPaths[NUM_DIRECTION_SLOTS][26] = {};
+            int32_t NumForcedCandidates[NUM_DIRECTION_SLOTS] = {};
+
+            // 所有规范路径中间格子的并集（按方向编号的位掩码）：跳跃时只需检查这些格子的占用
+            uint32_t WatchedCells[NUM_DIRECTION_SLOTS] = {};
+
+            // 全部强迫邻居候选格子，只在WatchedCells中有障碍时才需要读取
+            uint32_t CandidateCells[NUM_DIRECTION_SLOTS] = {};
+
+            // 沿方向跳跃时每一步要读取的邻域格子：WatchedCells加上自然后继（含下一格与各子方向的第一格）
+            uint32_t ScanCells[NUM_DIRECTION_SLOTS] = {};
+
+            FJumpTables()
+            {
+                for (int32_t Index = 0; Index < NUM_DIRECTION_SLOTS; ++Index)
+                {
+                    Offsets[Index] = FIntVec3(Index % 3 - 1, (Index / 3) % 3 - 1, Index / 9 - 1);
+                    const FIntVec3& D = Offsets[Index];
+                    StepLengths[Index] = std::sqrt((float)(D.X * D.X + D.Y * D.Y + D.Z * D.Z));
+                }
+
+                for (int32_t Dir = 0; Dir < NUM_DIRECTION_SLOTS; ++Dir)
+                {
+                    if (Dir == ZERO_DIRECTION)
+                    {
+                        continue;
+                    }
+                    const FIntVec3& D = Offsets[Dir];
+                    uint32_t Watched = 0;
+
+                    for (int32_t Next = 0; Next < NUM_DIRECTION_SLOTS; ++Next)
+                    {
+                        const FIntVec3& E = Offsets[Next];
+                        if (Next == ZERO_DIRECTION || Next == DirectionIndex(-D.X, -D.Y, -D.Z))
+                        {
+                            continue;
+                        }
+
+                        const bool bSubset = (E.X == 0 || E.X == D.X) && (E.Y == 0 || E.Y == D.Y) && (E.Z == 0 || E.Z == D.Z);
+                        if (bSubset)
+                        {
+                            NaturalDirections[Dir] |= 1u << Next;
+                            if (Next != Dir)
+                            {
+                                SubDirections[Dir][NumSubDirections[Dir]++] = Next;
+                            }
+                            continue;
+                        }
+
+                        // 父格子(-D)到E的规范路径：每一步在所有剩余分量上同时移动（对角优先）
+                        uint32_t PathMask = 0;
+                        FIntVec3 Cell(-D.X, -D.Y, -D.Z);
+                        FIntVec3 Delta(E.X + D.X, E.Y + D.Y, E.Z + D.Z);
+                        while (true)
+                        {
+                            const FIntVec3 Step(Sign(Delta.X), Sign(Delta.Y), Sign(Delta.Z));
+                            Cell = FIntVec3(Cell.X + Step.X, Cell.Y + Step.Y, Cell.Z + Step.Z);
+                            Delta = FIntVec3(Delta.X - Step.X, Delta.Y - Step.Y, Delta.Z - Step.Z);
+                            if (Delta.X == 0 && Delta.Y == 0 && Delta.Z == 0)
+                            {
+                                break;
+                            }
+                            PathMask |= 1u << DirectionIndex(Cell.X, Cell.Y, Cell.Z);
+                        }
+
+                        // 规范路径与父格子直接相邻时该邻居总是可以被剪掉
+                        if (PathMask != 0)
+                        {
+                            const int32_t Slot = NumForcedCandidates[Dir]++;
+                            ForcedCandidates[Dir][Slot] = Next;
+                            ForcedPaths[Dir][Slot] = PathMask;
+                            Watched |= PathMask;
+                            CandidateCells[Dir] |= 1u << Next;
+                        }
+                    }
+
+                    WatchedCells[Dir] = Watched;
+                    ScanCells[Dir] = Watched | NaturalDirections[Dir];
+                }
+            }
+        };
+
+        const FJumpTables& GetJumpTables()
+        {
+            static const FJumpTables Tables;
+            return Tables;
+        }
+    }
+
+    FJumpPointSearch::FJumpPointSearch(const FOccupancyGrid& InGrid, const FReservationTable* InReservations,
+        const FPlanRequest& InRequest, float InDroneSpeed, const FIntVec3& InGoal)
+        : Grid(InGrid),
+          Reservations(InReservations && InReservations->Num() > 0 ? InReservations : nullptr),
+          Request(InRequest),
+          DroneSpeed(InDroneSpeed),
+          Goal(InGoal),
+          bReadCandidatesWithScan(!InGrid.IsSparse())
+    {
+    }
+
+    uint32_t FJumpPointSearch::GetScanCells(int32_t Direction) const
+    {
+        const FJumpTables& Tables = GetJumpTables();
+        return bReadCandidatesWithScan ? Tables.ScanCells[Direction] | Tables.CandidateCells[Direction] : Tables.ScanCells[Direction];
+    }
+
+    bool FJumpPointSearch::IsNearGoal(const FIntVec3& Cell) const
+    {
+        const int32_t DX = Cell.X - Goal.X;
+        const int32_t DY = Cell.Y - Goal.Y;
+        const int32_t DZ = Cell.Z - Goal.Z;
+        return DX * DX + DY * DY + DZ * DZ <= 1;
+    }
+
+    uint32_t FJumpPointSearch::GetForcedDirections(const FIntVec3& Cell, uint32_t Neighbourhood, uint32_t KnownCells,
+        int32_t Direction) const
+    {
+        const FJumpTables& Tables = GetJumpTables();
+
+        const uint32_t BlockedCells = Neighbourhood & Tables.WatchedCells[Direction];
+        if (BlockedCells == 0)
+        {
+            return 0;
+        }
+
+        // 有障碍时才补读尚未读取的候选格子
+        const uint32_t MissingCells = Tables.CandidateCells[Direction] & ~KnownCells;
+        if (MissingCells != 0)
+        {
+            Neighbourhood |= Grid.GetNeighbourhoodMask(Cell.X, Cell.Y, Cell.Z, MissingCells);
+        }
+
+        uint32_t Forced = 0;
+        for (int32_t i = 0; i < Tables.NumForcedCandidates[Direction]; ++i)
+        {
+            const int32_t Candidate = Tables.ForcedCandidates[Direction][i];
+            if ((Tables.ForcedPaths[Direction][i] & BlockedCells) && !(Neighbourhood & (1u << Candidate)))
+            {
+                Forced |= 1u << Candidate;
+            }
+        }
+        return Forced;
+    }
+
+    bool FJumpPointSearch::Jump(const FIntVec3& From, uint32_t FromNeighbourhood, int32_t Direction, float FromG,
+        FJumpSuccessor& OutSuccessor)
+    {
+        const FJumpTables& Tables = GetJumpTables();
+        const FIntVec3& Step = Tables.Offsets[Direction];
+        const float StepCost = Tables.StepLengths[Direction] * Grid.GetResolution();
+        const bool bDiagonal = Tables.NumSubDirections[Direction] > 0;
+        const uint32_t ScanCells = GetScanCells(Direction);
+
+        // 每一步只读一次当前格子邻域中用得到的格子：下一格是否可走与强迫邻居都由它判断
+        FIntVec3 Cell = From;
+        uint32_t Neighbourhood = FromNeighbourhood;
+        float Travelled = 0.0f;
+        for (int32_t StepIndex = 0; ; ++StepIndex)
+        {
+            const FIntVec3 Next(Cell.X + Step.X, Cell.Y + Step.Y, Cell.Z + Step.Z);
+            if (Neighbourhood & (1u << Direction))
+            {
+                return false;
+            }
+
+            const float NextTravelled = Travelled + StepCost;
+
+            // 与A*相同的时空冲突检测；冲突处截断跳跃，由截断点向全部方向绕行
+            if (Reservations)
+            {
+                const float DepartTime = Request.StartTime + FromG / DroneSpeed + Travelled / DroneSpeed;
+                const float AbsTime = Request.StartTime + FromG / DroneSpeed + NextTravelled / DroneSpeed;
+                if (Reservations->IsSegmentConflict(Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z), DepartTime,
+                    Grid.GridToWorld(Next.X, Next.Y, Next.Z), AbsTime, Request.DroneID))
+                {
+                    if (StepIndex == 0)
+                    {
+                        return false;
+                    }
+                    OutSuccessor.Cell = Cell;
+                    OutSuccessor.Cost = Travelled;
+                    OutSuccessor.bExpandAllDirections = true;
+                    return true;
+                }
+            }
+
+            Cell = Next;
+            Neighbourhood = Grid.GetNeighbourhoodMask(Cell.X, Cell.Y, Cell.Z, ScanCells);
+            Travelled = NextTravelled;
+
+            bool bJumpPoint = IsNearGoal(Cell) || GetForcedDirections(Cell, Neighbourhood, ScanCells, Direction) != 0;
+            for (int32_t i = 0; !bJumpPoint && bDiagonal && i < Tables.NumSubDirections[Direction]; ++i)
+            {
+                bJumpPoint = HasJumpPoint(Cell, Neighbourhood, Tables.SubDirections[Direction][i]);
+            }
+            if (bJumpPoint)
+            {
+                OutSuccessor.Cell = Cell;
+                OutSuccessor.Cost = Travelled;
+                OutSuccessor.bExpandAllDirections = false;
+                return true;
+            }
+        }
+    }
+
+    bool FJumpPointSearch::HasJumpPoint(const FIntVec3& From, uint32_t FromNeighbourhood, int32_t Direction)
+    {
+        const FJumpTables& Tables = GetJumpTables();
+        const FIntVec3& Step = Tables.Offsets[Direction];
+        const bool bDiagonal = Tables.NumSubDirections[Direction] > 0;
+        const uint32_t ScanCells = GetScanCells(Direction);
+
+        FIntVec3 Cell = From;
+        uint32_t Neighbourhood = FromNeighbourhood;
+        while (true)
+        {
+            if (Neighbourhood & (1u << Direction))
+            {
+                return false;
+            }
+            Cell = FIntVec3(Cell.X + Step.X, Cell.Y + Step.Y, Cell.Z + Step.Z);
+            Neighbourhood = Grid.GetNeighbourhoodMask(Cell.X, Cell.Y, Cell.Z, ScanCells);
+
+            if (IsNearGoal(Cell) || GetForcedDirections(Cell, Neighbourhood, ScanCells, Direction) != 0)
+            {
+                return true;
+            }
+            for (int32_t i = 0; bDiagonal && i < Tables.NumSubDirections[Direction]; ++i)
+            {
+                if (HasJumpPoint(Cell, Neighbourhood, Tables.SubDirections[Direction][i]))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    int32_t FJumpPointSearch::GetSuccessors(const FAStarNode& Node, FJumpSuccessor (&OutSuccessors)[26])
+    {
+        const FJumpTables& Tables = GetJumpTables();
+        const FIntVec3 Cell(Node.GridX, Node.GridY, Node.GridZ);
+        // 扩展节点时读取完整邻域：起点要检查全部邻居，跳跃的第一步也直接用它判断
+        const uint32_t AllCells = (1u << NUM_DIRECTION_SLOTS) - 1;
+        const uint32_t Neighbourhood = Grid.GetNeighbourhoodMask(Cell.X, Cell.Y, Cell.Z, AllCells);
+
+        // 起点一般不在格子中心，到各邻居的代价不满足剪枝依赖的对称性：
+        // 只走一步，再把这些邻居当作各自的起点向全部方向跳跃
+        if (!Node.Parent)
+        {
+            int32_t NumSuccessors = 0;
+            for (int32_t Direction = 0; Direction < NUM_DIRECTION_SLOTS; ++Direction)
+            {
+                const FIntVec3& Step = Tables.Offsets[Direction];
+                const FIntVec3 Next(Cell.X + Step.X, Cell.Y + Step.Y, Cell.Z + Step.Z);
+                if (Direction == ZERO_DIRECTION || (Neighbourhood & (1u << Direction)))
+                {
+                    continue;
+                }
+                const FVec3 NextPosition = Grid.GridToWorld(Next.X, Next.Y, Next.Z);
+                const float Cost = (float)FVec3::Dist(Node.Position, NextPosition);
+                const float DepartTime = Request.StartTime + Node.GScore / DroneSpeed;
+                if (Reservations && Reservations->IsSegmentConflict(Node.Position, DepartTime,
+                    NextPosition, DepartTime + Cost / DroneSpeed, Request.DroneID))
+                {
+                    continue;
+                }
+                FJumpSuccessor& Successor = OutSuccessors[NumSuccessors++];
+                Successor.Cell = Next;
+                Successor.Cost = Cost;
+                Successor.bExpandAllDirections = true;
+            }
+            return NumSuccessors;
+        }
+
+        // 被截断的跳点没有剪枝依据，向全部方向跳跃
+        uint32_t Directions = ~(1u << ZERO_DIRECTION) & ((1u << NUM_DIRECTION_SLOTS) - 1);
+        if (!Node.bExpandAllDirections)
+        {
+            const int32_t Direction = DirectionIndex(
+                Sign(Node.GridX - Node.Parent->GridX), Sign(Node.GridY - Node.Parent->GridY), Sign(Node.GridZ - Node.Parent->GridZ));
+            Directions = Tables.NaturalDirections[Direction] | GetForcedDirections(Cell, Neighbourhood, AllCells, Direction);
+        }
+
+        int32_t NumSuccessors = 0;
+        for (int32_t Direction = 0; Direction < NUM_DIRECTION_SLOTS; ++Direction)
+        {
+            if (!(Directions & (1u << Direction)))
+            {
+                continue;
+            }
+            if (Jump(Cell, Neighbourhood, Direction, Node.GScore, OutSuccessors[NumSuccessors]))
+            {
+                NumSuccessors++;
+            }
+        }
+        return NumSuccessors;
+    }
+}
@@ -0,0 +1,64 @@
+// JumpPointSearch.h
+// 26邻域三维跳点搜索（JPS）的后继生成，由FAStarPlanner在ESearchMode::JumpPoint模式下使用。
+// 剪枝规则基于"对角优先"的规范路径顺序：沿方向d到达的格子只保留d的分量子方向（1/3/7个），
+// 以及规范绕行路径被障碍物挡住时的强迫邻居；沿途没有强迫邻居的格子被直接跳过，不进入开放堆
+#pragma once
+
+#include "PlanningTypes.h"
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+    class FReservationTable;
+    struct FAStarNode;
+    struct FPlanRequest;
+
+    struct FJumpSuccessor
+    {
+        FIntVec3 Cell;
+
+        // 从当前节点沿直线到跳点的代价（世界单位），与逐格累加的A*代价一致
+        float Cost = 0.0f;
+
+        // 跳跃被预约冲突截断，跳点需向全部方向扩展
+        bool bExpandAllDirections = false;
+    };
+
+    class FJumpPointSearch
+    {
+    public:
+        FJumpPointSearch(const FOccupancyGrid& InGrid, const FReservationTable* InReservations,
+            const FPlanRequest& InRequest, float InDroneSpeed, const FIntVec3& InGoal);
+
+        // Node的全部后继跳点（每个方向至多一个）
+        int32_t GetSuccessors(const FAStarNode& Node, FJumpSuccessor (&OutSuccessors)[26]);
+
+    private:
+        const FOccupancyGrid& Grid;
+        const FReservationTable* Reservations;
+        const FPlanRequest& Request;
+        float DroneSpeed;
+        FIntVec3 Goal;
+
+        // 稠密栅格整行读取邻域，强迫邻居候选格子随每一步一起读入没有额外开销；
+        // 稀疏栅格在砖块边界附近要逐格探测，候选格子只在有障碍时补读
+        bool bReadCandidatesWithScan = false;
+
+        // 沿Direction跳跃时每一步传给FOccupancyGrid::GetNeighbourhoodMask的格子
+        uint32_t GetScanCells(int32_t Direction) const;
+
+        // 距目标不超过1个格子（与A*的到达判定一致）
+        bool IsNearGoal(const FIntVec3& Cell) const;
+
+        // 沿Direction到达Cell时的强迫邻居方向（按方向编号的位掩码）；Neighbourhood为Cell的FOccupancyGrid::GetNeighbourhoodMask，
+        // 只包含KnownCells中的格子，缺少的候选格子在需要时补读
+        uint32_t GetForcedDirections(const FIntVec3& Cell, uint32_t Neighbourhood, uint32_t KnownCells, int32_t Direction) const;
+
+        // 从格子中心From（累计代价FromG）沿Direction跳跃；FromNeighbourhood至少包含Direction对应的邻居
+        bool Jump(const FIntVec3& From, uint32_t FromNeighbourhood, int32_t Direction, float FromG, FJumpSuccessor& OutSuccessor);
+
+        // 对角跳跃每一步沿子方向的探测：只判断是否存在跳点，不检查预约冲突
+        // （这些格子不会进入路径，真正经过时由Jump检查）
+        bool HasJumpPoint(const FIntVec3& From, uint32_t FromNeighbourhood, int32_t Direction);
+    };
+}
@@ -0,0 +1,560 @@
+// OccupancyGrid.cpp
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        const char GridFileMagic[8] = { 'D', 'P', 'G', 'R', 'I', 'D', '0', '1' };
+        const char SparseGridFileMagic[8] = { 'D', 'P', 'G', 'R', 'I', 'D', 'S', '1' };
+
+        // 表示[0, Count)所需的位数
+        int32_t BitsFor(int32_t Count)
+        {
+            int32_t NumBits = 1;
+            while ((int64_t(1) << NumBits) < Count)
+            {
+                NumBits++;
+            }
+            return NumBits;
+        }
+
+        // 文件头中每个维度的格子数上限，稠密栅格的格子总数上限（约1GB位图）
+        const double MaxFileGridDim = double(1 << 20);
+        const double MaxFileDenseCells = double(int64_t(1) << 33);
+
+        // 文件头：最小角点、尺寸、分辨率。分辨率须为正，尺寸须为正且格子数在上限内（NaN均不通过）
+        bool IsValidGridFileHeader(const double Header[7], bool bSparseFile)
+        {
+            for (int32_t i = 0; i < 7; ++i)
+            {
+                if (!std::isfinite(Header[i]))
+                {
+                    return false;
+                }
+            }
+            // Initialize按float分辨率计算维度
+            const float Resolution = (float)Header[6];
+            if (!(Resolution > 0.0f) || !std::isfinite(Resolution))
+            {
+                return false;
+            }
+            double NumCells = 1.0;
+            for (int32_t Axis = 3; Axis < 6; ++Axis)
+            {
+                const double Dim = std::ceil(Header[Axis] / Resolution);
+                if (!(Dim >= 1.0) || Dim > MaxFileGridDim)
+                {
+                    return false;
+                }
+                NumCells *= Dim;
+            }
+            return bSparseFile || NumCells <= MaxFileDenseCells;
+        }
+    }
+
+    void FOccupancyGrid::Initialize(const FVec3& MinCorner, const FVec3& InSize, float Resolution, bool bInSparse)
+    {
+        Origin = MinCorner;
+        Size = InSize;
+        CellSize = Resolution;
+        bSparse = bInSparse;
+
+        DimX = (int32_t)std::ceil(Size.X / CellSize);
+        DimY = (int32_t)std::ceil(Size.Y / CellSize);
+        DimZ = (int32_t)std::ceil(Size.Z / CellSize);
+
+        if (bSparse)
+        {
+            std::vector<uint64_t>().swap(Bits);
+            InitializeSparseTables();
+            return;
+        }
+
+        std::vector<int32_t>().swap(TileTable);
+        std::vector<int32_t>().swap(TileBricks);
+        std::vector<FBrick>().swap(Bricks);
+        const int64_t NumCells = (int64_t)DimX * DimY * DimZ;
+        Bits.assign((size_t)((NumCells + 63) / 64), 0);
+    }
+
+    void FOccupancyGrid::InitializeSparseTables()
+    {
+        const int32_t TileCells = 1 << TILE_SHIFT;
+        TilesX = (DimX + TileCells - 1) / TileCells;
+        TilesY = (DimY + TileCells - 1) / TileCells;
+        TilesZ = (DimZ + TileCells - 1) / TileCells;
+        TileTable.assign((size_t)TilesX * TilesY * TilesZ, -1);
+        std::vector<int32_t>().swap(TileBricks);
+        std::vector<FBrick>().swap(Bricks);
+
+        SparseShiftY = BitsFor(DimX);
+        SparseShiftZ = SparseShiftY + BitsFor(DimY);
+        SparseMaskX = (int64_t(1) << SparseShiftY) - 1;
+        SparseMaskY = (int64_t(1) << (SparseShiftZ - SparseShiftY)) - 1;
+    }
+
+    uint64_t* FOccupancyGrid::FindOrAddBrick(int32_t X, int32_t Y, int32_t Z)
+    {
+        int32_t& Tile = TileTable[((size_t)(Z >> TILE_SHIFT) * TilesY + (Y >> TILE_SHIFT)) * TilesX + (X >> TILE_SHIFT)];
+        if (Tile < 0)
+        {
+            Tile = (int32_t)(TileBricks.size() / BRICKS_PER_TILE);
+            TileBricks.resize(TileBricks.size() + BRICKS_PER_TILE, -1);
+        }
+
+        int32_t& Brick = TileBricks[((size_t)Tile << (BRICK_SHIFT * 3))
+            | (((Z >> BRICK_SHIFT) & BRICK_MASK) << (BRICK_SHIFT * 2))
+            | (((Y >> BRICK_SHIFT) & BRICK_MASK) << BRICK_SHIFT)
+            | ((X >> BRICK_SHIFT) & BRICK_MASK)];
+        if (Brick < 0)
+        {
+            Brick = (int32_t)Bricks.size();
+            Bricks.push_back(FBrick());
+        }
+        return Bricks[Brick].Words;
+    }
+
+    bool FOccupancyGrid::WorldToGrid(const FVec3& WorldPos, int32_t& GridX, int32_t& GridY, int32_t& GridZ) const
+    {
+        const FVec3 RelativePos = WorldPos - Origin;
+
+        GridX = (int32_t)std::floor(RelativePos.X / CellSize);
+        GridY = (int32_t)std::floor(RelativePos.Y / CellSize);
+        GridZ = (int32_t)std::floor(RelativePos.Z / CellSize);
+
+        return IsValidCell(GridX, GridY, GridZ);
+    }
+
+    FVec3 FOccupancyGrid::GridToWorld(int32_t GridX, int32_t GridY, int32_t GridZ) const
+    {
+        // 格子中心点
+        return FVec3(
+            Origin.X + (GridX + 0.5f) * CellSize,
+            Origin.Y + (GridY + 0.5f) * CellSize,
+            Origin.Z + (GridZ + 0.5f) * CellSize);
+    }
+
+    bool FOccupancyGrid::IsOccupied(const FVec3& WorldPos) const
+    {
+        int32_t GridX, GridY, GridZ;
+        if (WorldToGrid(WorldPos, GridX, GridY, GridZ))
+        {
+            return IsOccupiedIndex(GetCellIndex(GridX, GridY, GridZ));
+        }
+        return false;
+    }
+
+    uint32_t FOccupancyGrid::GetNeighbourhoodMaskSlow(int32_t X, int32_t Y, int32_t Z, uint32_t Wanted) const
+    {
+        uint32_t Mask = 0;
+        FIntVec3 CachedBrickCoord(-1, -1, -1);
+        int32_t CachedBrick = -1;
+        for (int32_t Bit = 0; Bit < 27; ++Bit)
+        {
+            if (!(Wanted & (1u << Bit)))
+            {
+                continue;
+            }
+            const int32_t NX = X + Bit % 3 - 1;
+            const int32_t NY = Y + (Bit / 3) % 3 - 1;
+            const int32_t NZ = Z + Bit / 9 - 1;
+            if (!IsValidCell(NX, NY, NZ))
+            {
+                Mask |= 1u << Bit;
+                continue;
+            }
+            if (!bSparse)
+            {
+                Mask |= (uint32_t)IsOccupiedDense(GetCellIndex(NX, NY, NZ)) << Bit;
+                continue;
+            }
+
+            // 邻域至多跨8个砖块，相邻的几位通常落在同一砖块内，沿用上一次查到的砖块
+            const FIntVec3 BrickCoord(NX >> BRICK_SHIFT, NY >> BRICK_SHIFT, NZ >> BRICK_SHIFT);
+            if (BrickCoord != CachedBrickCoord)
+            {
+                CachedBrickCoord = BrickCoord;
+                CachedBrick = GetBrickSlot(NX, NY, NZ);
+            }
+            if (CachedBrick >= 0 && ((Bricks[CachedBrick].Words[NZ & BRICK_MASK] >> BrickBit(NX, NY)) & 1ull))
+            {
+                Mask |= 1u << Bit;
+            }
+        }
+        return Mask;
+    }
+
+    bool FOccupancyGrid::MarkOccupied(const FVec3& WorldPos)
+    {
+        int32_t GridX, GridY, GridZ;
+        if (!WorldToGrid(WorldPos, GridX, GridY, GridZ))
+        {
+            return false;
+        }
+        SetOccupiedIndex(GetCellIndex(GridX, GridY, GridZ));
+        return true;
+    }
+
+    int32_t FOccupancyGrid::MarkOccupiedCells(const std::vector<FIntVec3>& Cells, FCellBounds& OutChanged)
+    {
+        int32_t NumChanged = 0;
+        for (const FIntVec3& Cell : Cells)
+        {
+            if (MarkOccupiedCell(Cell.X, Cell.Y, Cell.Z))
+            {
+                OutChanged.Add(Cell);
+                NumChanged++;
+            }
+        }
+        return NumChanged;
+    }
+
+    int32_t FOccupancyGrid::MarkOccupiedBox(const FCellBounds& Box, FCellBounds& OutChanged)
+    {
+        const FIntVec3 Min(std::max(Box.Min.X, 0), std::max(Box.Min.Y, 0), std::max(Box.Min.Z, 0));
+        const FIntVec3 Max(std::min(Box.Max.X, DimX - 1), std::min(Box.Max.Y, DimY - 1), std::min(Box.Max.Z, DimZ - 1));
+        int32_t NumChanged = 0;
+        for (int32_t Z = Min.Z; Z <= Max.Z; ++Z)
+        {
+            for (int32_t Y = Min.Y; Y <= Max.Y; ++Y)
+            {
+                for (int32_t X = Min.X; X <= Max.X; ++X)
+                {
+                    if (MarkOccupiedCell(X, Y, Z))
+                    {
+                        OutChanged.Add(FIntVec3(X, Y, Z));
+                        NumChanged++;
+                    }
+                }
+            }
+        }
+        return NumChanged;
+    }
+
+    FOccupancyGrid::FCylinderFootprint FOccupancyGrid::GetCylinderFootprint(const FVec3& Center, float Radius, float Height) const
+    {
+        const double BottomZ = Center.Z - Height / 2;
+        const double TopZ = Center.Z + Height / 2;
+
+        // 圆柱的最小外包盒
+        FCylinderFootprint Footprint;
+        WorldToGrid(FVec3(Center.X - Radius, Center.Y - Radius, BottomZ), Footprint.MinX, Footprint.MinY, Footprint.MinZ);
+        WorldToGrid(FVec3(Center.X + Radius, Center.Y + Radius, TopZ), Footprint.MaxX, Footprint.MaxY, Footprint.MaxZ);
+
+        Footprint.MinX = std::clamp(Footprint.MinX, 0, DimX - 1);
+        Footprint.MinY = std::clamp(Footprint.MinY, 0, DimY - 1);
+        Footprint.MinZ = std::clamp(Footprint.MinZ, 0, DimZ - 1);
+        Footprint.MaxX = std::clamp(Footprint.MaxX, 0, DimX - 1);
+        Footprint.MaxY = std::clamp(Footprint.MaxY, 0, DimY - 1);
+        Footprint.MaxZ = std::clamp(Footprint.MaxZ, 0, DimZ - 1);
+
+        // 圆心在XY平面的网格坐标
+        int32_t CenterGridZ;
+        WorldToGrid(Center, Footprint.CenterX, Footprint.CenterY, CenterGridZ);
+
+        Footprint.RadiusSquaredInCells = (Radius / CellSize) * (Radius / CellSize);
+        return Footprint;
+    }
+
+    const std::vector<FOccupancyGrid::FKernelColumn>& FOccupancyGrid::GetInflationKernel(float Radius)
+    {
+        if (Radius == InflationKernelRadius && CellSize == InflationKernelCellSize)
+        {
+            return InflationKernel;
+        }
+
+        InflationKernel.clear();
+        InflationKernelRadius = Radius;
+        InflationKernelCellSize = CellSize;
+
+        // 与格子中心距离不超过Radius的偏移；每列取满足条件的最大|dz|
+        const int32_t InflationCells = Radius > 0.0f ? (int32_t)std::ceil(Radius / CellSize) : 0;
+        for (int32_t dx = -InflationCells; dx <= InflationCells; dx++)
+        {
+            for (int32_t dy = -InflationCells; dy <= InflationCells; dy++)
+            {
+                int32_t HalfHeight = -1;
+                for (int32_t dz = 0; dz <= InflationCells; dz++)
+                {
+                    const float Distance = std::sqrt((float)(dx * dx + dy * dy + dz * dz)) * CellSize;
+                    if (Distance > Radius)
+                    {
+                        break;
+                    }
+                    HalfHeight = dz;
+                }
+                if (HalfHeight >= 0)
+                {
+                    InflationKernel.push_back({ dx, dy, HalfHeight });
+                }
+            }
+        }
+        return InflationKernel;
+    }
+
+    int32_t FOccupancyGrid::IntegrateHits(const std::vector<FVec3>& Hits, float InflationRadius, int32_t MaxHalfHeightCells, FCellBounds& OutChanged)
+    {
+        // 相邻射线的命中点大多落在同一格子里，先去重
+        std::vector<int64_t> HitCells;
+        HitCells.reserve(Hits.size());
+        for (const FVec3& Hit : Hits)
+        {
+            int32_t X, Y, Z;
+            if (WorldToGrid(Hit, X, Y, Z))
+            {
+                HitCells.push_back(GetCellIndex(X, Y, Z));
+            }
+        }
+        std::sort(HitCells.begin(), HitCells.end());
+        HitCells.erase(std::unique(HitCells.begin(), HitCells.end()), HitCells.end());
+
+        const std::vector<FKernelColumn>& Kernel = GetInflationKernel(std::max(InflationRadius, 0.0f));
+        int32_t NumChanged = 0;
+        for (int64_t CellIndex : HitCells)
+        {
+            const FIntVec3 Cell = GetCellCoord(CellIndex);
+            for (const FKernelColumn& Column : Kernel)
+            {
+                const int32_t X = Cell.X + Column.DX;
+                const int32_t Y = Cell.Y + Column.DY;
+                if (X < 0 || X >= DimX || Y < 0 || Y >= DimY)
+                {
+                    continue;
+                }
+
+                const int32_t HalfHeight = std::min(Column.HalfHeight, MaxHalfHeightCells);
+                const int32_t MinZ = std::max(Cell.Z - HalfHeight, 0);
+                const int32_t MaxZ = std::min(Cell.Z + HalfHeight, DimZ - 1);
+                for (int32_t Z = MinZ; Z <= MaxZ; ++Z)
+                {
+                    const int64_t Index = GetCellIndex(X, Y, Z);
+                    if (!IsOccupiedIndex(Index))
+                    {
+                        SetOccupiedIndex(Index);
+                        OutChanged.Add(FIntVec3(X, Y, Z));
+                        NumChanged++;
+                    }
+                }
+            }
+        }
+        return NumChanged;
+    }
+
+    int32_t FOccupancyGrid::AddCylinder(const FVec3& Center, float Radius, float Height)
+    {
+        return AddInflatedCylinder(Center, Radius, Height, 0.0f);
+    }
+
+    int32_t FOccupancyGrid::AddInflatedCylinder(const FVec3& Center, float Radius, float Height, float InflationRadius)
+    {
+        if (!IsInitialized())
+        {
+            return 0;
+        }
+
+        const FCylinderFootprint Footprint = GetCylinderFootprint(Center, Radius, Height);
+        const std::vector<FKernelColumn>& Kernel = GetInflationKernel(std::max(InflationRadius, 0.0f));
+
+        // 圆柱每列的占用是连续的z区间[MinZ, MaxZ]，膨胀后目标列的占用为[MinZ - h, MaxZ + h]。
+        // 落在圆柱内部的目标列由其自身的(0, 0)列覆盖（半高最大），无需从邻列重复写入
+        int32_t NumChanged = 0;
+        for (int32_t x = Footprint.MinX; x <= Footprint.MaxX; x++)
+        {
+            for (int32_t y = Footprint.MinY; y <= Footprint.MaxY; y++)
+            {
+                if (!Footprint.ContainsColumn(x, y))
+                {
+                    continue;
+                }
+                for (const FKernelColumn& Column : Kernel)
+                {
+                    const int32_t nx = x + Column.DX;
+                    const int32_t ny = y + Column.DY;
+                    if (nx < 0 || nx >= DimX || ny < 0 || ny >= DimY)
+                    {
+                        continue;
+                    }
+                    if ((Column.DX != 0 || Column.DY != 0) && Footprint.ContainsColumn(nx, ny))
+                    {
+                        continue;
+                    }
+
+                    const int32_t MinZ = std::max(Footprint.MinZ - Column.HalfHeight, 0);
+                    const int32_t MaxZ = std::min(Footprint.MaxZ + Column.HalfHeight, DimZ - 1);
+                    for (int32_t z = MinZ; z <= MaxZ; z++)
+                    {
+                        const int64_t Index = GetCellIndex(nx, ny, z);
+                        if (!IsOccupiedIndex(Index))
+                        {
+                            SetOccupiedIndex(Index);
+                            NumChanged++;
+                        }
+                    }
+                }
+            }
+        }
+        return NumChanged;
+    }
+
+    void FOccupancyGrid::Clear()
+    {
+        if (bSparse)
+        {
+            // 稀疏地图清空时释放所有块
+            InitializeSparseTables();
+            return;
+        }
+        std::fill(Bits.begin(), Bits.end(), 0ull);
+    }
+
+    int64_t FOccupancyGrid::CountOccupied() const
+    {
+        int64_t Count = 0;
+        auto CountWord = [&Count](uint64_t Word)
+        {
+            while (Word)
+            {
+                Word &= Word - 1;
+                ++Count;
+            }
+        };
+        for (uint64_t Word : Bits)
+        {
+            CountWord(Word);
+        }
+        for (const FBrick& Brick : Bricks)
+        {
+            for (uint64_t Word : Brick.Words)
+            {
+                CountWord(Word);
+            }
+        }
+        return Count;
+    }
+
+    size_t FOccupancyGrid::GetAllocatedBytes() const
+    {
+        return Bits.size() * sizeof(uint64_t) + TileTable.size() * sizeof(int32_t)
+            + TileBricks.size() * sizeof(int32_t) + Bricks.size() * sizeof(FBrick);
+    }
+
+    bool FOccupancyGrid::SaveToFile(const std::string& FilePath) const
+    {
+        FILE* File = std::fopen(FilePath.c_str(), "wb");
+        if (!File)
+        {
+            return false;
+        }
+
+        const double Header[7] = { Origin.X, Origin.Y, Origin.Z, Size.X, Size.Y, Size.Z, (double)CellSize };
+        if (bSparse)
+        {
+            // 每个块写入其最小角格子坐标和8个字
+            const uint64_t NumBricks = Bricks.size();
+            bool bOk = std::fwrite(SparseGridFileMagic, sizeof(SparseGridFileMagic), 1, File) == 1
+                && std::fwrite(Header, sizeof(Header), 1, File) == 1
+                && std::fwrite(&NumBricks, sizeof(NumBricks), 1, File) == 1;
+            for (size_t Tile = 0; bOk && Tile < TileTable.size(); ++Tile)
+            {
+                if (TileTable[Tile] < 0)
+                {
+                    continue;
+                }
+                const int32_t TileX = (int32_t)(Tile % TilesX);
+                const int32_t TileY = (int32_t)((Tile / TilesX) % TilesY);
+                const int32_t TileZ = (int32_t)(Tile / ((size_t)TilesX * TilesY));
+                for (int32_t Slot = 0; bOk && Slot < BRICKS_PER_TILE; ++Slot)
+                {
+                    const int32_t Brick = TileBricks[((size_t)TileTable[Tile] << (BRICK_SHIFT * 3)) | Slot];
+                    if (Brick < 0)
+                    {
+                        continue;
+                    }
+                    const int32_t Corner[3] = {
+                        (TileX << TILE_SHIFT) | ((Slot & BRICK_MASK) << BRICK_SHIFT),
+                        (TileY << TILE_SHIFT) | (((Slot >> BRICK_SHIFT) & BRICK_MASK) << BRICK_SHIFT),
+                        (TileZ << TILE_SHIFT) | ((Slot >> (BRICK_SHIFT * 2)) << BRICK_SHIFT) };
+                    bOk = std::fwrite(Corner, sizeof(Corner), 1, File) == 1
+                        && std::fwrite(Bricks[Brick].Words, sizeof(FBrick), 1, File) == 1;
+                }
+            }
+            std::fclose(File);
+            return bOk;
+        }
+
+        const uint64_t NumWords = Bits.size();
+        bool bOk = std::fwrite(GridFileMagic, sizeof(GridFileMagic), 1, File) == 1
+            && std::fwrite(Header, sizeof(Header), 1, File) == 1
+            && std::fwrite(&NumWords, sizeof(NumWords), 1, File) == 1;
+        if (bOk && NumWords > 0)
+        {
+            bOk = std::fwrite(Bits.data(), sizeof(uint64_t), Bits.size(), File) == Bits.size();
+        }
+        std::fclose(File);
+        return bOk;
+    }
+
+    bool FOccupancyGrid::LoadFromFile(const std::string& FilePath)
+    {
+        FILE* File = std::fopen(FilePath.c_str(), "rb");
+        if (!File)
+        {
+            return false;
+        }
+
+        char Magic[sizeof(GridFileMagic)];
+        double Header[7];
+        uint64_t NumWords = 0;
+        bool bOk = std::fread(Magic, sizeof(Magic), 1, File) == 1;
+        const bool bSparseFile = bOk && std::memcmp(Magic, SparseGridFileMagic, sizeof(Magic)) == 0;
+        bOk = bOk && (bSparseFile || std::memcmp(Magic, GridFileMagic, sizeof(Magic)) == 0)
+            && std::fread(Header, sizeof(Header), 1, File) == 1
+            && std::fread(&NumWords, sizeof(NumWords), 1, File) == 1;
+        bOk = bOk && IsValidGridFileHeader(Header, bSparseFile);
+
+        // 先读入临时栅格，全部成功后才替换当前栅格，损坏的文件不会破坏已有地图
+        FOccupancyGrid Loaded;
+        if (bOk)
+        {
+            Loaded.Initialize(FVec3(Header[0], Header[1], Header[2]), FVec3(Header[3], Header[4], Header[5]), (float)Header[6], bSparseFile);
+        }
+        if (bOk && bSparseFile)
+        {
+            // NumWords为块数，不能超过地图能容纳的块数；每块的角点须在地图内且按块对齐。
+            // 任何一块读取失败都整体放弃，Loaded中已写入的块随之丢弃
+            const uint64_t MaxBricks = (uint64_t)Loaded.TilesX * Loaded.TilesY * Loaded.TilesZ * BRICKS_PER_TILE;
+            bOk = NumWords <= MaxBricks;
+            for (uint64_t i = 0; bOk && i < NumWords; ++i)
+            {
+                int32_t Corner[3];
+                FBrick Brick;
+                bOk = std::fread(Corner, sizeof(Corner), 1, File) == 1
+                    && std::fread(Brick.Words, sizeof(FBrick), 1, File) == 1
+                    && Loaded.IsValidCell(Corner[0], Corner[1], Corner[2])
+                    && ((Corner[0] | Corner[1] | Corner[2]) & BRICK_MASK) == 0;
+                if (bOk)
+                {
+                    uint64_t* Words = Loaded.FindOrAddBrick(Corner[0], Corner[1], Corner[2]);
+                    std::copy(Brick.Words, Brick.Words + (1 << BRICK_SHIFT), Words);
+                }
+            }
+        }
+        else if (bOk)
+        {
+            bOk = NumWords == Loaded.Bits.size()
+                && (NumWords == 0 || std::fread(Loaded.Bits.data(), sizeof(uint64_t), Loaded.Bits.size(), File) == Loaded.Bits.size());
+        }
+        std::fclose(File);
+        if (bOk)
+        {
+            *this = std::move(Loaded);
+        }
+        return bOk;
+    }
+}
@@ -0,0 +1,327 @@
+// OccupancyGrid.h
+#pragma once
+
+#include "PlanningTypes.h"
+#include <string>
+#include <vector>
+
+namespace DronePlanning
+{
+    // 三维占用栅格：每个格子1 bit。
+    // 稠密模式按线性索引存储（X变化最快）；稀疏模式只为出现过占用的8^3格子块分配内存，
+    // 块挂在按64^3格子划分的两级表下，内存随被占用的空间增长，适合高分辨率的大地图。
+    // 格子索引只在同一张栅格内有意义，两种模式的编码不同
+    class FOccupancyGrid
+    {
+    public:
+        // MinCorner为地图最小角点（不是中心）
+        void Initialize(const FVec3& MinCorner, const FVec3& Size, float Resolution, bool bInSparse = false);
+
+        bool IsSparse() const { return bSparse; }
+
+        bool IsInitialized() const { return DimX > 0 && DimY > 0 && DimZ > 0; }
+
+        // 坐标转换
+        bool WorldToGrid(const FVec3& WorldPos, int32_t& GridX, int32_t& GridY, int32_t& GridZ) const;
+        FVec3 GridToWorld(int32_t GridX, int32_t GridY, int32_t GridZ) const;
+
+        bool IsValidCell(int32_t X, int32_t Y, int32_t Z) const
+        {
+            return X >= 0 && X < DimX && Y >= 0 && Y < DimY && Z >= 0 && Z < DimZ;
+        }
+
+        // 稀疏模式下索引为按位拼接的(X, Y, Z)，无需除法即可还原坐标
+        int64_t GetCellIndex(int32_t X, int32_t Y, int32_t Z) const
+        {
+            if (bSparse)
+            {
+                return (int64_t)X | ((int64_t)Y << SparseShiftY) | ((int64_t)Z << SparseShiftZ);
+            }
+            return ((int64_t)Z * DimY + Y) * DimX + X;
+        }
+
+        FIntVec3 GetCellCoord(int64_t Index) const
+        {
+            if (bSparse)
+            {
+                return FIntVec3((int32_t)(Index & SparseMaskX), (int32_t)((Index >> SparseShiftY) & SparseMaskY),
+                    (int32_t)(Index >> SparseShiftZ));
+            }
+            return FIntVec3((int32_t)(Index % DimX), (int32_t)((Index / DimX) % DimY), (int32_t)(Index / ((int64_t)DimX * DimY)));
+        }
+
+        // 快速路径：越界视为空闲
+        bool IsOccupiedCell(int32_t X, int32_t Y, int32_t Z) const
+        {
+            if (!IsValidCell(X, Y, Z))
+            {
+                return false;
+            }
+            return bSparse ? IsOccupiedSparse(X, Y, Z) : IsOccupiedDense(GetCellIndex(X, Y, Z));
+        }
+
+        bool IsOccupiedIndex(int64_t Index) const
+        {
+            if (bSparse)
+            {
+                const FIntVec3 Cell = GetCellCoord(Index);
+                return IsOccupiedSparse(Cell.X, Cell.Y, Cell.Z);
+            }
+            return IsOccupiedDense(Index);
+        }
+
+        bool IsOccupied(const FVec3& WorldPos) const;
+
+        // (X, Y, Z)周围3x3x3格子中Wanted所选格子的占用位掩码：第 (DX+1) + 3*(DY+1) + 9*(DZ+1) 位对应偏移(DX, DY, DZ)，
+        // 越界格子视为占用，Wanted之外的位为0。远离边界（稀疏模式下为整个邻域落在同一个砖块内）的格子每行3个格子一次读出，
+        // 其余情况只逐格判断Wanted所选的格子，供逐格扫描的跳点搜索使用
+        uint32_t GetNeighbourhoodMask(int32_t X, int32_t Y, int32_t Z, uint32_t Wanted) const
+        {
+            if (X <= 0 || X >= DimX - 1 || Y <= 0 || Y >= DimY - 1 || Z <= 0 || Z >= DimZ - 1)
+            {
+                return GetNeighbourhoodMaskSlow(X, Y, Z, Wanted);
+            }
+
+            if (bSparse)
+            {
+                const int32_t Interior = BRICK_MASK - 1;
+                if (((X - 1) & BRICK_MASK) >= Interior || ((Y - 1) & BRICK_MASK) >= Interior || ((Z - 1) & BRICK_MASK) >= Interior)
+                {
+                    return GetNeighbourhoodMaskSlow(X, Y, Z, Wanted);
+                }
+                const int32_t Brick = GetBrickSlot(X, Y, Z);
+                if (Brick < 0)
+                {
+                    return 0;
+                }
+
+                // 砖块内一个Z层为一个字，(X-1..X+1, Y+DY)是其中连续的3位
+                const uint64_t* Words = Bricks[Brick].Words;
+                const int32_t Corner = BrickBit(X - 1, Y - 1);
+                uint32_t Mask = 0;
+                for (int32_t Row = 0; Row < 9; ++Row)
+                {
+                    const uint64_t Layer = Words[(Z - 1 + Row / 3) & BRICK_MASK];
+                    Mask |= (uint32_t)((Layer >> (Corner + (Row % 3) * (BRICK_MASK + 1))) & 7) << (Row * 3);
+                }
+                return Mask & Wanted;
+            }
+
+            // X变化最快，(X-1..X+1, Y+DY, Z+DZ)在位图中连续，可能跨越两个字
+            const int64_t StrideZ = (int64_t)DimX * DimY;
+            const int64_t Corner = GetCellIndex(X - 1, Y - 1, Z - 1);
+            uint32_t Mask = 0;
+            for (int32_t Row = 0; Row < 9; ++Row)
+            {
+                const int64_t First = Corner + (Row % 3) * (int64_t)DimX + (Row / 3) * StrideZ;
+                const int32_t Shift = (int32_t)(First & 63);
+                uint64_t Bits3 = Bits[First >> 6] >> Shift;
+                if (Shift > 61)
+                {
+                    Bits3 |= Bits[(First >> 6) + 1] << (64 - Shift);
+                }
+                Mask |= (uint32_t)(Bits3 & 7) << (Row * 3);
+            }
+            return Mask & Wanted;
+        }
+
+        void SetOccupiedIndex(int64_t Index)
+        {
+            if (bSparse)
+            {
+                const FIntVec3 Cell = GetCellCoord(Index);
+                FindOrAddBrick(Cell.X, Cell.Y, Cell.Z)[Cell.Z & BRICK_MASK] |= 1ull << BrickBit(Cell.X, Cell.Y);
+                return;
+            }
+            Bits[Index >> 6] |= (1ull << (Index & 63));
+        }
+
+        void ClearOccupiedIndex(int64_t Index)
+        {
+            if (bSparse)
+            {
+                // 不释放块：被清除的空间很可能再次被观测到
+                const FIntVec3 Cell = GetCellCoord(Index);
+                if (uint64_t* Words = FindBrick(Cell.X, Cell.Y, Cell.Z))
+                {
+                    Words[Cell.Z & BRICK_MASK] &= ~(1ull << BrickBit(Cell.X, Cell.Y));
+                }
+                return;
+            }
+            Bits[Index >> 6] &= ~(1ull << (Index & 63));
+        }
+
+        // 标记世界坐标所在格子为占用，越界返回false
+        bool MarkOccupied(const FVec3& WorldPos);
+
+        // 标记单个格子为占用，仅当格子有效且原先空闲时返回true
+        bool MarkOccupiedCell(int32_t X, int32_t Y, int32_t Z)
+        {
+            if (!IsValidCell(X, Y, Z))
+            {
+                return false;
+            }
+            const int64_t Index = GetCellIndex(X, Y, Z);
+            if (IsOccupiedIndex(Index))
+            {
+                return false;
+            }
+            SetOccupiedIndex(Index);
+            return true;
+        }
+
+        // 批量标记格子（越界格子被忽略），返回新变为占用的格子数，OutChanged扩展为这些格子的包围盒
+        int32_t MarkOccupiedCells(const std::vector<FIntVec3>& Cells, FCellBounds& OutChanged);
+
+        // 标记包围盒（先裁剪到地图范围）内的所有格子，返回值与OutChanged含义同上
+        int32_t MarkOccupiedBox(const FCellBounds& Box, FCellBounds& OutChanged);
+
+        // 扫描结果写入：命中点先量化为去重后的格子，再在索引空间内套用球形膨胀核（与AddInflatedCylinder同一个核，
+        // z方向半高不超过MaxHalfHeightCells）。落在地图外的命中点被忽略。返回值与OutChanged含义同MarkOccupiedCells
+        int32_t IntegrateHits(const std::vector<FVec3>& Hits, float InflationRadius, int32_t MaxHalfHeightCells, FCellBounds& OutChanged);
+
+        // 整张地图的包围盒
+        FCellBounds GetBounds() const
+        {
+            return FCellBounds(FIntVec3(0, 0, 0), FIntVec3(DimX - 1, DimY - 1, DimZ - 1));
+        }
+
+        // 在XY平面上的圆 x 高度范围内标记竖直圆柱，返回新置为占用的格子数
+        int32_t AddCylinder(const FVec3& Center, float Radius, float Height);
+
+        // 标记竖直圆柱并只对这个圆柱做球形膨胀（InflationRadius为世界单位），已有障碍物不会被重复膨胀。
+        // 结果与先标记全部圆柱再整体膨胀一次相同，但只访问新圆柱附近的格子。返回新置为占用的格子数
+        int32_t AddInflatedCylinder(const FVec3& Center, float Radius, float Height, float InflationRadius);
+
+        // 清空所有障碍物
+        void Clear();
+
+        const FVec3& GetOrigin() const { return Origin; }
+        const FVec3& GetSize() const { return Size; }
+        float GetResolution() const { return CellSize; }
+        int32_t GetDimX() const { return DimX; }
+        int32_t GetDimY() const { return DimY; }
+        int32_t GetDimZ() const { return DimZ; }
+        int64_t GetNumCells() const { return (int64_t)DimX * DimY * DimZ; }
+        int64_t CountOccupied() const;
+
+        // 占用数据实际分配的字节数（稠密模式为整张位图）
+        size_t GetAllocatedBytes() const;
+
+        // 录制/回放地图（二进制格式，供无头基准测试使用）。稀疏地图只写入已分配的块，加载时恢复存储模式
+        bool SaveToFile(const std::string& FilePath) const;
+        bool LoadFromFile(const std::string& FilePath);
+
+        // 球形膨胀核按(dx, dy)分列，每列在z方向覆盖[-HalfHeight, HalfHeight]
+        struct FKernelColumn
+        {
+            int32_t DX;
+            int32_t DY;
+            int32_t HalfHeight;
+        };
+
+        // 与格子中心距离不超过Radius的偏移（世界单位），缓存最近一次使用的半径
+        const std::vector<FKernelColumn>& GetInflationKernel(float Radius);
+
+    private:
+
+        // 圆柱在网格上的投影：XY包围盒内与圆心距离不超过半径的列，z范围[MinZ, MaxZ]
+        struct FCylinderFootprint
+        {
+            int32_t MinX, MinY, MinZ;
+            int32_t MaxX, MaxY, MaxZ;
+            int32_t CenterX, CenterY;
+            float RadiusSquaredInCells;
+
+            bool ContainsColumn(int32_t X, int32_t Y) const
+            {
+                return X >= MinX && X <= MaxX && Y >= MinY && Y <= MaxY
+                    && (float)((X - CenterX) * (X - CenterX) + (Y - CenterY) * (Y - CenterY)) <= RadiusSquaredInCells;
+            }
+        };
+
+        // 稠密模式的位图
+        std::vector<uint64_t> Bits;
+
+        // 稀疏模式：8^3格子为一块（每层z一个uint64），8^3块为一个tile。
+        // TileTable按tile坐标索引，值为tile在TileBricks中的序号（-1为空）；
+        // TileBricks每个tile连续512项，值为块在Bricks中的序号（-1为空）
+        static constexpr int32_t BRICK_SHIFT = 3;
+        static constexpr int32_t BRICK_MASK = (1 << BRICK_SHIFT) - 1;
+        static constexpr int32_t TILE_SHIFT = BRICK_SHIFT * 2;
+        static constexpr int32_t BRICKS_PER_TILE = 1 << (BRICK_SHIFT * 3);
+
+        struct FBrick
+        {
+            uint64_t Words[1 << BRICK_SHIFT];
+        };
+
+        bool bSparse = false;
+        std::vector<int32_t> TileTable;
+        std::vector<int32_t> TileBricks;
+        std::vector<FBrick> Bricks;
+        int32_t TilesX = 0;
+        int32_t TilesY = 0;
+        int32_t TilesZ = 0;
+        int32_t SparseShiftY = 0;
+        int32_t SparseShiftZ = 0;
+        int64_t SparseMaskX = 0;
+        int64_t SparseMaskY = 0;
+
+        bool IsOccupiedDense(int64_t Index) const
+        {
+            return (Bits[Index >> 6] >> (Index & 63)) & 1ull;
+        }
+
+        static int32_t BrickBit(int32_t X, int32_t Y)
+        {
+            return ((Y & BRICK_MASK) << BRICK_SHIFT) | (X & BRICK_MASK);
+        }
+
+        int32_t GetBrickSlot(int32_t X, int32_t Y, int32_t Z) const
+        {
+            const int32_t Tile = TileTable[((size_t)(Z >> TILE_SHIFT) * TilesY + (Y >> TILE_SHIFT)) * TilesX + (X >> TILE_SHIFT)];
+            if (Tile < 0)
+            {
+                return -1;
+            }
+            return TileBricks[((size_t)Tile << (BRICK_SHIFT * 3))
+                | (((Z >> BRICK_SHIFT) & BRICK_MASK) << (BRICK_SHIFT * 2))
+                | (((Y >> BRICK_SHIFT) & BRICK_MASK) << BRICK_SHIFT)
+                | ((X >> BRICK_SHIFT) & BRICK_MASK)];
+        }
+
+        bool IsOccupiedSparse(int32_t X, int32_t Y, int32_t Z) const
+        {
+            const int32_t Brick = GetBrickSlot(X, Y, Z);
+            return Brick >= 0 && ((Bricks[Brick].Words[Z & BRICK_MASK] >> BrickBit(X, Y)) & 1ull);
+        }
+
+        uint64_t* FindBrick(int32_t X, int32_t Y, int32_t Z)
+        {
+            const int32_t Brick = GetBrickSlot(X, Y, Z);
+            return Brick >= 0 ? Bricks[Brick].Words : nullptr;
+        }
+
+        uint64_t* FindOrAddBrick(int32_t X, int32_t Y, int32_t Z);
+
+        // 稀疏模式或靠近边界时的GetNeighbourhoodMask
+        uint32_t GetNeighbourhoodMaskSlow(int32_t X, int32_t Y, int32_t Z, uint32_t Wanted) const;
+        void InitializeSparseTables();
+
+        // 最近一次使用的膨胀核（半径或分辨率变化时重建）
+        std::vector<FKernelColumn> InflationKernel;
+        float InflationKernelRadius = -1.0f;
+        float InflationKernelCellSize = 0.0f;
+
+        FCylinderFootprint GetCylinderFootprint(const FVec3& Center, float Radius, float Height) const;
+
+        FVec3 Origin;
+        FVec3 Size;
+        float CellSize = 10.0f;
+
+        int32_t DimX = 0;
+        int32_t DimY = 0;
+        int32_t DimZ = 0;
+    };
+}
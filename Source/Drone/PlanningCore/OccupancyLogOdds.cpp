@@ -0,0 +1,200 @@
+// OccupancyLogOdds.cpp
+#include "OccupancyLogOdds.h"
+#include "VoxelRaycaster.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        int32_t QuantizeLogOdds(float Value, float Scale)
+        {
+            const float Scaled = std::round(Value * Scale);
+            return (int32_t)std::min(std::max(Scaled, (float)INT16_MIN), (float)INT16_MAX);
+        }
+    }
+
+    void FOccupancyLogOdds::Initialize(const FOccupancyGrid& Grid, float InflationRadius)
+    {
+        StaticGrid = Grid;
+        SparseBrickSlots.clear();
+        SparseBricks.clear();
+        if (Grid.IsSparse())
+        {
+            std::vector<FCellState>().swap(DenseStates);
+        }
+        else
+        {
+            DenseStates.assign((size_t)Grid.GetNumCells(), FCellState());
+        }
+
+        // 与扫描器的二值写入一致：z方向半高不超过膨胀格数的一半
+        const float Radius = std::max(InflationRadius, 0.0f);
+        const int32_t MaxHalfHeight = (int32_t)std::ceil(Radius / Grid.GetResolution()) / 2;
+        Kernel = StaticGrid.GetInflationKernel(Radius);
+        for (FOccupancyGrid::FKernelColumn& Column : Kernel)
+        {
+            Column.HalfHeight = std::min(Column.HalfHeight, MaxHalfHeight);
+        }
+    }
+
+    void FOccupancyLogOdds::Reset()
+    {
+        StaticGrid = FOccupancyGrid();
+        std::vector<FCellState>().swap(DenseStates);
+        std::unordered_map<int64_t, int32_t>().swap(SparseBrickSlots);
+        std::vector<FStateBrick>().swap(SparseBricks);
+        Kernel.clear();
+    }
+
+    float FOccupancyLogOdds::GetLogOdds(int64_t Index) const
+    {
+        const FCellState* State = StaticGrid.IsSparse() ? FindSparseState(Index) : &DenseStates[Index];
+        return State ? State->LogOdds / LOG_ODDS_SCALE : 0.0f;
+    }
+
+    FOccupancyLogOdds::FCellState& FOccupancyLogOdds::GetSparseState(int64_t Index)
+    {
+        const FIntVec3 Cell = StaticGrid.GetCellCoord(Index);
+        const int64_t BrickKey = StaticGrid.GetCellIndex(Cell.X & ~STATE_BRICK_MASK, Cell.Y & ~STATE_BRICK_MASK, Cell.Z & ~STATE_BRICK_MASK);
+        const auto Inserted = SparseBrickSlots.emplace(BrickKey, (int32_t)SparseBricks.size());
+        if (Inserted.second)
+        {
+            SparseBricks.emplace_back();
+        }
+        const int32_t Local = ((Cell.Z & STATE_BRICK_MASK) << (STATE_BRICK_SHIFT * 2))
+            | ((Cell.Y & STATE_BRICK_MASK) << STATE_BRICK_SHIFT) | (Cell.X & STATE_BRICK_MASK);
+        return SparseBricks[Inserted.first->second].Cells[Local];
+    }
+
+    const FOccupancyLogOdds::FCellState* FOccupancyLogOdds::FindSparseState(int64_t Index) const
+    {
+        const FIntVec3 Cell = StaticGrid.GetCellCoord(Index);
+        const int64_t BrickKey = StaticGrid.GetCellIndex(Cell.X & ~STATE_BRICK_MASK, Cell.Y & ~STATE_BRICK_MASK, Cell.Z & ~STATE_BRICK_MASK);
+        const auto Found = SparseBrickSlots.find(BrickKey);
+        if (Found == SparseBrickSlots.end())
+        {
+            return nullptr;
+        }
+        const int32_t Local = ((Cell.Z & STATE_BRICK_MASK) << (STATE_BRICK_SHIFT * 2))
+            | ((Cell.Y & STATE_BRICK_MASK) << STATE_BRICK_SHIFT) | (Cell.X & STATE_BRICK_MASK);
+        return &SparseBricks[Found->second].Cells[Local];
+    }
+
+    int32_t FOccupancyLogOdds::IntegrateRays(FOccupancyGrid& Grid, const std::vector<FVec3>& Starts, const std::vector<FVec3>& Ends,
+        const std::vector<uint8_t>& bHits, FCellBounds& OutChanged)
+    {
+        if (!IsInitialized() || Grid.GetNumCells() != StaticGrid.GetNumCells() || Grid.IsSparse() != StaticGrid.IsSparse())
+        {
+            return 0;
+        }
+
+        HitDelta = QuantizeLogOdds(Config.HitLogOdds, LOG_ODDS_SCALE);
+        MissDelta = QuantizeLogOdds(Config.MissLogOdds, LOG_ODDS_SCALE);
+        MinValue = QuantizeLogOdds(Config.MinLogOdds, LOG_ODDS_SCALE);
+        MaxValue = std::max(QuantizeLogOdds(Config.MaxLogOdds, LOG_ODDS_SCALE), MinValue);
+        OccupiedValue = QuantizeLogOdds(Config.OccupiedThreshold, LOG_ODDS_SCALE);
+
+        // 先收集本次扫描的命中格子与穿过的格子，去重后每个格子只更新一次
+        HitCells.clear();
+        FreeCells.clear();
+        const size_t NumRays = std::min(std::min(Starts.size(), Ends.size()), bHits.size());
+        for (size_t i = 0; i < NumRays; ++i)
+        {
+            int64_t HitIndex = -1;
+            int32_t X, Y, Z;
+            if (bHits[i] && Grid.WorldToGrid(Ends[i], X, Y, Z))
+            {
+                HitIndex = Grid.GetCellIndex(X, Y, Z);
+                HitCells.push_back(HitIndex);
+            }
+
+            FVoxelRaycaster::TraverseCells(Grid, Starts[i], Ends[i], [&](int32_t CellX, int32_t CellY, int32_t CellZ, double)
+            {
+                const int64_t Index = Grid.GetCellIndex(CellX, CellY, CellZ);
+                if (Index == HitIndex)
+                {
+                    return false;
+                }
+                FreeCells.push_back(Index);
+                return true;
+            });
+        }
+
+        std::sort(HitCells.begin(), HitCells.end());
+        HitCells.erase(std::unique(HitCells.begin(), HitCells.end()), HitCells.end());
+        std::sort(FreeCells.begin(), FreeCells.end());
+        FreeCells.erase(std::unique(FreeCells.begin(), FreeCells.end()), FreeCells.end());
+
+        int32_t NumChanged = 0;
+        for (int64_t Index : FreeCells)
+        {
+            if (!std::binary_search(HitCells.begin(), HitCells.end(), Index))
+            {
+                UpdateCell(Grid, Index, MissDelta, OutChanged, NumChanged);
+            }
+        }
+        for (int64_t Index : HitCells)
+        {
+            UpdateCell(Grid, Index, HitDelta, OutChanged, NumChanged);
+        }
+        return NumChanged;
+    }
+
+    void FOccupancyLogOdds::UpdateCell(FOccupancyGrid& Grid, int64_t Index, int32_t Delta, FCellBounds& OutChanged, int32_t& NumChanged)
+    {
+        int16_t& Value = GetState(Index).LogOdds;
+        const bool bWasOccupied = Value > OccupiedValue;
+        Value = (int16_t)std::min(std::max(Value + Delta, MinValue), MaxValue);
+        const bool bOccupied = Value > OccupiedValue;
+        if (bOccupied != bWasOccupied)
+        {
+            ApplyInflation(Grid, Index, bOccupied, OutChanged, NumChanged);
+        }
+    }
+
+    void FOccupancyLogOdds::ApplyInflation(FOccupancyGrid& Grid, int64_t Index, bool bOccupied, FCellBounds& OutChanged, int32_t& NumChanged)
+    {
+        // 膨胀范围内的格子记录覆盖计数：计数从0变1时置为占用，
+        // 归0且不属于静态底图时清除；计数饱和后不再变化
+        const FIntVec3 Cell = Grid.GetCellCoord(Index);
+        for (const FOccupancyGrid::FKernelColumn& Column : Kernel)
+        {
+            const int32_t X = Cell.X + Column.DX;
+            const int32_t Y = Cell.Y + Column.DY;
+            if (X < 0 || X >= Grid.GetDimX() || Y < 0 || Y >= Grid.GetDimY())
+            {
+                continue;
+            }
+
+            const int32_t MinZ = std::max(Cell.Z - Column.HalfHeight, 0);
+            const int32_t MaxZ = std::min(Cell.Z + Column.HalfHeight, Grid.GetDimZ() - 1);
+            for (int32_t Z = MinZ; Z <= MaxZ; ++Z)
+            {
+                const int64_t CellIndex = Grid.GetCellIndex(X, Y, Z);
+                uint16_t& Coverage = GetState(CellIndex).Coverage;
+                if (Coverage == MAX_COVERAGE)
+                {
+                    continue;
+                }
+                if (bOccupied)
+                {
+                    if (Coverage++ == 0 && !Grid.IsOccupiedIndex(CellIndex))
+                    {
+                        Grid.SetOccupiedIndex(CellIndex);
+                        OutChanged.Add(FIntVec3(X, Y, Z));
+                        NumChanged++;
+                    }
+                }
+                else if (Coverage > 0 && --Coverage == 0 && !StaticGrid.IsOccupiedIndex(CellIndex) && Grid.IsOccupiedIndex(CellIndex))
+                {
+                    Grid.ClearOccupiedIndex(CellIndex);
+                    OutChanged.Add(FIntVec3(X, Y, Z));
+                    NumChanged++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+// OccupancyLogOdds.h
+// 概率占用层：按log-odds累积激光射线（命中升高、穿过的格子降低，并做上下限截断），
+// 再把结果连同膨胀写回FOccupancyGrid，使离开的动态障碍物逐渐从地图中消失
+#pragma once
+
+#include "OccupancyGrid.h"
+#include "PlanningTypes.h"
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    // 默认值对应命中概率0.7、穿过概率0.4、截断到[0.12, 0.97]、占用阈值0.5
+    struct FLogOddsConfig
+    {
+        float HitLogOdds = 0.85f;
+        float MissLogOdds = -0.4f;
+        float MinLogOdds = -2.0f;
+        float MaxLogOdds = 3.5f;
+        float OccupiedThreshold = 0.0f;
+    };
+
+    class FOccupancyLogOdds
+    {
+    public:
+        FLogOddsConfig Config;
+
+        // 以Grid当前的占用作为静态底图（射线不会清除），并为每个格子分配log-odds与膨胀计数（每格4字节；
+        // 稀疏栅格按8x8x8砖块在首次观测或被膨胀覆盖时分配）。
+        // 占用格子按InflationRadius（世界单位，z方向只膨胀一半）膨胀，初始化后不可更改
+        void Initialize(const FOccupancyGrid& Grid, float InflationRadius);
+
+        // 释放所有数据，之后需要重新Initialize
+        void Reset();
+
+        bool IsInitialized() const { return StaticGrid.IsInitialized(); }
+
+        // 在log-odds之外写入栅格的障碍物须同时写入这里，否则可能被射线清除
+        FOccupancyGrid& GetStaticGrid() { return StaticGrid; }
+
+        // 积分一次扫描：每条射线Starts[i]->Ends[i]，bHits[i]非0时终点所在格子为命中。
+        // 同一次扫描中每个格子最多更新一次，命中优先于穿过。
+        // Grid须与Initialize时的尺寸相同。返回占用状态改变（含清除）的格子数，OutChanged扩展为这些格子的包围盒
+        int32_t IntegrateRays(FOccupancyGrid& Grid, const std::vector<FVec3>& Starts, const std::vector<FVec3>& Ends,
+            const std::vector<uint8_t>& bHits, FCellBounds& OutChanged);
+
+        float GetLogOdds(int64_t Index) const;
+
+    private:
+        // log-odds以1/LOG_ODDS_SCALE为单位量化存储，Config中的值在每次积分时按同一比例换算
+        static constexpr float LOG_ODDS_SCALE = 1024.0f;
+
+        // 覆盖计数达到上限后不再增减，格子一直保持占用（宁可多占也不因回绕被清除）
+        static constexpr uint16_t MAX_COVERAGE = 0xFFFF;
+
+        static constexpr int32_t STATE_BRICK_SHIFT = 3;
+        static constexpr int32_t STATE_BRICK_MASK = (1 << STATE_BRICK_SHIFT) - 1;
+
+        // 格子的log-odds（0为未知）以及覆盖它的已占用格子数
+        struct FCellState
+        {
+            int16_t LogOdds = 0;
+            uint16_t Coverage = 0;
+        };
+
+        struct FStateBrick
+        {
+            FCellState Cells[1 << (STATE_BRICK_SHIFT * 3)];
+        };
+
+        FOccupancyGrid StaticGrid;
+
+        // 稠密栅格按索引存放每个格子；稀疏栅格按砖块存放，SparseBrickSlots由砖块最小角格子的索引映射到SparseBricks
+        std::vector<FCellState> DenseStates;
+        std::unordered_map<int64_t, int32_t> SparseBrickSlots;
+        std::vector<FStateBrick> SparseBricks;
+
+        // 本次积分使用的量化参数
+        int32_t HitDelta = 0;
+        int32_t MissDelta = 0;
+        int32_t MinValue = 0;
+        int32_t MaxValue = 0;
+        int32_t OccupiedValue = 0;
+
+        FCellState& GetState(int64_t Index)
+        {
+            return StaticGrid.IsSparse() ? GetSparseState(Index) : DenseStates[Index];
+        }
+
+        // 所在砖块不存在时分配；返回的引用在下一次分配砖块前有效
+        FCellState& GetSparseState(int64_t Index);
+        const FCellState* FindSparseState(int64_t Index) const;
+
+        // 膨胀核（z方向半高已截断）
+        std::vector<FOccupancyGrid::FKernelColumn> Kernel;
+
+        // 每次扫描复用的临时数组
+        std::vector<int64_t> HitCells;
+        std::vector<int64_t> FreeCells;
+
+        void UpdateCell(FOccupancyGrid& Grid, int64_t Index, int32_t Delta, FCellBounds& OutChanged, int32_t& NumChanged);
+        void ApplyInflation(FOccupancyGrid& Grid, int64_t Index, bool bOccupied, FCellBounds& OutChanged, int32_t& NumChanged);
+    };
+}
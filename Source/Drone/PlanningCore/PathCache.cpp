@@ -0,0 +1,325 @@
+// PathCache.cpp
+#include "PathCache.h"
+#include "GridNeighborhood.h"
+#include "OccupancyGrid.h"
+#include "ReservationTable.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        // 区域与量化块坐标打包为一个整数，每轴21位
+        constexpr int32_t PATH_CACHE_AXIS_BITS = 21;
+
+        // 一次变化涉及的区域超过该数量时，不逐个递增版本，直接让全部条目失效
+        constexpr int64_t PATH_CACHE_MAX_NOTIFY_REGIONS = 4096;
+
+        int64_t PackCacheCoord(int32_t X, int32_t Y, int32_t Z)
+        {
+            return (int64_t)X | ((int64_t)Y << PATH_CACHE_AXIS_BITS) | ((int64_t)Z << (2 * PATH_CACHE_AXIS_BITS));
+        }
+
+        int32_t GetChebyshevDistance(const FIntVec3& A, const FIntVec3& B)
+        {
+            return std::max({ std::abs(A.X - B.X), std::abs(A.Y - B.Y), std::abs(A.Z - B.Z) });
+        }
+
+        FIntVec3 GetPathCell(const FOccupancyGrid& Grid, const FVec3& Position)
+        {
+            FIntVec3 Cell;
+            Grid.WorldToGrid(Position, Cell.X, Cell.Y, Cell.Z);
+            return Cell;
+        }
+    }
+
+    int32_t FPathCache::GetQuantizeCells() const
+    {
+        return std::min(std::max(QuantizeCells, 1), 2);
+    }
+
+    int32_t FPathCache::GetRegionSize() const
+    {
+        return std::max(RegionSize, 1);
+    }
+
+    FPathCache::FKey FPathCache::MakeKey(const FIntVec3& StartCell, const FIntVec3& GoalCell) const
+    {
+        const int32_t Quantize = GetQuantizeCells();
+        FKey Key;
+        Key.Start = PackCacheCoord(StartCell.X / Quantize, StartCell.Y / Quantize, StartCell.Z / Quantize);
+        Key.Goal = PackCacheCoord(GoalCell.X / Quantize, GoalCell.Y / Quantize, GoalCell.Z / Quantize);
+        return Key;
+    }
+
+    int64_t FPathCache::GetRegionIndex(const FIntVec3& Cell) const
+    {
+        const int32_t Size = GetRegionSize();
+        return PackCacheCoord(Cell.X / Size, Cell.Y / Size, Cell.Z / Size);
+    }
+
+    bool FPathCache::IsValid(const FEntry& Entry) const
+    {
+        if (Entry.PlannedEpoch < FloorEpoch)
+        {
+            return false;
+        }
+        for (int64_t Region : Entry.Regions)
+        {
+            const auto It = RegionEpochs.find(Region);
+            if (It != RegionEpochs.end() && It->second > Entry.PlannedEpoch)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool FPathCache::Find(const FOccupancyGrid& Grid, const FReservationTable* Reservations, uint32_t ReservationEpoch,
+        const FPlanRequest& Request, float DroneSpeed, std::vector<FVec3>& OutPath)
+    {
+        OutPath.clear();
+
+        // 与FAStarPlanner::FindPath相同的端点检查，失败时交给规划器报告原因
+        FIntVec3 StartCell, GoalCell;
+        if (!Grid.WorldToGrid(Request.Start, StartCell.X, StartCell.Y, StartCell.Z)
+            || !Grid.WorldToGrid(Request.Goal, GoalCell.X, GoalCell.Y, GoalCell.Z)
+            || Grid.IsOccupiedCell(StartCell.X, StartCell.Y, StartCell.Z)
+            || Grid.IsOccupiedCell(GoalCell.X, GoalCell.Y, GoalCell.Z))
+        {
+            Stats.Misses++;
+            return false;
+        }
+
+        const auto It = Entries.find(MakeKey(StartCell, GoalCell));
+        if (It == Entries.end())
+        {
+            Stats.Misses++;
+            return false;
+        }
+        FEntry& Entry = It->second;
+        if (!IsValid(Entry))
+        {
+            Entries.erase(It);
+            Stats.Invalidated++;
+            Stats.Misses++;
+            return false;
+        }
+
+        bool bUnchanged = false;
+        if (!RepairPath(Grid, Entry, Request.Start, StartCell, GoalCell, OutPath, bUnchanged))
+        {
+            Stats.Misses++;
+            return false;
+        }
+
+        // 与A*搜索时一样逐段检查预约冲突
+        const bool bReservationChecked = Entry.bReservationChecked && bUnchanged && Entry.CheckedReservationEpoch == ReservationEpoch
+            && Entry.CheckedDroneID == Request.DroneID && Entry.CheckedStartTime == Request.StartTime;
+        if (Reservations && !bReservationChecked)
+        {
+            if (Reservations->IsPathConflict(FReservationTable::BuildSamples(OutPath, DroneSpeed, Request.StartTime), Request.DroneID))
+            {
+                OutPath.clear();
+                Stats.ReservationConflicts++;
+                Stats.Misses++;
+                return false;
+            }
+            if (bUnchanged)
+            {
+                Entry.bReservationChecked = true;
+                Entry.CheckedReservationEpoch = ReservationEpoch;
+                Entry.CheckedDroneID = Request.DroneID;
+                Entry.CheckedStartTime = Request.StartTime;
+            }
+        }
+
+        Entry.LastUsed = ++UseCounter;
+        Stats.Hits++;
+        if (!bUnchanged)
+        {
+            Stats.Repairs++;
+        }
+        return true;
+    }
+
+    bool FPathCache::RepairPath(const FOccupancyGrid& Grid, const FEntry& Entry, const FVec3& Start, const FIntVec3& StartCell,
+        const FIntVec3& GoalCell, std::vector<FVec3>& OutPath, bool& bOutUnchanged) const
+    {
+        const std::vector<FVec3>& Path = Entry.Path;
+        const int32_t NumPoints = (int32_t)Path.size();
+        const FIntVec3 CachedStartCell = GetPathCell(Grid, Path[0]);
+        auto GetCell = [&](int32_t Index)
+        {
+            return Index == 0 ? CachedStartCell : GetPathCell(Grid, Path[Index]);
+        };
+
+        // 新起点接到前段中最靠后的、与起点格子相同或相邻的点（0表示缓存起点所在格子的中心）；
+        // 新终点从后段中最靠前的、与目标格子相同或相邻的点接出。量化块不超过2格，搜索几个点即可
+        const int32_t SearchLength = 2 * GetQuantizeCells() + 1;
+        int32_t First = -1;
+        for (int32_t i = 0; i < NumPoints && i <= SearchLength; ++i)
+        {
+            if (GetChebyshevDistance(GetCell(i), StartCell) <= 1)
+            {
+                First = i;
+            }
+        }
+        // Add时没能补齐跨两个格子的最后一步时，末点只能用于同一目标格子，否则跨步会留在修补后路径的中间
+        const bool bFinalJump = NumPoints >= 2 && GetChebyshevDistance(GetCell(NumPoints - 2), GetCell(NumPoints - 1)) > 1;
+        int32_t Last = -1;
+        for (int32_t i = NumPoints - 1; i >= 0 && i >= NumPoints - 1 - SearchLength; --i)
+        {
+            if (i == NumPoints - 1 && bFinalJump && GetCell(i) != GoalCell)
+            {
+                continue;
+            }
+            if (GetChebyshevDistance(GetCell(i), GoalCell) <= 1)
+            {
+                Last = i;
+            }
+        }
+        if (First < 0 || Last < 0 || First > Last)
+        {
+            return false;
+        }
+
+        OutPath.clear();
+        OutPath.reserve(Last - First + 3);
+        OutPath.push_back(Start);
+        if (First == 0)
+        {
+            if (CachedStartCell != StartCell)
+            {
+                OutPath.push_back(Grid.GridToWorld(CachedStartCell.X, CachedStartCell.Y, CachedStartCell.Z));
+            }
+            First = 1;
+        }
+        for (int32_t i = First; i <= Last; ++i)
+        {
+            OutPath.push_back(Path[i]);
+        }
+        if (Last == 0 || GetCell(Last) != GoalCell)
+        {
+            OutPath.push_back(Grid.GridToWorld(GoalCell.X, GoalCell.Y, GoalCell.Z));
+        }
+
+        bOutUnchanged = OutPath.size() == Path.size();
+        for (size_t i = 0; i < OutPath.size() && bOutUnchanged; ++i)
+        {
+            bOutUnchanged = OutPath[i].X == Path[i].X && OutPath[i].Y == Path[i].Y && OutPath[i].Z == Path[i].Z;
+        }
+        return true;
+    }
+
+    void FPathCache::Add(const FOccupancyGrid& Grid, const FPlanRequest& Request, const std::vector<FVec3>& Path, uint64_t PlannedEpoch)
+    {
+        FIntVec3 StartCell, GoalCell;
+        if (Path.size() < 2 || MaxEntries <= 0 || PlannedEpoch < FloorEpoch
+            || !Grid.WorldToGrid(Request.Start, StartCell.X, StartCell.Y, StartCell.Z)
+            || !Grid.WorldToGrid(Request.Goal, GoalCell.X, GoalCell.Y, GoalCell.Z))
+        {
+            return;
+        }
+
+        FEntry Entry;
+        Entry.Path = Path;
+
+        // A*的最后一步可能跨两个格子，补上中间与目标共面的空闲格子，使缓存路径逐格相邻、终点可以修补
+        const FIntVec3 BeforeGoal = GetPathCell(Grid, Path[Path.size() - 2]);
+        const FIntVec3 PlannedGoal = GetPathCell(Grid, Path.back());
+        if (GetChebyshevDistance(BeforeGoal, PlannedGoal) > 1)
+        {
+            for (int32_t Direction = 0; Direction < 6; ++Direction)
+            {
+                const FIntVec3 Cell(PlannedGoal.X + GridDirections[Direction].X, PlannedGoal.Y + GridDirections[Direction].Y, PlannedGoal.Z + GridDirections[Direction].Z);
+                if (GetChebyshevDistance(Cell, BeforeGoal) <= 1 && Grid.IsValidCell(Cell.X, Cell.Y, Cell.Z) && !Grid.IsOccupiedCell(Cell.X, Cell.Y, Cell.Z))
+                {
+                    Entry.Path.insert(Entry.Path.end() - 1, Grid.GridToWorld(Cell.X, Cell.Y, Cell.Z));
+                    break;
+                }
+            }
+        }
+        Entry.PlannedEpoch = PlannedEpoch;
+        Entry.LastUsed = ++UseCounter;
+        Entry.Regions.reserve(Entry.Path.size());
+        for (const FVec3& Point : Entry.Path)
+        {
+            const int64_t Region = GetRegionIndex(GetPathCell(Grid, Point));
+            if (Entry.Regions.empty() || Entry.Regions.back() != Region)
+            {
+                Entry.Regions.push_back(Region);
+            }
+        }
+        std::sort(Entry.Regions.begin(), Entry.Regions.end());
+        Entry.Regions.erase(std::unique(Entry.Regions.begin(), Entry.Regions.end()), Entry.Regions.end());
+
+        // 规划期间路径经过的区域已经变化，结果不可复用
+        if (!IsValid(Entry))
+        {
+            return;
+        }
+
+        const FKey Key = MakeKey(StartCell, GoalCell);
+        if (Entries.find(Key) == Entries.end() && (int32_t)Entries.size() >= MaxEntries)
+        {
+            auto Oldest = Entries.begin();
+            for (auto It = Entries.begin(); It != Entries.end(); ++It)
+            {
+                if (It->second.LastUsed < Oldest->second.LastUsed)
+                {
+                    Oldest = It;
+                }
+            }
+            Entries.erase(Oldest);
+        }
+        Entries[Key] = std::move(Entry);
+    }
+
+    void FPathCache::NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed)
+    {
+        if (Changed.IsEmpty())
+        {
+            return;
+        }
+
+        // 裁剪到地图范围后按区域递增版本
+        const FCellBounds GridBounds = Grid.GetBounds();
+        const FIntVec3 Min(std::max(Changed.Min.X, GridBounds.Min.X), std::max(Changed.Min.Y, GridBounds.Min.Y), std::max(Changed.Min.Z, GridBounds.Min.Z));
+        const FIntVec3 Max(std::min(Changed.Max.X, GridBounds.Max.X), std::min(Changed.Max.Y, GridBounds.Max.Y), std::min(Changed.Max.Z, GridBounds.Max.Z));
+        if (Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z)
+        {
+            return;
+        }
+
+        Epoch++;
+        const int32_t Size = GetRegionSize();
+        const int64_t NumRegions = (int64_t)(Max.X / Size - Min.X / Size + 1) * (Max.Y / Size - Min.Y / Size + 1) * (Max.Z / Size - Min.Z / Size + 1);
+        if (NumRegions > PATH_CACHE_MAX_NOTIFY_REGIONS)
+        {
+            Stats.Invalidated += (int32_t)Entries.size();
+            Entries.clear();
+            RegionEpochs.clear();
+            FloorEpoch = Epoch;
+            return;
+        }
+        for (int32_t Z = Min.Z / Size; Z <= Max.Z / Size; ++Z)
+        {
+            for (int32_t Y = Min.Y / Size; Y <= Max.Y / Size; ++Y)
+            {
+                for (int32_t X = Min.X / Size; X <= Max.X / Size; ++X)
+                {
+                    RegionEpochs[PackCacheCoord(X, Y, Z)] = Epoch;
+                }
+            }
+        }
+    }
+
+    void FPathCache::Reset()
+    {
+        Entries.clear();
+        RegionEpochs.clear();
+        FloorEpoch = ++Epoch;
+    }
+}
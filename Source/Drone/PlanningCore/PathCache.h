@@ -0,0 +1,119 @@
+// PathCache.h
+// 规划结果缓存：以量化后的起点/终点格子为键，保存A*输出的原始网格路径（未平滑）。
+// 地图按固定边长的立方体区域记录最后一次变化的版本号，条目记下路径经过的区域，
+// 只有这些区域发生变化后条目才失效。同一量化块内的新起点/终点在命中时接到缓存路径的首尾
+#pragma once
+
+#include "AStarPlanner.h"
+#include "PlanningTypes.h"
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+    class FReservationTable;
+
+    struct FPathCacheStats
+    {
+        int32_t Hits = 0;
+
+        // 命中且起点或终点被修补过的次数（包含在Hits中）
+        int32_t Repairs = 0;
+        int32_t Misses = 0;
+
+        // 因经过的区域发生变化而丢弃的条目数
+        int32_t Invalidated = 0;
+
+        // 地图上仍有效、但与当前预约表冲突而未使用的次数（包含在Misses中）
+        int32_t ReservationConflicts = 0;
+    };
+
+    class FPathCache
+    {
+    public:
+        // 起点/终点按该格子数量化（限制在1~2，保证修补时新端点与缓存路径相邻）
+        int32_t QuantizeCells = 2;
+
+        // 版本区域的边长（格子数），修改后须调用Reset
+        int32_t RegionSize = 16;
+
+        // 条目上限，超出时淘汰最久未使用的条目
+        int32_t MaxEntries = 1024;
+
+        // 查找Request对应的路径。命中时OutPath首点为Request.Start、末点为目标格子中心，中间为缓存的格子中心。
+        // Reservations不为空时按Request.StartTime与DroneSpeed检查预约冲突；
+        // 条目已在同一预约表纪元、同一无人机与起始时间下检查过且路径未修补时跳过检查
+        bool Find(const FOccupancyGrid& Grid, const FReservationTable* Reservations, uint32_t ReservationEpoch,
+            const FPlanRequest& Request, float DroneSpeed, std::vector<FVec3>& OutPath);
+
+        // 缓存Request的规划结果（FAStarPlanner::FindPath的原始路径）。PlannedEpoch为开始规划时的GetEpoch()：
+        // 后台线程在旧地图快照上规划时，之后发生变化的区域会使条目在下次查找时失效
+        void Add(const FOccupancyGrid& Grid, const FPlanRequest& Request, const std::vector<FVec3>& Path, uint64_t PlannedEpoch);
+        void Add(const FOccupancyGrid& Grid, const FPlanRequest& Request, const std::vector<FVec3>& Path) { Add(Grid, Request, Path, Epoch); }
+
+        // Changed范围内的格子占用发生了变化，递增涉及区域的版本
+        void NotifyCellsChanged(const FOccupancyGrid& Grid, const FCellBounds& Changed);
+
+        // 丢弃全部条目（地图重建/加载时使用）
+        void Reset();
+
+        uint64_t GetEpoch() const { return Epoch; }
+        int32_t Num() const { return (int32_t)Entries.size(); }
+        const FPathCacheStats& GetStats() const { return Stats; }
+
+    private:
+        struct FKey
+        {
+            int64_t Start = 0;
+            int64_t Goal = 0;
+
+            bool operator==(const FKey& Other) const { return Start == Other.Start && Goal == Other.Goal; }
+        };
+
+        struct FKeyHash
+        {
+            size_t operator()(const FKey& Key) const
+            {
+                return (size_t)(((uint64_t)Key.Start * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)Key.Goal + 0x7F4A7C159E3779B9ull));
+            }
+        };
+
+        struct FEntry
+        {
+            // 首点为规划时的起点，其余为格子中心（末点为目标格子中心）
+            std::vector<FVec3> Path;
+
+            // 路径经过的区域（排序去重）
+            std::vector<int64_t> Regions;
+            uint64_t PlannedEpoch = 0;
+            uint64_t LastUsed = 0;
+
+            // 最近一次确认无预约冲突时的条件
+            bool bReservationChecked = false;
+            uint32_t CheckedReservationEpoch = 0;
+            int32_t CheckedDroneID = -1;
+            float CheckedStartTime = 0.0f;
+        };
+
+        std::unordered_map<FKey, FEntry, FKeyHash> Entries;
+
+        // 区域最后一次变化时的纪元；条目规划时的纪元早于FloorEpoch时一律无效
+        std::unordered_map<int64_t, uint64_t> RegionEpochs;
+        uint64_t Epoch = 0;
+        uint64_t FloorEpoch = 0;
+        uint64_t UseCounter = 0;
+
+        FPathCacheStats Stats;
+
+        int32_t GetQuantizeCells() const;
+        int32_t GetRegionSize() const;
+        FKey MakeKey(const FIntVec3& StartCell, const FIntVec3& GoalCell) const;
+        int64_t GetRegionIndex(const FIntVec3& Cell) const;
+        bool IsValid(const FEntry& Entry) const;
+
+        // 把新起点/终点接到缓存路径上（26邻域），接不上时返回false
+        bool RepairPath(const FOccupancyGrid& Grid, const FEntry& Entry, const FVec3& Start, const FIntVec3& StartCell,
+            const FIntVec3& GoalCell, std::vector<FVec3>& OutPath, bool& bOutUnchanged) const;
+    };
+}
@@ -0,0 +1,145 @@
+// PathSegmentIndex.cpp
+#include "PathSegmentIndex.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        FIntVec3 PathPointToCell(const FOccupancyGrid& Grid, const FVec3& Point)
+        {
+            FIntVec3 Cell;
+            Grid.WorldToGrid(Point, Cell.X, Cell.Y, Cell.Z);
+            return Cell;
+        }
+    }
+
+    void FPathSegmentIndex::Reset()
+    {
+        Points.clear();
+        SegmentBounds.clear();
+        Chunks.clear();
+    }
+
+    void FPathSegmentIndex::Build(const FOccupancyGrid& Grid, const std::vector<FVec3>& Path)
+    {
+        Reset();
+        Points = Path;
+        if (Path.size() < 2)
+        {
+            return;
+        }
+
+        SegmentBounds.reserve(Path.size() - 1);
+        for (size_t i = 0; i + 1 < Path.size(); ++i)
+        {
+            FCellBounds Bounds;
+            Bounds.Add(PathPointToCell(Grid, Path[i]));
+            Bounds.Add(PathPointToCell(Grid, Path[i + 1]));
+            SegmentBounds.push_back(Bounds);
+
+            // 算术右移即向下取整，地图外的负坐标也落在正确的区块
+            for (int32_t ChunkZ = Bounds.Min.Z >> CHUNK_SHIFT; ChunkZ <= Bounds.Max.Z >> CHUNK_SHIFT; ++ChunkZ)
+            {
+                for (int32_t ChunkY = Bounds.Min.Y >> CHUNK_SHIFT; ChunkY <= Bounds.Max.Y >> CHUNK_SHIFT; ++ChunkY)
+                {
+                    for (int32_t ChunkX = Bounds.Min.X >> CHUNK_SHIFT; ChunkX <= Bounds.Max.X >> CHUNK_SHIFT; ++ChunkX)
+                    {
+                        Chunks[ChunkKey(ChunkX, ChunkY, ChunkZ)].push_back((int32_t)i);
+                    }
+                }
+            }
+        }
+    }
+
+    void FPathSegmentIndex::Query(const FCellBounds& DirtyCells, int32_t FirstSegment, std::vector<int32_t>& OutSegments) const
+    {
+        OutSegments.clear();
+        FirstSegment = std::max(FirstSegment, 0);
+        if (DirtyCells.IsEmpty() || FirstSegment >= NumSegments())
+        {
+            return;
+        }
+
+        const int64_t NumChunksX = (int64_t)(DirtyCells.Max.X >> CHUNK_SHIFT) - (DirtyCells.Min.X >> CHUNK_SHIFT) + 1;
+        const int64_t NumChunksY = (int64_t)(DirtyCells.Max.Y >> CHUNK_SHIFT) - (DirtyCells.Min.Y >> CHUNK_SHIFT) + 1;
+        const int64_t NumChunksZ = (int64_t)(DirtyCells.Max.Z >> CHUNK_SHIFT) - (DirtyCells.Min.Z >> CHUNK_SHIFT) + 1;
+        const int64_t NumRemaining = NumSegments() - FirstSegment;
+
+        if (NumChunksX * NumChunksY * NumChunksZ >= NumRemaining)
+        {
+            // 脏区域很大（例如整图变化）时，直接逐条比较包围盒更快
+            for (int32_t i = FirstSegment; i < NumSegments(); ++i)
+            {
+                if (SegmentBounds[i].Intersects(DirtyCells))
+                {
+                    OutSegments.push_back(i);
+                }
+            }
+            return;
+        }
+
+        for (int32_t ChunkZ = DirtyCells.Min.Z >> CHUNK_SHIFT; ChunkZ <= DirtyCells.Max.Z >> CHUNK_SHIFT; ++ChunkZ)
+        {
+            for (int32_t ChunkY = DirtyCells.Min.Y >> CHUNK_SHIFT; ChunkY <= DirtyCells.Max.Y >> CHUNK_SHIFT; ++ChunkY)
+            {
+                for (int32_t ChunkX = DirtyCells.Min.X >> CHUNK_SHIFT; ChunkX <= DirtyCells.Max.X >> CHUNK_SHIFT; ++ChunkX)
+                {
+                    const auto Found = Chunks.find(ChunkKey(ChunkX, ChunkY, ChunkZ));
+                    if (Found == Chunks.end())
+                    {
+                        continue;
+                    }
+                    for (int32_t Segment : Found->second)
+                    {
+                        if (Segment >= FirstSegment && SegmentBounds[Segment].Intersects(DirtyCells))
+                        {
+                            OutSegments.push_back(Segment);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 跨多个区块的线段会被重复收集
+        std::sort(OutSegments.begin(), OutSegments.end());
+        OutSegments.erase(std::unique(OutSegments.begin(), OutSegments.end()), OutSegments.end());
+    }
+
+    int32_t FPathSegmentIndex::FindFirstBlockedSegment(const FOccupancyGrid& Grid, const FCellBounds& DirtyCells, int32_t FirstSegment) const
+    {
+        std::vector<int32_t> Candidates;
+        Query(DirtyCells, FirstSegment, Candidates);
+        for (int32_t Segment : Candidates)
+        {
+            if (IsSegmentBlocked(Grid, Points[Segment], Points[Segment + 1], DirtyCells))
+            {
+                return Segment;
+            }
+        }
+        return -1;
+    }
+
+    bool FPathSegmentIndex::IsSegmentBlocked(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& End, const FCellBounds& DirtyCells)
+    {
+        auto IsBlockedSample = [&Grid, &DirtyCells](const FVec3& Sample)
+        {
+            int32_t X, Y, Z;
+            return Grid.WorldToGrid(Sample, X, Y, Z) && DirtyCells.Contains(FIntVec3(X, Y, Z))
+                && Grid.IsOccupiedIndex(Grid.GetCellIndex(X, Y, Z));
+        };
+
+        const FVec3 Direction = (End - Start).GetSafeNormal();
+        const double Distance = FVec3::Dist(Start, End);
+        const double StepSize = Grid.GetResolution();
+        for (double Dist = 0; Dist < Distance; Dist += StepSize)
+        {
+            if (IsBlockedSample(Start + Direction * Dist))
+            {
+                return true;
+            }
+        }
+        return IsBlockedSample(End);
+    }
+}
@@ -0,0 +1,43 @@
+// PathSegmentIndex.h
+// 路径线段的空间索引：地图局部变化时只检查与脏区域相交、且尚未飞过的线段
+#pragma once
+
+#include "PlanningTypes.h"
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    class FOccupancyGrid;
+
+    // 线段i连接Path[i]和Path[i+1]。每条线段按网格包围盒登记到覆盖它的所有区块（CHUNK_CELLS^3个格子）中
+    class FPathSegmentIndex
+    {
+    public:
+        void Build(const FOccupancyGrid& Grid, const std::vector<FVec3>& Path);
+        void Reset();
+
+        int32_t NumSegments() const { return (int32_t)SegmentBounds.size(); }
+
+        // 返回与DirtyCells相交且序号不小于FirstSegment的线段，按序号升序
+        void Query(const FCellBounds& DirtyCells, int32_t FirstSegment, std::vector<int32_t>& OutSegments) const;
+
+        // 第一条被占用的线段（只检查落在DirtyCells内的采样点），没有则返回-1
+        int32_t FindFirstBlockedSegment(const FOccupancyGrid& Grid, const FCellBounds& DirtyCells, int32_t FirstSegment) const;
+
+        // 沿线段按分辨率步长采样（含终点），与FPathSmoother::CanReachDirectly的采样方式一致
+        static bool IsSegmentBlocked(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& End, const FCellBounds& DirtyCells);
+
+    private:
+        static constexpr int32_t CHUNK_SHIFT = 3;
+
+        std::vector<FVec3> Points;
+        std::vector<FCellBounds> SegmentBounds;
+        std::unordered_map<uint64_t, std::vector<int32_t>> Chunks;
+
+        static uint64_t ChunkKey(int32_t ChunkX, int32_t ChunkY, int32_t ChunkZ)
+        {
+            return ((uint64_t)(uint32_t)(ChunkX & 0x1FFFFF) << 42) | ((uint64_t)(uint32_t)(ChunkY & 0x1FFFFF) << 21) | (uint64_t)(uint32_t)(ChunkZ & 0x1FFFFF);
+        }
+    };
+}
@@ -0,0 +1,168 @@
+// PathSmoother.cpp
+#include "PathSmoother.h"
+#include "DistanceField.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+
+namespace DronePlanning
+{
+    bool FPathSmoother::IsClearWithin(const FVec3& Point, double Radius) const
+    {
+        if (!DistanceField)
+        {
+            return false;
+        }
+
+        // 距离场记录的是格子中心之间的距离：Point与其格子中心、探测点与其格子中心各相差至多半条体对角线
+        const double HalfDiagonal = Grid.GetResolution() * 0.8660254037844386;
+        return DistanceField->GetDistance(Point) > Radius + 2.0 * HalfDiagonal + 1.e-3;
+    }
+
+    bool FPathSmoother::IsPathPointSafe(const FVec3& Point) const
+    {
+        if (IsClearWithin(Point, SafetyDistance))
+        {
+            return true;
+        }
+
+        // 在水平面上检查8个方向
+        const int32_t NumChecks = 8;
+        const double AngleStep = 2.0 * 3.14159265358979323846 / NumChecks;
+        for (int32_t i = 0; i < NumChecks; i++)
+        {
+            const double Angle = i * AngleStep;
+            const FVec3 Offset(std::cos(Angle) * SafetyDistance, std::sin(Angle) * SafetyDistance, 0.0);
+            if (Grid.IsOccupied(Point + Offset))
+            {
+                return false;
+            }
+        }
+
+        // 检查上下方向
+        return !Grid.IsOccupied(Point + FVec3(0, 0, SafetyDistance))
+            && !Grid.IsOccupied(Point + FVec3(0, 0, -SafetyDistance));
+    }
+
+    FVec3 FPathSmoother::GetObstacleRepulsionForce(const FVec3& Point) const
+    {
+        const double SampleDist = 10.0;          // 周围采样范围
+        const double InfluenceRadius = 100.0;    // 斥力有效距离
+        const double RepulsionStrength = 100.0;  // 斥力系数
+
+        // 6个采样点及其安全检查范围内都没有障碍物时斥力为零
+        if (IsClearWithin(Point, SampleDist + SafetyDistance))
+        {
+            return FVec3();
+        }
+
+        static const FVec3 Directions[6] = {
+            FVec3(1, 0, 0), FVec3(-1, 0, 0),
+            FVec3(0, 1, 0), FVec3(0, -1, 0),
+            FVec3(0, 0, 1), FVec3(0, 0, -1),
+        };
+
+        FVec3 Gradient;
+        for (const FVec3& Dir : Directions)
+        {
+            const FVec3 SamplePoint = Point + Dir * SampleDist;
+            if (!IsPathPointSafe(SamplePoint))
+            {
+                const double Dist = std::max(1.e-4, FVec3::Dist(Point, SamplePoint));
+                const double Force = RepulsionStrength * (1.0 - std::clamp(Dist / InfluenceRadius, 0.0, 1.0));
+                Gradient -= Dir * Force;
+            }
+        }
+        return Gradient;
+    }
+
+    bool FPathSmoother::SmoothPath(std::vector<FVec3>& InOutPath) const
+    {
+        if (InOutPath.size() < 3) return true;  // 至少需要3个点才能平滑
+
+        const double SmoothingWeight = 0.5;  // 平滑权重
+        const int32_t Iterations = 5;        // 平滑迭代次数
+        const double ObstacleWeight = 0.05;  // 斥力惩罚项权重
+
+        std::vector<FVec3> SmoothedPath = InOutPath;
+        bool bIsPathSafe = true;
+
+        for (int32_t Iter = 0; Iter < Iterations && bIsPathSafe; Iter++)
+        {
+            const std::vector<FVec3> TempPath = SmoothedPath;
+
+            // 保持起点和终点不变，只平滑中间点
+            for (size_t i = 1; i + 1 < SmoothedPath.size(); i++)
+            {
+                const FVec3& PrevPoint = TempPath[i - 1];
+                const FVec3& NextPoint = TempPath[i + 1];
+                const FVec3& CurrentPoint = TempPath[i];
+
+                const FVec3 SmoothTerm = (PrevPoint + NextPoint) * 0.5 - CurrentPoint;
+                const FVec3 ObstacleForce = GetObstacleRepulsionForce(CurrentPoint);
+                const FVec3 SmoothedPoint = CurrentPoint + SmoothTerm * SmoothingWeight + ObstacleForce * ObstacleWeight;
+
+                // 平滑后的点及其前后连线都必须安全
+                if (!IsPathPointSafe(SmoothedPoint)
+                    || !CanReachDirectly(SmoothedPoint, PrevPoint)
+                    || !CanReachDirectly(SmoothedPoint, NextPoint))
+                {
+                    bIsPathSafe = false;
+                    break;
+                }
+
+                SmoothedPath[i] = SmoothedPoint;
+            }
+        }
+
+        // 发现不安全的点，保持原始路径
+        if (!bIsPathSafe)
+        {
+            return false;
+        }
+
+        // 最后一次检查整条路径的安全性
+        for (size_t i = 0; i + 1 < SmoothedPath.size(); i++)
+        {
+            if (!CanReachDirectly(SmoothedPath[i], SmoothedPath[i + 1]))
+            {
+                return false;
+            }
+        }
+
+        InOutPath = std::move(SmoothedPath);
+        return true;
+    }
+
+    bool FPathSmoother::CanReachDirectly(const FVec3& Start, const FVec3& Goal) const
+    {
+        const FVec3 Direction = (Goal - Start).GetSafeNormal();
+        const double Distance = FVec3::Dist(Start, Goal);
+        const double StepSize = Grid.GetResolution();
+        const double HalfDiagonal = StepSize * 0.8660254037844386;
+
+        for (double Dist = 0; Dist < Distance; )
+        {
+            const FVec3 Sample = Start + Direction * Dist;
+            if (Grid.IsOccupied(Sample))
+            {
+                return false;
+            }
+
+            // 距离场保证与Sample相距不到Clearance的采样点都是空闲的，直接跳过（逐步累加，采样位置与不跳过时相同）
+            int64_t Skip = 1;
+            if (DistanceField)
+            {
+                const double Clearance = DistanceField->GetDistance(Sample) - 2.0 * HalfDiagonal - 1.e-3;
+                if (Clearance > StepSize)
+                {
+                    Skip = (int64_t)std::ceil(Clearance / StepSize);
+                }
+            }
+            for (int64_t i = 0; i < Skip; ++i)
+            {
+                Dist += StepSize;
+            }
+        }
+        return true;
+    }
+}
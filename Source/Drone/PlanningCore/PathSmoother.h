@@ -0,0 +1,41 @@
+// PathSmoother.h
+#pragma once
+
+#include "PlanningTypes.h"
+#include <vector>
+
+namespace DronePlanning
+{
+    class FDistanceField;
+    class FOccupancyGrid;
+
+    // 基于障碍物斥力的迭代路径平滑，平滑结果不安全时回退到原始路径。
+    // 提供与Grid同步的距离场时，远离障碍物的点只需一次查询即可判定安全，结果与逐点采样完全相同
+    class FPathSmoother
+    {
+    public:
+        FPathSmoother(const FOccupancyGrid& InGrid, float InSafetyDistance, const FDistanceField* InDistanceField = nullptr)
+            : Grid(InGrid), SafetyDistance(InSafetyDistance), DistanceField(InDistanceField)
+        {
+        }
+
+        // 返回true表示采用了平滑后的路径，false表示保持原始路径
+        bool SmoothPath(std::vector<FVec3>& InOutPath) const;
+
+        // 检查点周围安全距离内是否有障碍物
+        bool IsPathPointSafe(const FVec3& Point) const;
+
+        // 检查两点之间是否可以直线到达
+        bool CanReachDirectly(const FVec3& Start, const FVec3& Goal) const;
+
+        FVec3 GetObstacleRepulsionForce(const FVec3& Point) const;
+
+    private:
+        const FOccupancyGrid& Grid;
+        float SafetyDistance;
+        const FDistanceField* DistanceField;
+
+        // 距离场给出的、Point周围Radius内所有点都不落在占用格子里的保证
+        bool IsClearWithin(const FVec3& Point, double Radius) const;
+    };
+}
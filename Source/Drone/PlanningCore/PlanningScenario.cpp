@@ -0,0 +1,51 @@
+// PlanningScenario.cpp
+#include "PlanningScenario.h"
+#include <cstdio>
+
+namespace DronePlanning
+{
+    bool SaveQueriesToFile(const std::string& FilePath, const std::vector<FPlanQuery>& Queries)
+    {
+        FILE* File = std::fopen(FilePath.c_str(), "w");
+        if (!File)
+        {
+            return false;
+        }
+        std::fprintf(File, "# DroneID StartX StartY StartZ GoalX GoalY GoalZ\n");
+        for (const FPlanQuery& Query : Queries)
+        {
+            std::fprintf(File, "%d %.3f %.3f %.3f %.3f %.3f %.3f\n", Query.DroneID,
+                Query.Start.X, Query.Start.Y, Query.Start.Z,
+                Query.Goal.X, Query.Goal.Y, Query.Goal.Z);
+        }
+        return std::fclose(File) == 0;
+    }
+
+    bool LoadQueriesFromFile(const std::string& FilePath, std::vector<FPlanQuery>& OutQueries)
+    {
+        FILE* File = std::fopen(FilePath.c_str(), "r");
+        if (!File)
+        {
+            return false;
+        }
+
+        OutQueries.clear();
+        char Line[512];
+        while (std::fgets(Line, sizeof(Line), File))
+        {
+            if (Line[0] == '#' || Line[0] == '\n' || Line[0] == '\r')
+            {
+                continue;
+            }
+            FPlanQuery Query;
+            if (std::sscanf(Line, "%d %lf %lf %lf %lf %lf %lf", &Query.DroneID,
+                &Query.Start.X, &Query.Start.Y, &Query.Start.Z,
+                &Query.Goal.X, &Query.Goal.Y, &Query.Goal.Z) == 7)
+            {
+                OutQueries.push_back(Query);
+            }
+        }
+        std::fclose(File);
+        return true;
+    }
+}
@@ -0,0 +1,21 @@
+// PlanningScenario.h
+// 录制的起终点集合，配合FOccupancyGrid::SaveToFile用于离线回放规划
+#pragma once
+
+#include "PlanningTypes.h"
+#include <string>
+#include <vector>
+
+namespace DronePlanning
+{
+    struct FPlanQuery
+    {
+        int32_t DroneID = -1;
+        FVec3 Start;
+        FVec3 Goal;
+    };
+
+    // 文本格式，每行: DroneID StartX StartY StartZ GoalX GoalY GoalZ，'#'开头为注释
+    bool SaveQueriesToFile(const std::string& FilePath, const std::vector<FPlanQuery>& Queries);
+    bool LoadQueriesFromFile(const std::string& FilePath, std::vector<FPlanQuery>& OutQueries);
+}
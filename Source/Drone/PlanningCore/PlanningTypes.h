@@ -0,0 +1,101 @@
+// PlanningTypes.h
+// 路径规划核心库的基础类型。该目录下的代码不依赖UObject/引擎模块，
+// 既被Drone模块中的组件使用，也可以单独编译进无头基准测试程序。
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace DronePlanning
+{
+    // 世界坐标（厘米），与UE5的FVector保持相同的双精度
+    struct FVec3
+    {
+        double X = 0.0;
+        double Y = 0.0;
+        double Z = 0.0;
+
+        FVec3() = default;
+        FVec3(double InX, double InY, double InZ) : X(InX), Y(InY), Z(InZ) {}
+
+        FVec3 operator+(const FVec3& Other) const { return FVec3(X + Other.X, Y + Other.Y, Z + Other.Z); }
+        FVec3 operator-(const FVec3& Other) const { return FVec3(X - Other.X, Y - Other.Y, Z - Other.Z); }
+        FVec3 operator-() const { return FVec3(-X, -Y, -Z); }
+        FVec3 operator*(double Scale) const { return FVec3(X * Scale, Y * Scale, Z * Scale); }
+        FVec3 operator/(double Scale) const { return FVec3(X / Scale, Y / Scale, Z / Scale); }
+        FVec3& operator+=(const FVec3& Other) { X += Other.X; Y += Other.Y; Z += Other.Z; return *this; }
+        FVec3& operator-=(const FVec3& Other) { X -= Other.X; Y -= Other.Y; Z -= Other.Z; return *this; }
+
+        double SizeSquared() const { return X * X + Y * Y + Z * Z; }
+        double Size() const { return std::sqrt(SizeSquared()); }
+
+        FVec3 GetSafeNormal() const
+        {
+            const double SquareSum = SizeSquared();
+            if (SquareSum < 1.e-8)
+            {
+                return FVec3();
+            }
+            return *this * (1.0 / std::sqrt(SquareSum));
+        }
+
+        static double Dist(const FVec3& A, const FVec3& B) { return (A - B).Size(); }
+        static double DistSquared(const FVec3& A, const FVec3& B) { return (A - B).SizeSquared(); }
+    };
+
+    inline FVec3 operator*(double Scale, const FVec3& V) { return V * Scale; }
+
+    // 网格坐标
+    struct FIntVec3
+    {
+        int32_t X = 0;
+        int32_t Y = 0;
+        int32_t Z = 0;
+
+        FIntVec3() = default;
+        FIntVec3(int32_t InX, int32_t InY, int32_t InZ) : X(InX), Y(InY), Z(InZ) {}
+
+        bool operator==(const FIntVec3& Other) const { return X == Other.X && Y == Other.Y && Z == Other.Z; }
+        bool operator!=(const FIntVec3& Other) const { return !(*this == Other); }
+    };
+
+    // 网格坐标的轴对齐包围盒（闭区间），默认构造为空
+    struct FCellBounds
+    {
+        FIntVec3 Min = FIntVec3(INT32_MAX, INT32_MAX, INT32_MAX);
+        FIntVec3 Max = FIntVec3(INT32_MIN, INT32_MIN, INT32_MIN);
+
+        FCellBounds() = default;
+        FCellBounds(const FIntVec3& InMin, const FIntVec3& InMax) : Min(InMin), Max(InMax) {}
+
+        bool IsEmpty() const { return Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z; }
+
+        void Add(const FIntVec3& Cell)
+        {
+            Min = FIntVec3(std::min(Min.X, Cell.X), std::min(Min.Y, Cell.Y), std::min(Min.Z, Cell.Z));
+            Max = FIntVec3(std::max(Max.X, Cell.X), std::max(Max.Y, Cell.Y), std::max(Max.Z, Cell.Z));
+        }
+
+        void Add(const FCellBounds& Other)
+        {
+            if (!Other.IsEmpty())
+            {
+                Add(Other.Min);
+                Add(Other.Max);
+            }
+        }
+
+        bool Contains(const FIntVec3& Cell) const
+        {
+            return Cell.X >= Min.X && Cell.X <= Max.X && Cell.Y >= Min.Y && Cell.Y <= Max.Y && Cell.Z >= Min.Z && Cell.Z <= Max.Z;
+        }
+
+        bool Intersects(const FCellBounds& Other) const
+        {
+            return Min.X <= Other.Max.X && Max.X >= Other.Min.X
+                && Min.Y <= Other.Max.Y && Max.Y >= Other.Min.Y
+                && Min.Z <= Other.Max.Z && Max.Z >= Other.Min.Z;
+        }
+    };
+}
@@ -0,0 +1,322 @@
+// ReservationTable.cpp
+#include "ReservationTable.h"
+#include <algorithm>
+#include <cmath>
+
+namespace DronePlanning
+{
+    namespace
+    {
+        uint64_t MakeReservationBucketKey(int32_t CellX, int32_t CellY, int32_t CellZ, int32_t Slice)
+        {
+            // 每个分量截断为16位；不同桶偶尔共用一个键只会多检查几段预约，不影响结果
+            return ((uint64_t)(uint16_t)CellX)
+                | ((uint64_t)(uint16_t)CellY << 16)
+                | ((uint64_t)(uint16_t)CellZ << 32)
+                | ((uint64_t)(uint16_t)Slice << 48);
+        }
+
+        // 把Segment切成长度不超过BucketSize、时长不超过BucketDuration的小段，对每一小段（空间上向外扩展Expand）
+        // 经过的每个桶调用Visit(Key)；Visit返回true时提前结束并返回true。相邻小段的桶可能重复
+        template <typename FVisitor>
+        bool ForEachReservationBucket(const FSpaceTimeSegment& Segment, double Expand, double BucketSize, double BucketDuration, FVisitor&& Visit)
+        {
+            const FVec3 Delta = Segment.To - Segment.From;
+            const double Duration = std::max(0.0, (double)Segment.EndTime - Segment.BeginTime);
+            const int32_t NumPieces = std::max({ 1,
+                (int32_t)std::ceil(Delta.Size() / BucketSize),
+                (int32_t)std::ceil(Duration / BucketDuration) });
+
+            for (int32_t Piece = 0; Piece < NumPieces; ++Piece)
+            {
+                const double Alpha0 = (double)Piece / NumPieces;
+                const double Alpha1 = (double)(Piece + 1) / NumPieces;
+                const FVec3 P0 = Segment.From + Delta * Alpha0;
+                const FVec3 P1 = Segment.From + Delta * Alpha1;
+
+                const int32_t MinX = (int32_t)std::floor((std::min(P0.X, P1.X) - Expand) / BucketSize);
+                const int32_t MaxX = (int32_t)std::floor((std::max(P0.X, P1.X) + Expand) / BucketSize);
+                const int32_t MinY = (int32_t)std::floor((std::min(P0.Y, P1.Y) - Expand) / BucketSize);
+                const int32_t MaxY = (int32_t)std::floor((std::max(P0.Y, P1.Y) + Expand) / BucketSize);
+                const int32_t MinZ = (int32_t)std::floor((std::min(P0.Z, P1.Z) - Expand) / BucketSize);
+                const int32_t MaxZ = (int32_t)std::floor((std::max(P0.Z, P1.Z) + Expand) / BucketSize);
+                const int32_t MinSlice = (int32_t)std::floor((Segment.BeginTime + Duration * Alpha0) / BucketDuration);
+                const int32_t MaxSlice = (int32_t)std::floor((Segment.BeginTime + Duration * Alpha1) / BucketDuration);
+
+                for (int32_t Slice = MinSlice; Slice <= MaxSlice; ++Slice)
+                {
+                    for (int32_t Z = MinZ; Z <= MaxZ; ++Z)
+                    {
+                        for (int32_t Y = MinY; Y <= MaxY; ++Y)
+                        {
+                            for (int32_t X = MinX; X <= MaxX; ++X)
+                            {
+                                if (Visit(MakeReservationBucketKey(X, Y, Z, Slice)))
+                                {
+                                    return true;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        FVec3 GetSegmentVelocity(const FSpaceTimeSegment& Segment)
+        {
+            const float Duration = Segment.EndTime - Segment.BeginTime;
+            return Duration > 0.0f ? (Segment.To - Segment.From) / Duration : FVec3();
+        }
+    }
+
+    FVec3 FSpaceTimeSegment::GetPositionAt(float AbsTime) const
+    {
+        if (EndTime <= BeginTime)
+        {
+            return From;
+        }
+        const double Alpha = std::min(1.0, std::max(0.0, ((double)AbsTime - BeginTime) / ((double)EndTime - BeginTime)));
+        return From + (To - From) * Alpha;
+    }
+
+    FReservationTable::FReservationTable(float InConflictRadius, float InTimeWindow)
+        : ConflictRadius(InConflictRadius), TimeWindow(InTimeWindow),
+          BucketSize(2.0 * InConflictRadius), BucketDuration(std::max(2.0 * InTimeWindow, 1.0))
+    {
+    }
+
+    void FReservationTable::Reserve(int32_t DroneID, FSampleList Samples)
+    {
+        FSampleList& Entry = Entries[DroneID];
+        UnindexSamples(DroneID, Entry);
+        Entry = std::move(Samples);
+        IndexSamples(DroneID, Entry);
+    }
+
+    void FReservationTable::Remove(int32_t DroneID)
+    {
+        auto It = Entries.find(DroneID);
+        if (It == Entries.end())
+        {
+            return;
+        }
+        UnindexSamples(DroneID, It->second);
+        Entries.erase(It);
+    }
+
+    void FReservationTable::Clear()
+    {
+        Entries.clear();
+        Buckets.clear();
+    }
+
+    void FReservationTable::Delay(int32_t DroneID, float FromTime, float DelaySeconds)
+    {
+        auto It = Entries.find(DroneID);
+        if (It == Entries.end())
+        {
+            return;
+        }
+        // 时间改变后线段可能落入其他时间片，整条预约重新登记
+        UnindexSamples(DroneID, It->second);
+        for (FSpaceTimeSample& Sample : It->second)
+        {
+            if (Sample.AbsTime >= FromTime)
+            {
+                Sample.AbsTime += DelaySeconds;
+            }
+        }
+        IndexSamples(DroneID, It->second);
+    }
+
+    bool FReservationTable::IsConflict(const FVec3& Position, float AbsTime, int32_t SelfDroneID) const
+    {
+        FSpaceTimeSegment Segment;
+        int32_t DroneID = -1;
+        return FindConflict(FSpaceTimeSegment(Position, AbsTime - TimeWindow, Position, AbsTime + TimeWindow), SelfDroneID, Segment, DroneID);
+    }
+
+    bool FReservationTable::IsSegmentConflict(const FVec3& From, float FromTime, const FVec3& To, float ToTime, int32_t SelfDroneID) const
+    {
+        FSpaceTimeSegment Segment;
+        int32_t DroneID = -1;
+        return FindConflict(FSpaceTimeSegment(From, FromTime, To, ToTime), SelfDroneID, Segment, DroneID);
+    }
+
+    bool FReservationTable::IsPathConflict(const FSampleList& Samples, int32_t SelfDroneID) const
+    {
+        if (Buckets.empty())
+        {
+            return false;
+        }
+        std::vector<FSpaceTimeSegment> Segments;
+        BuildSegments(Samples, Segments);
+        FSpaceTimeSegment Other;
+        int32_t DroneID = -1;
+        for (const FSpaceTimeSegment& Segment : Segments)
+        {
+            if (FindConflict(Segment, SelfDroneID, Other, DroneID))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool FReservationTable::FindConflict(const FSpaceTimeSegment& Segment, int32_t SelfDroneID,
+        FSpaceTimeSegment& OutSegment, int32_t& OutDroneID) const
+    {
+        if (Buckets.empty())
+        {
+            return false;
+        }
+
+        // 登记时已向外扩展冲突半径，查询线段本身经过的桶即包含所有候选
+        return ForEachReservationBucket(Segment, 0.0, BucketSize, BucketDuration, [&](uint64_t Key)
+        {
+            auto It = Buckets.find(Key);
+            if (It == Buckets.end())
+            {
+                return false;
+            }
+            for (const FIndexedSegment& Indexed : It->second)
+            {
+                if (Indexed.DroneID != SelfDroneID && IsSegmentPairConflict(Segment, Indexed.Segment, ConflictRadius))
+                {
+                    OutSegment = Indexed.Segment;
+                    OutDroneID = Indexed.DroneID;
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    const FReservationTable::FSampleList* FReservationTable::Find(int32_t DroneID) const
+    {
+        auto It = Entries.find(DroneID);
+        return It != Entries.end() ? &It->second : nullptr;
+    }
+
+    std::vector<int32_t> FReservationTable::GetDroneIDs() const
+    {
+        std::vector<int32_t> DroneIDs;
+        DroneIDs.reserve(Entries.size());
+        for (const auto& Elem : Entries)
+        {
+            DroneIDs.push_back(Elem.first);
+        }
+        std::sort(DroneIDs.begin(), DroneIDs.end());
+        return DroneIDs;
+    }
+
+    void FReservationTable::BuildSegments(const FSampleList& Samples, std::vector<FSpaceTimeSegment>& OutSegments) const
+    {
+        OutSegments.clear();
+        if (Samples.size() == 1)
+        {
+            const FSpaceTimeSample& Sample = Samples[0];
+            OutSegments.emplace_back(Sample.Position, Sample.AbsTime - TimeWindow, Sample.Position, Sample.AbsTime + TimeWindow);
+            return;
+        }
+        OutSegments.reserve(Samples.size());
+        for (size_t i = 0; i + 1 < Samples.size(); ++i)
+        {
+            OutSegments.emplace_back(Samples[i].Position, Samples[i].AbsTime, Samples[i + 1].Position, Samples[i + 1].AbsTime);
+        }
+    }
+
+    FReservationTable::FSampleList FReservationTable::BuildSamples(const std::vector<FVec3>& Path, float Speed, float StartTime)
+    {
+        FSampleList Samples;
+        Samples.reserve(Path.size());
+        float AccumTime = 0.0f;
+        for (size_t i = 0; i + 1 < Path.size(); ++i)
+        {
+            const float SegmentTime = (float)FVec3::Dist(Path[i], Path[i + 1]) / Speed;
+            Samples.emplace_back(Path[i], StartTime + AccumTime);
+            AccumTime += SegmentTime;
+        }
+        if (!Path.empty())
+        {
+            Samples.emplace_back(Path.back(), StartTime + AccumTime);
+        }
+        return Samples;
+    }
+
+    bool FReservationTable::IsSegmentPairConflict(const FSpaceTimeSegment& A, const FSpaceTimeSegment& B, float Radius)
+    {
+        const float Begin = std::max(A.BeginTime, B.BeginTime);
+        const float End = std::min(A.EndTime, B.EndTime);
+        if (Begin > End)
+        {
+            return false;
+        }
+
+        // 相对运动 D(s) = D0 + Velocity * s，s ∈ [0, End - Begin]，|D(s)|²为开口向上的二次函数
+        const FVec3 D0 = A.GetPositionAt(Begin) - B.GetPositionAt(Begin);
+        const FVec3 Velocity = GetSegmentVelocity(A) - GetSegmentVelocity(B);
+        const double RadiusSquared = (double)Radius * Radius;
+        const double SpeedSquared = Velocity.SizeSquared();
+        const double Approach = D0.X * Velocity.X + D0.Y * Velocity.Y + D0.Z * Velocity.Z;
+        if (SpeedSquared < 1.e-12)
+        {
+            return D0.SizeSquared() < RadiusSquared;
+        }
+        if (Approach >= 0.0)
+        {
+            // 最近点在区间开始处且之后一直远离
+            return false;
+        }
+        const double ClosestS = std::min(-Approach / SpeedSquared, (double)End - Begin);
+        return (D0 + Velocity * ClosestS).SizeSquared() < RadiusSquared;
+    }
+
+    void FReservationTable::IndexSamples(int32_t DroneID, const FSampleList& Samples)
+    {
+        std::vector<FSpaceTimeSegment> Segments;
+        BuildSegments(Samples, Segments);
+        std::vector<uint64_t> Keys;
+        for (const FSpaceTimeSegment& Segment : Segments)
+        {
+            Keys.clear();
+            ForEachReservationBucket(Segment, ConflictRadius, BucketSize, BucketDuration, [&Keys](uint64_t Key)
+            {
+                Keys.push_back(Key);
+                return false;
+            });
+            std::sort(Keys.begin(), Keys.end());
+            Keys.erase(std::unique(Keys.begin(), Keys.end()), Keys.end());
+            for (uint64_t Key : Keys)
+            {
+                Buckets[Key].push_back({ Segment, DroneID });
+            }
+        }
+    }
+
+    void FReservationTable::UnindexSamples(int32_t DroneID, const FSampleList& Samples)
+    {
+        std::vector<FSpaceTimeSegment> Segments;
+        BuildSegments(Samples, Segments);
+        for (const FSpaceTimeSegment& Segment : Segments)
+        {
+            ForEachReservationBucket(Segment, ConflictRadius, BucketSize, BucketDuration, [&](uint64_t Key)
+            {
+                auto It = Buckets.find(Key);
+                if (It == Buckets.end())
+                {
+                    return false;
+                }
+                std::vector<FIndexedSegment>& Bucket = It->second;
+                Bucket.erase(std::remove_if(Bucket.begin(), Bucket.end(),
+                    [DroneID](const FIndexedSegment& Indexed) { return Indexed.DroneID == DroneID; }), Bucket.end());
+                if (Bucket.empty())
+                {
+                    Buckets.erase(It);
+                }
+                return false;
+            });
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// ReservationTable.h
+#pragma once
+
+#include "PlanningTypes.h"
+#include <unordered_map>
+#include <vector>
+
+namespace DronePlanning
+{
+    struct FSpaceTimeSample
+    {
+        FVec3 Position;
+        float AbsTime = 0.0f; // 绝对时间（相对于程序启动）
+
+        FSpaceTimeSample() = default;
+        FSpaceTimeSample(const FVec3& InPos, float InAbsTime) : Position(InPos), AbsTime(InAbsTime) {}
+    };
+
+    // 时空线段：BeginTime时位于From，匀速直线运动到EndTime时位于To。From与To相同时表示悬停
+    struct FSpaceTimeSegment
+    {
+        FVec3 From;
+        FVec3 To;
+        float BeginTime = 0.0f;
+        float EndTime = 0.0f;
+
+        FSpaceTimeSegment() = default;
+        FSpaceTimeSegment(const FVec3& InFrom, float InBeginTime, const FVec3& InTo, float InEndTime)
+            : From(InFrom), To(InTo), BeginTime(InBeginTime), EndTime(InEndTime) {}
+
+        FVec3 GetPositionAt(float AbsTime) const;
+    };
+
+    // 时空预约表：每架无人机的预约是按到达时间排列的路径点，相邻两点之间视为匀速直线运动（时空折线）。
+    // 冲突检测是线段对线段的最近距离测试：两段在公共时间区间内的最小距离小于冲突半径即冲突，
+    // 路径点之间的冲突不会漏掉。线段按长度切成不超过一个索引格的小段，登记在按(空间格, 时间片)分桶的哈希索引中，
+    // 查询只访问查询线段附近的桶，与无人机数量和路径长度无关
+    class FReservationTable
+    {
+    public:
+        using FSampleList = std::vector<FSpaceTimeSample>;
+
+        // InConflictRadius: 同一时刻距离小于该值视为冲突（厘米）
+        // InTimeWindow: 单个时空点（只有一个路径点的预约、IsConflict的查询点）视为在该点悬停 ±InTimeWindow 秒
+        explicit FReservationTable(float InConflictRadius = 160.0f, float InTimeWindow = 0.04f);
+
+        float GetConflictRadius() const { return ConflictRadius; }
+        float GetTimeWindow() const { return TimeWindow; }
+
+        void Reserve(int32_t DroneID, FSampleList Samples);
+        void Remove(int32_t DroneID);
+        void Clear();
+
+        // 将DroneID在FromTime之后的预约整体推迟DelaySeconds秒（推迟前的最后一段相应变慢，相当于原地等待）
+        void Delay(int32_t DroneID, float FromTime, float DelaySeconds);
+
+        // 在Position悬停 AbsTime ± TimeWindow 是否与其他无人机的预约冲突
+        bool IsConflict(const FVec3& Position, float AbsTime, int32_t SelfDroneID) const;
+
+        // 从From（FromTime）匀速飞到To（ToTime）是否与其他无人机的预约冲突
+        bool IsSegmentConflict(const FVec3& From, float FromTime, const FVec3& To, float ToTime, int32_t SelfDroneID) const;
+
+        // 按Samples飞行的整条路径是否与其他无人机的预约冲突
+        bool IsPathConflict(const FSampleList& Samples, int32_t SelfDroneID) const;
+
+        // 同IsSegmentConflict，冲突时返回找到的第一段预约及其所属无人机
+        bool FindConflict(const FSpaceTimeSegment& Segment, int32_t SelfDroneID, FSpaceTimeSegment& OutSegment, int32_t& OutDroneID) const;
+
+        bool Contains(int32_t DroneID) const { return Entries.count(DroneID) > 0; }
+        const FSampleList* Find(int32_t DroneID) const;
+        int32_t Num() const { return (int32_t)Entries.size(); }
+
+        // 按DroneID升序返回所有ID
+        std::vector<int32_t> GetDroneIDs() const;
+
+        // 预约点对应的时空线段：相邻两点一段，只有一个点时为 ±TimeWindow 的悬停
+        void BuildSegments(const FSampleList& Samples, std::vector<FSpaceTimeSegment>& OutSegments) const;
+
+        // 由路径和速度生成预约点
+        static FSampleList BuildSamples(const std::vector<FVec3>& Path, float Speed, float StartTime);
+
+        // 两段运动在公共时间区间内是否有距离小于Radius的时刻。区间开始时已在Radius内且正在远离的不算冲突
+        // （如相邻起飞的无人机各自离开），因此连续的折线只会在相互接近的那一段报告冲突
+        static bool IsSegmentPairConflict(const FSpaceTimeSegment& A, const FSpaceTimeSegment& B, float Radius);
+
+    private:
+        struct FIndexedSegment
+        {
+            FSpaceTimeSegment Segment;
+            int32_t DroneID;
+        };
+
+        float ConflictRadius;
+        float TimeWindow;
+
+        // 索引格边长为2*ConflictRadius，时间片不短于1秒；线段按索引格边长与时间片切分后，
+        // 每一小段在每个维度上最多跨越两个桶
+        double BucketSize;
+        double BucketDuration;
+
+        std::unordered_map<int32_t, FSampleList> Entries;
+        std::unordered_map<uint64_t, std::vector<FIndexedSegment>> Buckets;
+
+        void IndexSamples(int32_t DroneID, const FSampleList& Samples);
+        void UnindexSamples(int32_t DroneID, const FSampleList& Samples);
+    };
+}
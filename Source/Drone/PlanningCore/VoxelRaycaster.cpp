@@ -0,0 +1,24 @@
+// VoxelRaycaster.cpp
+#include "VoxelRaycaster.h"
+
+namespace DronePlanning
+{
+    bool FVoxelRaycaster::Raycast(const FVec3& Start, const FVec3& End, FVoxelHit& OutHit) const
+    {
+        bool bHit = false;
+        TraverseCells(Grid, Start, End, [&](int32_t X, int32_t Y, int32_t Z, double T)
+        {
+            if (!Grid.IsOccupiedIndex(Grid.GetCellIndex(X, Y, Z)))
+            {
+                return true;
+            }
+            const FVec3 Delta = End - Start;
+            OutHit.Location = Start + Delta * T;
+            OutHit.Distance = T * Delta.Size();
+            OutHit.Cell = FIntVec3(X, Y, Z);
+            bHit = true;
+            return false;
+        });
+        return bHit;
+    }
+}
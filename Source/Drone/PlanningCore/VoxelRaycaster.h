@@ -0,0 +1,130 @@
+// VoxelRaycaster.h
+// 在占用栅格上做射线求交（Amanatides-Woo 3D-DDA），供激光扫描在工作线程上替代物理射线检测
+#pragma once
+
+#include "OccupancyGrid.h"
+#include "PlanningTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace DronePlanning
+{
+    struct FVoxelHit
+    {
+        FVec3 Location;        // 射线进入被占用格子的位置
+        double Distance = 0.0; // 与起点的距离
+        FIntVec3 Cell;
+    };
+
+    // 只读取栅格，可在多个线程上同时调用（栅格在此期间不能被修改）
+    class FVoxelRaycaster
+    {
+    public:
+        explicit FVoxelRaycaster(const FOccupancyGrid& InGrid) : Grid(InGrid) {}
+
+        // 返回Start->End线段上的第一个被占用格子；起点已在占用格子内时命中点即为起点
+        bool Raycast(const FVec3& Start, const FVec3& End, FVoxelHit& OutHit) const;
+
+        // 按顺序访问Start->End线段（裁剪到地图范围内）穿过的每个格子。
+        // Visit(X, Y, Z, T)中T为进入该格子时的线段参数（[0, 1]），返回false时停止遍历
+        template <typename VisitorType>
+        static void TraverseCells(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& End, VisitorType&& Visit);
+
+    private:
+        const FOccupancyGrid& Grid;
+    };
+
+    template <typename VisitorType>
+    void FVoxelRaycaster::TraverseCells(const FOccupancyGrid& Grid, const FVec3& Start, const FVec3& End, VisitorType&& Visit)
+    {
+        if (!Grid.IsInitialized())
+        {
+            return;
+        }
+
+        const double Origin[3] = { Grid.GetOrigin().X, Grid.GetOrigin().Y, Grid.GetOrigin().Z };
+        const int32_t Dim[3] = { Grid.GetDimX(), Grid.GetDimY(), Grid.GetDimZ() };
+        const double CellSize = Grid.GetResolution();
+        const double From[3] = { Start.X, Start.Y, Start.Z };
+        const FVec3 Delta = End - Start;
+        const double Dir[3] = { Delta.X, Delta.Y, Delta.Z };
+
+        // 先把线段裁剪到地图包围盒内（参数t在[0, 1]上）
+        double EnterT = 0.0;
+        double ExitT = 1.0;
+        for (int32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            const double Min = Origin[Axis];
+            const double Max = Origin[Axis] + Dim[Axis] * CellSize;
+            if (Dir[Axis] == 0.0)
+            {
+                if (From[Axis] < Min || From[Axis] >= Max)
+                {
+                    return;
+                }
+                continue;
+            }
+            double T0 = (Min - From[Axis]) / Dir[Axis];
+            double T1 = (Max - From[Axis]) / Dir[Axis];
+            if (T0 > T1)
+            {
+                std::swap(T0, T1);
+            }
+            EnterT = std::max(EnterT, T0);
+            ExitT = std::min(ExitT, T1);
+            if (EnterT > ExitT)
+            {
+                return;
+            }
+        }
+
+        int32_t Cell[3];
+        int32_t Step[3];
+        double NextT[3];
+        double DeltaT[3];
+        for (int32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            const double Entry = From[Axis] + Dir[Axis] * EnterT;
+            Cell[Axis] = std::min(std::max((int32_t)std::floor((Entry - Origin[Axis]) / CellSize), 0), Dim[Axis] - 1);
+            if (Dir[Axis] > 0.0)
+            {
+                Step[Axis] = 1;
+                NextT[Axis] = (Origin[Axis] + (Cell[Axis] + 1) * CellSize - From[Axis]) / Dir[Axis];
+                DeltaT[Axis] = CellSize / Dir[Axis];
+            }
+            else if (Dir[Axis] < 0.0)
+            {
+                Step[Axis] = -1;
+                NextT[Axis] = (Origin[Axis] + Cell[Axis] * CellSize - From[Axis]) / Dir[Axis];
+                DeltaT[Axis] = -CellSize / Dir[Axis];
+            }
+            else
+            {
+                Step[Axis] = 0;
+                NextT[Axis] = std::numeric_limits<double>::infinity();
+                DeltaT[Axis] = std::numeric_limits<double>::infinity();
+            }
+        }
+
+        // 逐格前进：每次跨过离当前位置最近的一个格子边界
+        double T = EnterT;
+        while (Visit(Cell[0], Cell[1], Cell[2], T))
+        {
+            const int32_t Axis = NextT[0] < NextT[1]
+                ? (NextT[0] < NextT[2] ? 0 : 2)
+                : (NextT[1] < NextT[2] ? 1 : 2);
+            if (NextT[Axis] > ExitT)
+            {
+                return;
+            }
+            T = NextT[Axis];
+            Cell[Axis] += Step[Axis];
+            if (Cell[Axis] < 0 || Cell[Axis] >= Dim[Axis])
+            {
+                return;
+            }
+            NextT[Axis] += DeltaT[Axis];
+        }
+    }
+}
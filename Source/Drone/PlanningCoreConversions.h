@@ -0,0 +1,36 @@
+// PlanningCoreConversions.h
+// UE类型与PlanningCore类型之间的转换
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanningCore/PlanningTypes.h"
+
+FORCEINLINE DronePlanning::FVec3 ToPlanningVec(const FVector& V)
+{
+    return DronePlanning::FVec3(V.X, V.Y, V.Z);
+}
+
+FORCEINLINE FVector ToFVector(const DronePlanning::FVec3& V)
+{
+    return FVector(V.X, V.Y, V.Z);
+}
+
+FORCEINLINE std::vector<DronePlanning::FVec3> ToPlanningPath(const TArray<FVector>& Path)
+{
+    std::vector<DronePlanning::FVec3> Result;
+    Result.reserve(Path.Num());
+    for (const FVector& Point : Path)
+    {
+        Result.push_back(ToPlanningVec(Point));
+    }
+    return Result;
+}
+
+FORCEINLINE void ToFVectorPath(const std::vector<DronePlanning::FVec3>& Path, TArray<FVector>& OutPath)
+{
+    OutPath.Reset(Path.size());
+    for (const DronePlanning::FVec3& Point : Path)
+    {
+        OutPath.Add(ToFVector(Point));
+    }
+}
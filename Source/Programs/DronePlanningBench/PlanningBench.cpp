@@ -0,0 +1,1066 @@
+// PlanningBench.cpp
+// 无头规划基准测试：在录制的地图与起终点集合（或合成地图）上运行PlanningCore，
+// 不依赖引擎，可在无GPU的CI机器上运行。
+//
+//   DronePlanningBench --map GridMap.bin --queries Queries.txt [--reserve] [--smooth]
+//   DronePlanningBench --synthetic 500 500 20 --obstacles 400 --random-queries 20
+//   DronePlanningBench --synthetic 500 500 20 --random-queries 20 --search compare
+//   DronePlanningBench --synthetic 500 500 20 --random-queries 20 --replan 20
+//   DronePlanningBench --synthetic 500 500 20 --random-queries 20 --hierarchical 16
+//   DronePlanningBench --synthetic 500 500 20 --random-queries 64 --batch --threads 8 --smooth
+//   DronePlanningBench --synthetic 60 60 8 --obstacles 20 --random-queries 16 --cbs 1.5 --smooth
+//   DronePlanningBench --synthetic 500 500 20 --random-queries 20 --smooth --esdf 200
+//   DronePlanningBench --synthetic 500 500 20 --rays 1000000
+
+#include "AStarPlanner.h"
+#include "BatchPlanner.h"
+#include "ConflictBasedPlanner.h"
+#include "DStarLitePlanner.h"
+#include "DistanceField.h"
+#include "HierarchicalPlanner.h"
+#include "OccupancyGrid.h"
+#include "PathCache.h"
+#include "PathSmoother.h"
+#include "PlanningScenario.h"
+#include "ReservationTable.h"
+#include "VoxelRaycaster.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DronePlanning;
+
+namespace
+{
+    struct FBenchOptions
+    {
+        std::string MapFile;
+        std::string QueryFile;
+        std::string SaveMapFile;
+        std::string SaveQueryFile;
+
+        bool bSynthetic = false;
+        int32_t SyntheticDim[3] = { 500, 500, 20 };
+        float Resolution = 50.0f;
+        int32_t NumObstacles = 400;
+        float InflationRadius = 80.0f;
+        bool bSparse = false;
+        int32_t NumRandomQueries = 20;
+        uint32_t Seed = 42;
+
+        float DroneSpeed = 200.0f;
+        float SafetyDistance = 11.0f;
+        int32_t MaxSearchSteps = 100000;
+        int64_t MaxSearchMicros = 0;
+        float AnytimeInitialWeight = 1.0f;
+        ESearchMode SearchMode = ESearchMode::AStar;
+        EGridConnectivity Connectivity = EGridConnectivity::Corner26;
+        bool bCompareSearchModes = false;
+        int32_t NumReplans = 0;
+        int32_t HierarchicalClusterSize = 0;
+        int32_t NumRetargets = 0;
+        int32_t Repeat = 1;
+        bool bReserve = false;
+        bool bBatch = false;
+        float ConflictSuboptimality = 0.0f;
+        int64_t ConflictBudgetMicros = 1000000;
+        int32_t NumThreads = 0;
+        bool bSmooth = false;
+        float DistanceFieldMax = 0.0f;
+        bool bVerbose = false;
+
+        int32_t NumRays = 0;
+        float RayLength = 400.0f;
+    };
+
+    void PrintUsage()
+    {
+        std::printf(
+            "Usage: DronePlanningBench [options]\n"
+            "  --map FILE                 recorded grid map (UGridMapComponent::SaveMapToFile)\n"
+            "  --queries FILE             recorded start/goal set (UDroneSwarmManagerComponent::SavePlanningScenario)\n"
+            "  --synthetic X Y Z          generate an X*Y*Z cell map with random cylinders\n"
+            "  --resolution CM            synthetic cell size (default 50)\n"
+            "  --obstacles N              synthetic cylinder count (default 400)\n"
+            "  --inflation CM             synthetic inflation radius (default 80)\n"
+            "  --sparse                   store the synthetic map in sparse bricks\n"
+            "  --random-queries N         random start/goal pairs when no query file (default 20)\n"
+            "  --seed N                   random seed (default 42)\n"
+            "  --speed CM_PER_S           drone speed for reservation timing (default 200)\n"
+            "  --max-steps N              A* step limit (default 100000)\n"
+            "  --budget-us N              per-search wall-clock budget in microseconds (default 0: unlimited)\n"
+            "  --anytime W                anytime A* (ARA*): start with heuristic weight W and tighten towards 1,\n"
+            "                             returning the best path found within --budget-us\n"
+            "  --search MODE              astar (default), jps, or compare (run both and report expansions/costs)\n"
+            "  --connectivity N           A* neighbourhood: 6, 18 or 26 (default 26; JPS always uses 26)\n"
+            "  --replan N                 per query, N rounds of moving the start and blocking the path ahead;\n"
+            "                             compare incremental D* Lite against planning from scratch\n"
+            "  --hierarchical SIZE        plan with HPA* (SIZE-cell clusters, built on demand and shared by all queries);\n"
+            "                             compare against A* with --max-steps\n"
+            "  --retarget N               per query, N re-plans to a goal jittered by up to one cell while random\n"
+            "                             small obstacles appear; compare the shared path cache against A* every time\n"
+            "  --repeat N                 run the query set N times (default 1)\n"
+            "  --reserve                  plan queries in order, reserving each path (prioritized planning)\n"
+            "  --batch                    prioritized planning through FBatchPlanner (parallel waves)\n"
+            "  --threads N                worker threads for --batch (default: hardware concurrency)\n"
+            "  --cbs W                    joint planning with conflict-based search (suboptimality bound W >= 1);\n"
+            "                             compare against prioritized planning; exits with 1 if a CBS solution\n"
+            "                             (smoothed with --smooth) still has conflicts\n"
+            "  --cbs-budget-ms N          conflict-based search budget before falling back (default 1000)\n"
+            "  --smooth                   apply path smoothing after search\n"
+            "  --esdf CM                  build a distance field up to CM and use it to speed up --smooth\n"
+            "  --save-map FILE            write the map used for the run\n"
+            "  --save-queries FILE        write the queries used for the run\n"
+            "  --verbose                  print one line per query\n"
+            "  --rays N                   time N random voxel raycasts (scanner VoxelRaymarch backend) instead of planning\n"
+            "  --ray-length CM            raycast length (default 400, the scanner radius)\n");
+    }
+
+    bool ParseOptions(int Argc, char** Argv, FBenchOptions& Options)
+    {
+        for (int i = 1; i < Argc; ++i)
+        {
+            const char* Arg = Argv[i];
+            auto HasValues = [&](int Count) { return i + Count < Argc; };
+            if (!std::strcmp(Arg, "--map") && HasValues(1)) Options.MapFile = Argv[++i];
+            else if (!std::strcmp(Arg, "--queries") && HasValues(1)) Options.QueryFile = Argv[++i];
+            else if (!std::strcmp(Arg, "--save-map") && HasValues(1)) Options.SaveMapFile = Argv[++i];
+            else if (!std::strcmp(Arg, "--save-queries") && HasValues(1)) Options.SaveQueryFile = Argv[++i];
+            else if (!std::strcmp(Arg, "--synthetic") && HasValues(3))
+            {
+                Options.bSynthetic = true;
+                for (int Axis = 0; Axis < 3; ++Axis)
+                {
+                    Options.SyntheticDim[Axis] = std::atoi(Argv[++i]);
+                }
+            }
+            else if (!std::strcmp(Arg, "--resolution") && HasValues(1)) Options.Resolution = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--obstacles") && HasValues(1)) Options.NumObstacles = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--inflation") && HasValues(1)) Options.InflationRadius = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--sparse")) Options.bSparse = true;
+            else if (!std::strcmp(Arg, "--random-queries") && HasValues(1)) Options.NumRandomQueries = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--seed") && HasValues(1)) Options.Seed = (uint32_t)std::strtoul(Argv[++i], nullptr, 10);
+            else if (!std::strcmp(Arg, "--speed") && HasValues(1)) Options.DroneSpeed = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--max-steps") && HasValues(1)) Options.MaxSearchSteps = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--budget-us") && HasValues(1)) Options.MaxSearchMicros = std::atoll(Argv[++i]);
+            else if (!std::strcmp(Arg, "--anytime") && HasValues(1)) Options.AnytimeInitialWeight = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--search") && HasValues(1))
+            {
+                const char* Mode = Argv[++i];
+                if (!std::strcmp(Mode, "astar")) Options.SearchMode = ESearchMode::AStar;
+                else if (!std::strcmp(Mode, "jps")) Options.SearchMode = ESearchMode::JumpPoint;
+                else if (!std::strcmp(Mode, "compare")) Options.bCompareSearchModes = true;
+                else
+                {
+                    std::fprintf(stderr, "Unknown search mode: %s\n", Mode);
+                    return false;
+                }
+            }
+            else if (!std::strcmp(Arg, "--connectivity") && HasValues(1))
+            {
+                const int Connectivity = std::atoi(Argv[++i]);
+                if (Connectivity == 6) Options.Connectivity = EGridConnectivity::Face6;
+                else if (Connectivity == 18) Options.Connectivity = EGridConnectivity::Edge18;
+                else if (Connectivity == 26) Options.Connectivity = EGridConnectivity::Corner26;
+                else return false;
+            }
+            else if (!std::strcmp(Arg, "--replan") && HasValues(1)) Options.NumReplans = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--hierarchical") && HasValues(1)) Options.HierarchicalClusterSize = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--retarget") && HasValues(1)) Options.NumRetargets = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--repeat") && HasValues(1)) Options.Repeat = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--reserve")) Options.bReserve = true;
+            else if (!std::strcmp(Arg, "--batch")) Options.bBatch = true;
+            else if (!std::strcmp(Arg, "--threads") && HasValues(1)) Options.NumThreads = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--cbs") && HasValues(1)) Options.ConflictSuboptimality = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--cbs-budget-ms") && HasValues(1)) Options.ConflictBudgetMicros = std::atoll(Argv[++i]) * 1000;
+            else if (!std::strcmp(Arg, "--smooth")) Options.bSmooth = true;
+            else if (!std::strcmp(Arg, "--esdf") && HasValues(1)) Options.DistanceFieldMax = (float)std::atof(Argv[++i]);
+            else if (!std::strcmp(Arg, "--verbose")) Options.bVerbose = true;
+            else if (!std::strcmp(Arg, "--rays") && HasValues(1)) Options.NumRays = std::atoi(Argv[++i]);
+            else if (!std::strcmp(Arg, "--ray-length") && HasValues(1)) Options.RayLength = (float)std::atof(Argv[++i]);
+            else
+            {
+                std::fprintf(stderr, "Unknown or incomplete option: %s\n", Arg);
+                return false;
+            }
+        }
+        if (Options.MapFile.empty() && !Options.bSynthetic)
+        {
+            std::fprintf(stderr, "Either --map or --synthetic is required\n");
+            return false;
+        }
+        return true;
+    }
+
+    void BuildSyntheticMap(const FBenchOptions& Options, std::mt19937& Rng, FOccupancyGrid& Grid)
+    {
+        const FVec3 Size(Options.SyntheticDim[0] * Options.Resolution,
+            Options.SyntheticDim[1] * Options.Resolution,
+            Options.SyntheticDim[2] * Options.Resolution);
+        Grid.Initialize(FVec3(), Size, Options.Resolution, Options.bSparse);
+
+        // 与AddCylindricalObstacles一致：竖直圆柱 + 球形膨胀
+        std::uniform_real_distribution<double> PosX(0.0, Size.X);
+        std::uniform_real_distribution<double> PosY(0.0, Size.Y);
+        std::uniform_real_distribution<float> Radius(Options.Resolution * 2.0f, Options.Resolution * 8.0f);
+        for (int32_t i = 0; i < Options.NumObstacles; ++i)
+        {
+            Grid.AddInflatedCylinder(FVec3(PosX(Rng), PosY(Rng), Size.Z * 0.5), Radius(Rng), (float)Size.Z, Options.InflationRadius);
+        }
+    }
+
+    bool PickFreeCell(const FOccupancyGrid& Grid, std::mt19937& Rng, FVec3& OutPos)
+    {
+        std::uniform_int_distribution<int32_t> CellX(0, Grid.GetDimX() - 1);
+        std::uniform_int_distribution<int32_t> CellY(0, Grid.GetDimY() - 1);
+        std::uniform_int_distribution<int32_t> CellZ(0, Grid.GetDimZ() - 1);
+        for (int32_t Attempt = 0; Attempt < 1000; ++Attempt)
+        {
+            const int32_t X = CellX(Rng), Y = CellY(Rng), Z = CellZ(Rng);
+            if (!Grid.IsOccupiedCell(X, Y, Z))
+            {
+                OutPos = Grid.GridToWorld(X, Y, Z);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void BuildRandomQueries(const FBenchOptions& Options, const FOccupancyGrid& Grid, std::mt19937& Rng, std::vector<FPlanQuery>& OutQueries)
+    {
+        for (int32_t i = 0; i < Options.NumRandomQueries; ++i)
+        {
+            FPlanQuery Query;
+            Query.DroneID = i;
+            if (PickFreeCell(Grid, Rng, Query.Start) && PickFreeCell(Grid, Rng, Query.Goal))
+            {
+                OutQueries.push_back(Query);
+            }
+        }
+    }
+
+    // 最简单的线程池替代：每次调用启动NumThreads个线程，按原子计数领取任务
+    FParallelFor MakeThreadParallelFor(int32_t NumThreads)
+    {
+        return [NumThreads](int32_t Count, const std::function<void(int32_t)>& Body)
+        {
+            std::atomic<int32_t> Next(0);
+            auto Worker = [&]()
+            {
+                for (int32_t i = Next++; i < Count; i = Next++)
+                {
+                    Body(i);
+                }
+            };
+            std::vector<std::thread> Threads;
+            const int32_t NumWorkers = std::min(NumThreads, Count);
+            for (int32_t t = 1; t < NumWorkers; ++t)
+            {
+                Threads.emplace_back(Worker);
+            }
+            Worker();
+            for (std::thread& Thread : Threads)
+            {
+                Thread.join();
+            }
+        };
+    }
+
+    // 结果路径两两之间的冲突数（按无人机对计），判定方式与规划时的预约检查相同
+    int32_t CountPairConflicts(const std::vector<FBatchQuery>& Queries, const std::vector<FBatchResult>& Results)
+    {
+        FReservationTable Table;
+        for (size_t i = 0; i < Queries.size(); ++i)
+        {
+            if (Results[i].Status == EPlanStatus::Success)
+            {
+                Table.Reserve((int32_t)i, FReservationTable::BuildSamples(Results[i].Path, Queries[i].DroneSpeed, Queries[i].Request.StartTime));
+            }
+        }
+
+        std::vector<bool> PairCounted(Queries.size() * Queries.size(), false);
+        std::vector<FSpaceTimeSegment> Segments;
+        int32_t NumConflicts = 0;
+        for (size_t i = 0; i < Queries.size(); ++i)
+        {
+            const FReservationTable::FSampleList* Samples = Table.Find((int32_t)i);
+            Segments.clear();
+            if (Samples)
+            {
+                Table.BuildSegments(*Samples, Segments);
+            }
+            for (const FSpaceTimeSegment& Segment : Segments)
+            {
+                FSpaceTimeSegment Other;
+                int32_t OtherIndex = -1;
+                if (Table.FindConflict(Segment, (int32_t)i, Other, OtherIndex))
+                {
+                    const size_t Pair = std::min(i, (size_t)OtherIndex) * Queries.size() + std::max(i, (size_t)OtherIndex);
+                    NumConflicts += PairCounted[Pair] ? 0 : 1;
+                    PairCounted[Pair] = true;
+                }
+            }
+        }
+        return NumConflicts;
+    }
+
+    int RunBatch(const FBenchOptions& Options, const FOccupancyGrid& Grid, const FDistanceField* DistanceField,
+        const std::vector<FPlanQuery>& Queries)
+    {
+        const int32_t NumThreads = Options.NumThreads > 0
+            ? Options.NumThreads : std::max(1, (int32_t)std::thread::hardware_concurrency());
+
+        FBatchPlanner Planner;
+        Planner.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        Planner.ParallelFor = MakeThreadParallelFor(NumThreads);
+        Planner.DistanceField = DistanceField;
+
+        std::vector<FBatchQuery> BatchQueries;
+        for (const FPlanQuery& Query : Queries)
+        {
+            FBatchQuery BatchQuery;
+            BatchQuery.Request.Start = Query.Start;
+            BatchQuery.Request.Goal = Query.Goal;
+            BatchQuery.Request.DroneID = Query.DroneID;
+            BatchQuery.DroneSpeed = Options.DroneSpeed;
+            BatchQuery.SearchMode = Options.SearchMode;
+            BatchQuery.SafetyDistance = Options.bSmooth ? Options.SafetyDistance : 0.0f;
+            BatchQuery.MaxSearchMicros = Options.MaxSearchMicros;
+            BatchQuery.AnytimeInitialWeight = Options.AnytimeInitialWeight;
+            BatchQueries.push_back(BatchQuery);
+        }
+
+        double TotalWallSeconds = 0.0;
+        int32_t NumConflictingBatches = 0;
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            FReservationTable Reservations;
+            std::vector<FBatchResult> Results;
+            const FBatchStats Stats = Planner.PlanBatch(Grid, Reservations, BatchQueries, Results);
+            TotalWallSeconds += Stats.WallSeconds;
+
+            if (Options.bVerbose)
+            {
+                for (size_t i = 0; i < Results.size(); ++i)
+                {
+                    std::printf("  drone %3d: %-34s wave %3d%s  expansions %8d  points %5d\n",
+                        BatchQueries[i].Request.DroneID, LexToString(Results[i].Status), Results[i].Wave,
+                        Results[i].bReplanned ? " (replanned)" : "            ", Results[i].Expansions, (int32_t)Results[i].Path.size());
+                }
+            }
+            const int32_t NumConflicts = CountPairConflicts(BatchQueries, Results);
+            NumConflictingBatches += NumConflicts > 0 ? 1 : 0;
+            std::printf("Batch %d: %d/%d succeeded, %d waves, %d replanned, %d kept unsmoothed, %d conflicts, %lld expansions, %.3f ms wall (%d threads)\n",
+                Round, Stats.NumSucceeded, (int32_t)Results.size(), Stats.NumWaves, Stats.NumReplanned, Stats.NumUnsmoothed,
+                NumConflicts, (long long)Stats.Expansions, Stats.WallSeconds * 1000.0, NumThreads);
+        }
+        std::printf("Batch wall time: %.3f ms total, %.3f ms/batch\n",
+            TotalWallSeconds * 1000.0, Options.Repeat > 0 ? TotalWallSeconds * 1000.0 / Options.Repeat : 0.0);
+        return NumConflictingBatches == 0 ? 0 : 1;
+    }
+
+    // 从随机空闲格子向随机方向发射定长射线，模拟激光扫描
+    int RunRaycast(const FBenchOptions& Options, const FOccupancyGrid& Grid, std::mt19937& Rng)
+    {
+        std::vector<FVec3> Starts;
+        std::vector<FVec3> Ends;
+        std::normal_distribution<double> Axis(0.0, 1.0);
+        for (int32_t i = 0; i < Options.NumRays; ++i)
+        {
+            FVec3 Start;
+            if (!PickFreeCell(Grid, Rng, Start))
+            {
+                break;
+            }
+            const FVec3 Direction = FVec3(Axis(Rng), Axis(Rng), Axis(Rng)).GetSafeNormal();
+            Starts.push_back(Start);
+            Ends.push_back(Start + Direction * Options.RayLength);
+        }
+
+        using FClock = std::chrono::steady_clock;
+        const FVoxelRaycaster Raycaster(Grid);
+        int32_t NumHits = 0;
+        const FClock::time_point Begin = FClock::now();
+        for (size_t i = 0; i < Starts.size(); ++i)
+        {
+            FVoxelHit Hit;
+            NumHits += Raycaster.Raycast(Starts[i], Ends[i], Hit) ? 1 : 0;
+        }
+        const double Seconds = std::chrono::duration<double>(FClock::now() - Begin).count();
+
+        std::printf("Raycast: %d rays of %.0f cm, %d hits, %.3f ms total, %.1f ns/ray\n",
+            (int32_t)Starts.size(), Options.RayLength, NumHits, Seconds * 1000.0,
+            Starts.empty() ? 0.0 : Seconds * 1e9 / Starts.size());
+        return 0;
+    }
+
+    double PathLength(const std::vector<FVec3>& Path)
+    {
+        double Length = 0.0;
+        for (size_t i = 0; i + 1 < Path.size(); ++i)
+        {
+            Length += FVec3::Dist(Path[i], Path[i + 1]);
+        }
+        return Length;
+    }
+
+    // 同一组查询分别用A*与JPS搜索（不使用预约表），比较扩展次数、耗时与路径代价
+    int RunSearchModeComparison(const FBenchOptions& Options, const FOccupancyGrid& Grid, const std::vector<FPlanQuery>& Queries)
+    {
+        using FClock = std::chrono::steady_clock;
+        const ESearchMode Modes[2] = { ESearchMode::AStar, ESearchMode::JumpPoint };
+        FAStarPlanner Planners[2];
+        int64_t TotalExpansions[2] = { 0, 0 };
+        double TotalSeconds[2] = { 0.0, 0.0 };
+        int32_t NumSucceeded[2] = { 0, 0 };
+        int32_t NumCostMismatches = 0;
+        double MaxCostDifference = 0.0;
+
+        for (int32_t ModeIndex = 0; ModeIndex < 2; ++ModeIndex)
+        {
+            Planners[ModeIndex].Config.DroneSpeed = Options.DroneSpeed;
+            Planners[ModeIndex].Config.MaxSearchSteps = Options.MaxSearchSteps;
+            Planners[ModeIndex].Config.MaxSearchMicros = Options.MaxSearchMicros;
+            Planners[ModeIndex].Config.SearchMode = Modes[ModeIndex];
+        }
+
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            for (const FPlanQuery& Query : Queries)
+            {
+                FPlanRequest Request;
+                Request.Start = Query.Start;
+                Request.Goal = Query.Goal;
+                Request.DroneID = Query.DroneID;
+
+                EPlanStatus Status[2];
+                float Cost[2];
+                for (int32_t ModeIndex = 0; ModeIndex < 2; ++ModeIndex)
+                {
+                    std::vector<FVec3> Path;
+                    const FClock::time_point SearchBegin = FClock::now();
+                    Status[ModeIndex] = Planners[ModeIndex].FindPath(Grid, nullptr, Request, Path);
+                    TotalSeconds[ModeIndex] += std::chrono::duration<double>(FClock::now() - SearchBegin).count();
+                    TotalExpansions[ModeIndex] += Planners[ModeIndex].GetLastStats().Expansions;
+                    Cost[ModeIndex] = Planners[ModeIndex].GetLastStats().PathCost;
+                    if (Status[ModeIndex] == EPlanStatus::Success)
+                    {
+                        NumSucceeded[ModeIndex]++;
+                    }
+                }
+
+                if (Status[0] == EPlanStatus::Success && Status[1] == EPlanStatus::Success)
+                {
+                    const double Difference = Cost[1] - Cost[0];
+                    MaxCostDifference = std::max(MaxCostDifference, std::abs(Difference));
+                    if (std::abs(Difference) > 1.e-5 * Cost[0] + 1.e-2)
+                    {
+                        NumCostMismatches++;
+                    }
+                }
+
+                if (Options.bVerbose)
+                {
+                    std::printf("  drone %3d: A* %-20s expansions %8d  cost %10.1f | JPS %-20s expansions %8d  cost %10.1f\n",
+                        Query.DroneID, LexToString(Status[0]), Planners[0].GetLastStats().Expansions, Cost[0],
+                        LexToString(Status[1]), Planners[1].GetLastStats().Expansions, Cost[1]);
+                }
+            }
+        }
+
+        for (int32_t ModeIndex = 0; ModeIndex < 2; ++ModeIndex)
+        {
+            std::printf("%-4s %d succeeded, %lld expansions, %.3f ms total\n", LexToString(Modes[ModeIndex]),
+                NumSucceeded[ModeIndex], (long long)TotalExpansions[ModeIndex], TotalSeconds[ModeIndex] * 1000.0);
+        }
+        std::printf("Expansion ratio A*/JPS %.1fx, speedup %.1fx, %d cost mismatches (max difference %.3f)\n",
+            TotalExpansions[1] > 0 ? (double)TotalExpansions[0] / TotalExpansions[1] : 0.0,
+            TotalSeconds[1] > 0.0 ? TotalSeconds[0] / TotalSeconds[1] : 0.0, NumCostMismatches, MaxCostDifference);
+        return NumCostMismatches == 0 ? 0 : 1;
+    }
+
+    // 模拟PathModifier的重规划：每轮起点沿当前路径前进两个格子，并在前方路径上放置一个小障碍物。
+    // 增量D* Lite与每轮从头开始的D* Lite（代价应一致）、A*（目标容差不同，只比较开销）对比
+    int RunIncrementalReplan(const FBenchOptions& Options, const FOccupancyGrid& Grid, const std::vector<FPlanQuery>& Queries)
+    {
+        using FClock = std::chrono::steady_clock;
+        const char* Names[3] = { "D* Lite incremental", "D* Lite from scratch", "A* from scratch" };
+        int64_t TotalExpansions[3] = { 0, 0, 0 };
+        double TotalSeconds[3] = { 0.0, 0.0, 0.0 };
+        int32_t NumReplans = 0;
+        int32_t NumCostMismatches = 0;
+        int32_t NumBudgetExhausted = 0;
+        int64_t NumUpdatedCells = 0;
+
+        // 步数/时间预算用尽不是结果错误，单独计数，不参与代价比较
+        auto IsBudgetExhausted = [](EPlanStatus Status)
+        {
+            return Status == EPlanStatus::StepLimit || Status == EPlanStatus::TimeLimit || Status == EPlanStatus::Cancelled;
+        };
+
+        FDStarLitePlanner Incremental;
+        Incremental.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        Incremental.Config.MaxSearchMicros = Options.MaxSearchMicros;
+        FAStarPlanner AStar;
+        AStar.Config.DroneSpeed = Options.DroneSpeed;
+        AStar.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        AStar.Config.MaxSearchMicros = Options.MaxSearchMicros;
+        AStar.Config.SearchMode = Options.SearchMode;
+
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            for (const FPlanQuery& Query : Queries)
+            {
+                FOccupancyGrid WorkGrid = Grid;
+                Incremental.Reset();
+
+                FVec3 Start = Query.Start;
+                std::vector<FVec3> Path;
+                EPlanStatus Status = Incremental.Plan(WorkGrid, Start, Query.Goal, Path);
+                for (int32_t Replan = 0; Replan < Options.NumReplans && Status == EPlanStatus::Success && Path.size() > 8; ++Replan)
+                {
+                    // Path[0]为起点本身，其后为逐格的格子中心
+                    Start = Path[2];
+                    int32_t BlockX, BlockY, BlockZ;
+                    WorkGrid.WorldToGrid(Path[6], BlockX, BlockY, BlockZ);
+                    FCellBounds Changed;
+                    WorkGrid.MarkOccupiedBox(FCellBounds(FIntVec3(BlockX - 1, BlockY - 1, BlockZ - 1), FIntVec3(BlockX + 1, BlockY + 1, BlockZ + 1)), Changed);
+                    if (WorkGrid.IsOccupied(Query.Goal))
+                    {
+                        break;
+                    }
+
+                    const FClock::time_point IncrementalBegin = FClock::now();
+                    Incremental.NotifyCellsChanged(WorkGrid, Changed);
+                    Status = Incremental.Plan(WorkGrid, Start, Query.Goal, Path);
+                    TotalSeconds[0] += std::chrono::duration<double>(FClock::now() - IncrementalBegin).count();
+                    TotalExpansions[0] += Incremental.GetLastStats().Expansions;
+                    NumUpdatedCells += Incremental.GetLastStats().GeneratedNodes;
+
+                    FDStarLitePlanner Scratch;
+                    Scratch.Config.MaxSearchSteps = Options.MaxSearchSteps;
+                    Scratch.Config.MaxSearchMicros = Options.MaxSearchMicros;
+                    std::vector<FVec3> ScratchPath;
+                    const FClock::time_point ScratchBegin = FClock::now();
+                    const EPlanStatus ScratchStatus = Scratch.Plan(WorkGrid, Start, Query.Goal, ScratchPath);
+                    TotalSeconds[1] += std::chrono::duration<double>(FClock::now() - ScratchBegin).count();
+                    TotalExpansions[1] += Scratch.GetLastStats().Expansions;
+
+                    FPlanRequest Request;
+                    Request.Start = Start;
+                    Request.Goal = Query.Goal;
+                    Request.DroneID = Query.DroneID;
+                    std::vector<FVec3> AStarPath;
+                    const FClock::time_point AStarBegin = FClock::now();
+                    AStar.FindPath(WorkGrid, nullptr, Request, AStarPath);
+                    TotalSeconds[2] += std::chrono::duration<double>(FClock::now() - AStarBegin).count();
+                    TotalExpansions[2] += AStar.GetLastStats().Expansions;
+
+                    NumReplans++;
+                    const float Cost = Incremental.GetLastStats().PathCost;
+                    const float ScratchCost = Scratch.GetLastStats().PathCost;
+                    if (IsBudgetExhausted(Status) || IsBudgetExhausted(ScratchStatus))
+                    {
+                        NumBudgetExhausted++;
+                    }
+                    else if (Status != ScratchStatus
+                        || (Status == EPlanStatus::Success && std::abs(Cost - ScratchCost) > 1.e-5 * ScratchCost + 1.e-2))
+                    {
+                        NumCostMismatches++;
+                    }
+
+                    if (Options.bVerbose)
+                    {
+                        std::printf("  drone %3d replan %3d: %-20s updated %6d  expansions %8d (scratch %8d, A* %8d)  cost %10.1f (scratch %10.1f)\n",
+                            Query.DroneID, Replan, LexToString(Status), Incremental.GetLastStats().GeneratedNodes,
+                            Incremental.GetLastStats().Expansions, Scratch.GetLastStats().Expansions,
+                            AStar.GetLastStats().Expansions, Cost, ScratchCost);
+                    }
+                }
+            }
+        }
+
+        std::printf("%d replans, %lld searched cells updated by map changes\n", NumReplans, (long long)NumUpdatedCells);
+        for (int32_t Method = 0; Method < 3; ++Method)
+        {
+            std::printf("%-21s %lld expansions, %.3f ms total, %.3f ms/replan\n", Names[Method], (long long)TotalExpansions[Method],
+                TotalSeconds[Method] * 1000.0, NumReplans ? TotalSeconds[Method] * 1000.0 / NumReplans : 0.0);
+        }
+        std::printf("Expansion ratio scratch/incremental %.1fx, A*/incremental %.1fx, %d cost mismatches, %d not compared (search budget exhausted)\n",
+            TotalExpansions[0] > 0 ? (double)TotalExpansions[1] / TotalExpansions[0] : 0.0,
+            TotalExpansions[0] > 0 ? (double)TotalExpansions[2] / TotalExpansions[0] : 0.0, NumCostMismatches, NumBudgetExhausted);
+        return NumCostMismatches == 0 ? 0 : 1;
+    }
+
+    // 同一组查询分别用HPA*（所有查询共享入口图，区块在第一次用到时构建）与A*搜索（不使用预约表），
+    // 比较扩展次数与耗时；两者都成功时统计HPA*路径代价相对A*的比值
+    int RunHierarchicalComparison(const FBenchOptions& Options, const FOccupancyGrid& Grid, const std::vector<FPlanQuery>& Queries)
+    {
+        using FClock = std::chrono::steady_clock;
+        FHierarchicalPlanner Hierarchical;
+        Hierarchical.ClusterSize = Options.HierarchicalClusterSize;
+        Hierarchical.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        Hierarchical.Config.MaxSearchMicros = Options.MaxSearchMicros;
+        FAStarPlanner AStar;
+        AStar.Config.DroneSpeed = Options.DroneSpeed;
+        AStar.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        AStar.Config.MaxSearchMicros = Options.MaxSearchMicros;
+        AStar.Config.SearchMode = Options.SearchMode;
+
+        int64_t TotalExpansions[2] = { 0, 0 };
+        double TotalSeconds[2] = { 0.0, 0.0 };
+        int32_t NumSucceeded[2] = { 0, 0 };
+        int32_t NumClustersBuilt = 0;
+        int32_t NumCompared = 0;
+        int32_t NumMissed = 0;
+        double SumCostRatio = 0.0;
+        double MaxCostRatio = 0.0;
+
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            for (const FPlanQuery& Query : Queries)
+            {
+                std::vector<FVec3> Path;
+                const FClock::time_point HierarchicalBegin = FClock::now();
+                const EPlanStatus HierarchicalStatus = Hierarchical.Plan(Grid, Query.Start, Query.Goal, Path);
+                TotalSeconds[0] += std::chrono::duration<double>(FClock::now() - HierarchicalBegin).count();
+                TotalExpansions[0] += Hierarchical.GetLastStats().Expansions;
+                NumClustersBuilt += Hierarchical.GetLastStats().GeneratedNodes;
+
+                FPlanRequest Request;
+                Request.Start = Query.Start;
+                Request.Goal = Query.Goal;
+                Request.DroneID = Query.DroneID;
+                std::vector<FVec3> AStarPath;
+                const FClock::time_point AStarBegin = FClock::now();
+                const EPlanStatus AStarStatus = AStar.FindPath(Grid, nullptr, Request, AStarPath);
+                TotalSeconds[1] += std::chrono::duration<double>(FClock::now() - AStarBegin).count();
+                TotalExpansions[1] += AStar.GetLastStats().Expansions;
+
+                const float Cost = Hierarchical.GetLastStats().PathCost;
+                const float AStarCost = AStar.GetLastStats().PathCost;
+                NumSucceeded[0] += HierarchicalStatus == EPlanStatus::Success ? 1 : 0;
+                NumSucceeded[1] += AStarStatus == EPlanStatus::Success ? 1 : 0;
+                if (HierarchicalStatus == EPlanStatus::Success && AStarStatus == EPlanStatus::Success && AStarCost > 0.0f)
+                {
+                    NumCompared++;
+                    SumCostRatio += Cost / AStarCost;
+                    MaxCostRatio = std::max(MaxCostRatio, (double)(Cost / AStarCost));
+                }
+                else if (AStarStatus == EPlanStatus::Success)
+                {
+                    NumMissed++;
+                }
+
+                if (Options.bVerbose)
+                {
+                    std::printf("  drone %3d: HPA* %-20s expansions %8d  clusters %4d  cost %10.1f | A* %-20s expansions %8d  cost %10.1f\n",
+                        Query.DroneID, LexToString(HierarchicalStatus), Hierarchical.GetLastStats().Expansions,
+                        Hierarchical.GetLastStats().GeneratedNodes, Cost, LexToString(AStarStatus), AStar.GetLastStats().Expansions, AStarCost);
+                }
+            }
+        }
+
+        const char* Names[2] = { "HPA*", "A*" };
+        for (int32_t Method = 0; Method < 2; ++Method)
+        {
+            std::printf("%-4s %d succeeded, %lld expansions, %.3f ms total\n", Names[Method], NumSucceeded[Method],
+                (long long)TotalExpansions[Method], TotalSeconds[Method] * 1000.0);
+        }
+        std::printf("HPA* built %d clusters (%d cells each side); cost ratio HPA*/A* mean %.3f, max %.3f over %d queries; "
+            "%d queries solved by A* only\n",
+            NumClustersBuilt, Options.HierarchicalClusterSize, NumCompared ? SumCostRatio / NumCompared : 0.0, MaxCostRatio,
+            NumCompared, NumMissed);
+        return NumMissed == 0 ? 0 : 1;
+    }
+
+    // 检测驱动的重定向：每个查询反复规划到在一个格子内抖动的目标，每轮在地图上随机放置一个小障碍物。
+    // 先查共享的路径缓存、未命中时用A*规划并写入缓存，与每次都用A*对比；命中的路径须逐格相邻且不经过障碍物
+    int RunPathCacheComparison(const FBenchOptions& Options, const FOccupancyGrid& Grid, const std::vector<FPlanQuery>& Queries, std::mt19937& Rng)
+    {
+        using FClock = std::chrono::steady_clock;
+        FOccupancyGrid WorkGrid = Grid;
+        FPathCache Cache;
+        FAStarPlanner AStar;
+        AStar.Config.DroneSpeed = Options.DroneSpeed;
+        AStar.Config.MaxSearchSteps = Options.MaxSearchSteps;
+        AStar.Config.MaxSearchMicros = Options.MaxSearchMicros;
+        AStar.Config.SearchMode = Options.SearchMode;
+
+        const float Resolution = WorkGrid.GetResolution();
+        std::uniform_real_distribution<double> Jitter(-Resolution, Resolution);
+        std::uniform_int_distribution<int32_t> CellX(0, WorkGrid.GetDimX() - 1);
+        std::uniform_int_distribution<int32_t> CellY(0, WorkGrid.GetDimY() - 1);
+        std::uniform_int_distribution<int32_t> CellZ(0, WorkGrid.GetDimZ() - 1);
+
+        double TotalSeconds[2] = { 0.0, 0.0 };
+        int64_t TotalExpansions[2] = { 0, 0 };
+        int32_t NumPlans = 0;
+        int32_t NumInvalidPaths = 0;
+        double SumLengthRatio = 0.0;
+        int32_t NumCompared = 0;
+
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            for (const FPlanQuery& Query : Queries)
+            {
+                for (int32_t Retarget = 0; Retarget <= Options.NumRetargets; ++Retarget)
+                {
+                    // 随机放置一个3x3x3的障碍物，不覆盖本次的起点与目标
+                    FPlanRequest Request;
+                    Request.Start = Query.Start;
+                    Request.Goal = Query.Goal + FVec3(Jitter(Rng), Jitter(Rng), Jitter(Rng));
+                    Request.DroneID = Query.DroneID;
+                    const FIntVec3 Block(CellX(Rng), CellY(Rng), CellZ(Rng));
+                    const FCellBounds Box(FIntVec3(Block.X - 1, Block.Y - 1, Block.Z - 1), FIntVec3(Block.X + 1, Block.Y + 1, Block.Z + 1));
+                    FIntVec3 StartCell, GoalCell;
+                    WorkGrid.WorldToGrid(Request.Start, StartCell.X, StartCell.Y, StartCell.Z);
+                    if (!WorkGrid.WorldToGrid(Request.Goal, GoalCell.X, GoalCell.Y, GoalCell.Z))
+                    {
+                        continue;
+                    }
+                    if (!Box.Contains(StartCell) && !Box.Contains(GoalCell))
+                    {
+                        FCellBounds Changed;
+                        WorkGrid.MarkOccupiedBox(Box, Changed);
+                        Cache.NotifyCellsChanged(WorkGrid, Changed);
+                    }
+
+                    std::vector<FVec3> Path;
+                    const FClock::time_point CacheBegin = FClock::now();
+                    bool bSuccess = Cache.Find(WorkGrid, nullptr, 0, Request, Options.DroneSpeed, Path);
+                    if (!bSuccess)
+                    {
+                        bSuccess = AStar.FindPath(WorkGrid, nullptr, Request, Path) == EPlanStatus::Success;
+                        TotalExpansions[0] += AStar.GetLastStats().Expansions;
+                        if (bSuccess)
+                        {
+                            Cache.Add(WorkGrid, Request, Path);
+                        }
+                    }
+                    TotalSeconds[0] += std::chrono::duration<double>(FClock::now() - CacheBegin).count();
+
+                    std::vector<FVec3> AStarPath;
+                    const FClock::time_point AStarBegin = FClock::now();
+                    const bool bAStarSuccess = AStar.FindPath(WorkGrid, nullptr, Request, AStarPath) == EPlanStatus::Success;
+                    TotalSeconds[1] += std::chrono::duration<double>(FClock::now() - AStarBegin).count();
+                    TotalExpansions[1] += AStar.GetLastStats().Expansions;
+                    NumPlans++;
+
+                    if (!bSuccess)
+                    {
+                        continue;
+                    }
+                    // A*到达目标相邻格子即结束，最后一步可以跨两个格子
+                    bool bValid = true;
+                    FIntVec3 Previous = StartCell;
+                    for (size_t i = 1; i < Path.size() && bValid; ++i)
+                    {
+                        FIntVec3 Cell;
+                        const int32_t MaxStep = i + 1 == Path.size() ? 2 : 1;
+                        bValid = WorkGrid.WorldToGrid(Path[i], Cell.X, Cell.Y, Cell.Z) && !WorkGrid.IsOccupiedCell(Cell.X, Cell.Y, Cell.Z)
+                            && std::max({ std::abs(Cell.X - Previous.X), std::abs(Cell.Y - Previous.Y), std::abs(Cell.Z - Previous.Z) }) <= MaxStep;
+                        Previous = Cell;
+                    }
+                    bValid = bValid && Previous == GoalCell;
+                    NumInvalidPaths += bValid ? 0 : 1;
+                    if (bAStarSuccess && PathLength(AStarPath) > 0.0)
+                    {
+                        SumLengthRatio += PathLength(Path) / PathLength(AStarPath);
+                        NumCompared++;
+                    }
+                }
+            }
+        }
+
+        const FPathCacheStats& Stats = Cache.GetStats();
+        std::printf("%d plans; cache %d hits (%d repaired), %d misses, %d entries invalidated, %d entries left\n",
+            NumPlans, Stats.Hits, Stats.Repairs, Stats.Misses, Stats.Invalidated, Cache.Num());
+        std::printf("Cache + A* %lld expansions, %.3f ms total | A* %lld expansions, %.3f ms total\n",
+            (long long)TotalExpansions[0], TotalSeconds[0] * 1000.0, (long long)TotalExpansions[1], TotalSeconds[1] * 1000.0);
+        std::printf("Path length cache/A* mean %.4f over %d plans, %d invalid paths\n",
+            NumCompared ? SumLengthRatio / NumCompared : 0.0, NumCompared, NumInvalidPaths);
+        return NumInvalidPaths == 0 ? 0 : 1;
+    }
+
+    // 同一组查询分别用优先级规划（FBatchPlanner串行）与冲突搜索（FConflictBasedPlanner）联合规划，
+    // 比较成功数、路径总长、剩余冲突与耗时
+    int RunConflictBasedComparison(const FBenchOptions& Options, const FOccupancyGrid& Grid, const FDistanceField* DistanceField,
+        const std::vector<FPlanQuery>& Queries)
+    {
+        std::vector<FBatchQuery> BatchQueries;
+        for (const FPlanQuery& Query : Queries)
+        {
+            FBatchQuery BatchQuery;
+            BatchQuery.Request.Start = Query.Start;
+            BatchQuery.Request.Goal = Query.Goal;
+            BatchQuery.Request.DroneID = Query.DroneID;
+            BatchQuery.DroneSpeed = Options.DroneSpeed;
+            BatchQuery.SearchMode = Options.SearchMode;
+            BatchQuery.SafetyDistance = Options.bSmooth ? Options.SafetyDistance : 0.0f;
+            BatchQuery.MaxSearchMicros = Options.MaxSearchMicros;
+            BatchQuery.AnytimeInitialWeight = Options.AnytimeInitialWeight;
+            BatchQueries.push_back(BatchQuery);
+        }
+        // 与UDroneSwarmManagerComponent相同，起终点距离长的优先
+        std::stable_sort(BatchQueries.begin(), BatchQueries.end(), [](const FBatchQuery& A, const FBatchQuery& B)
+        {
+            return FVec3::Dist(A.Request.Start, A.Request.Goal) > FVec3::Dist(B.Request.Start, B.Request.Goal);
+        });
+
+        FPlannerConfig Config;
+        Config.MaxSearchSteps = Options.MaxSearchSteps;
+        Config.Connectivity = Options.Connectivity;
+
+        FBatchPlanner Prioritized;
+        Prioritized.Config = Config;
+        Prioritized.DistanceField = DistanceField;
+
+        FConflictBasedPlanner Joint;
+        Joint.Config = Config;
+        Joint.SuboptimalityBound = Options.ConflictSuboptimality;
+        Joint.MaxSolveMicros = Options.ConflictBudgetMicros;
+        Joint.DistanceField = DistanceField;
+
+        int32_t NumConflictingSolutions = 0;
+        for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+        {
+            FReservationTable PrioritizedReservations;
+            std::vector<FBatchResult> PrioritizedResults;
+            const FBatchStats PrioritizedStats = Prioritized.PlanBatch(Grid, PrioritizedReservations, BatchQueries, PrioritizedResults);
+
+            FReservationTable JointReservations;
+            std::vector<FBatchResult> JointResults;
+            const FConflictSearchStats JointStats = Joint.PlanGroup(Grid, JointReservations, BatchQueries, JointResults);
+
+            double PrioritizedLength = 0.0;
+            double JointLength = 0.0;
+            for (size_t i = 0; i < BatchQueries.size(); ++i)
+            {
+                PrioritizedLength += PrioritizedResults[i].Status == EPlanStatus::Success ? PathLength(PrioritizedResults[i].Path) : 0.0;
+                JointLength += JointResults[i].Status == EPlanStatus::Success ? PathLength(JointResults[i].Path) : 0.0;
+                if (Options.bVerbose)
+                {
+                    std::printf("  drone %3d: prioritized %-12s %9.1f cm | joint %-12s %9.1f cm%s\n",
+                        BatchQueries[i].Request.DroneID, LexToString(PrioritizedResults[i].Status), PathLength(PrioritizedResults[i].Path),
+                        LexToString(JointResults[i].Status), PathLength(JointResults[i].Path), JointResults[i].bReplanned ? " (constrained)" : "");
+                }
+            }
+
+            std::printf("Prioritized %d: %d/%d succeeded, length %.1f cm, %d conflicts, %lld expansions, %.3f ms\n",
+                Round, PrioritizedStats.NumSucceeded, (int32_t)BatchQueries.size(), PrioritizedLength,
+                CountPairConflicts(BatchQueries, PrioritizedResults), (long long)PrioritizedStats.Expansions, PrioritizedStats.WallSeconds * 1000.0);
+            // 冲突搜索的解（含平滑后的路径）必须无冲突；退回优先级规划时不保证
+            const int32_t JointConflicts = CountPairConflicts(BatchQueries, JointResults);
+            NumConflictingSolutions += (!JointStats.bFellBack && JointConflicts > 0) ? 1 : 0;
+            std::printf("CBS(w=%.2f) %d: %d/%d succeeded, length %.1f cm, %d conflicts, %lld expansions, %.3f ms%s\n",
+                Options.ConflictSuboptimality, Round, JointStats.NumSucceeded, (int32_t)BatchQueries.size(), JointLength,
+                JointConflicts, (long long)JointStats.Expansions, JointStats.WallSeconds * 1000.0,
+                JointStats.bFellBack ? " (fell back to prioritized)" : "");
+            std::printf("  %d root conflicts, %d/%d constraint tree nodes expanded/generated, %d low-level searches, cost %.1f (lower bound %.1f), %d kept unsmoothed\n",
+                JointStats.RootConflicts, JointStats.HighLevelExpansions, JointStats.HighLevelNodes, JointStats.LowLevelSearches,
+                JointStats.SolutionCost, JointStats.CostLowerBound, JointStats.NumUnsmoothed);
+        }
+        if (NumConflictingSolutions > 0)
+        {
+            std::printf("%d conflict-based solutions still had conflicts\n", NumConflictingSolutions);
+        }
+        return NumConflictingSolutions == 0 ? 0 : 1;
+    }
+}
+
+int main(int Argc, char** Argv)
+{
+    FBenchOptions Options;
+    if (!ParseOptions(Argc, Argv, Options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::mt19937 Rng(Options.Seed);
+    FOccupancyGrid Grid;
+    if (!Options.MapFile.empty())
+    {
+        if (!Grid.LoadFromFile(Options.MapFile))
+        {
+            std::fprintf(stderr, "Failed to load map %s\n", Options.MapFile.c_str());
+            return 1;
+        }
+    }
+    else
+    {
+        BuildSyntheticMap(Options, Rng, Grid);
+    }
+
+    std::vector<FPlanQuery> Queries;
+    if (!Options.QueryFile.empty())
+    {
+        if (!LoadQueriesFromFile(Options.QueryFile, Queries))
+        {
+            std::fprintf(stderr, "Failed to load queries %s\n", Options.QueryFile.c_str());
+            return 1;
+        }
+    }
+    else
+    {
+        BuildRandomQueries(Options, Grid, Rng, Queries);
+    }
+
+    if (!Options.SaveMapFile.empty() && !Grid.SaveToFile(Options.SaveMapFile))
+    {
+        std::fprintf(stderr, "Failed to save map %s\n", Options.SaveMapFile.c_str());
+    }
+    if (!Options.SaveQueryFile.empty() && !SaveQueriesToFile(Options.SaveQueryFile, Queries))
+    {
+        std::fprintf(stderr, "Failed to save queries %s\n", Options.SaveQueryFile.c_str());
+    }
+
+    std::printf("Map: %d x %d x %d cells @ %.1f cm, %lld occupied, %s %.1f MB; %d queries\n",
+        Grid.GetDimX(), Grid.GetDimY(), Grid.GetDimZ(), Grid.GetResolution(),
+        (long long)Grid.CountOccupied(), Grid.IsSparse() ? "sparse" : "dense",
+        Grid.GetAllocatedBytes() / (1024.0 * 1024.0), (int32_t)Queries.size());
+
+    if (Options.NumRays > 0)
+    {
+        return RunRaycast(Options, Grid, Rng);
+    }
+
+    using FClock = std::chrono::steady_clock;
+
+    FDistanceField DistanceField;
+    if (Options.DistanceFieldMax > 0.0f)
+    {
+        const FClock::time_point BuildBegin = FClock::now();
+        if (DistanceField.Build(Grid, Options.DistanceFieldMax))
+        {
+            std::printf("ESDF: max %.0f cm, built in %.3f ms\n", DistanceField.GetMaxDistance(),
+                std::chrono::duration<double>(FClock::now() - BuildBegin).count() * 1000.0);
+        }
+        else
+        {
+            std::fprintf(stderr, "ESDF requires a dense map, ignoring --esdf\n");
+        }
+    }
+    const FDistanceField* DistanceFieldPtr = DistanceField.IsValid() ? &DistanceField : nullptr;
+
+    if (Options.bCompareSearchModes)
+    {
+        return RunSearchModeComparison(Options, Grid, Queries);
+    }
+
+    if (Options.NumReplans > 0)
+    {
+        return RunIncrementalReplan(Options, Grid, Queries);
+    }
+
+    if (Options.HierarchicalClusterSize > 0)
+    {
+        return RunHierarchicalComparison(Options, Grid, Queries);
+    }
+
+    if (Options.NumRetargets > 0)
+    {
+        return RunPathCacheComparison(Options, Grid, Queries, Rng);
+    }
+
+    if (Options.ConflictSuboptimality >= 1.0f)
+    {
+        return RunConflictBasedComparison(Options, Grid, DistanceFieldPtr, Queries);
+    }
+
+    if (Options.bBatch)
+    {
+        return RunBatch(Options, Grid, DistanceFieldPtr, Queries);
+    }
+
+    FAStarPlanner Planner;
+    Planner.Config.DroneSpeed = Options.DroneSpeed;
+    Planner.Config.MaxSearchSteps = Options.MaxSearchSteps;
+    Planner.Config.MaxSearchMicros = Options.MaxSearchMicros;
+    Planner.Config.SearchMode = Options.SearchMode;
+    Planner.Config.Connectivity = Options.Connectivity;
+    Planner.Config.AnytimeInitialWeight = Options.AnytimeInitialWeight;
+
+    int64_t TotalExpansions = 0;
+    double TotalCost = 0.0;
+    double TotalBound = 0.0;
+    float MaxBound = 1.0f;
+    int32_t NumSucceeded = 0;
+    int32_t NumPlanned = 0;
+    double TotalSearchSeconds = 0.0;
+    double TotalSmoothSeconds = 0.0;
+
+    for (int32_t Round = 0; Round < Options.Repeat; ++Round)
+    {
+        FReservationTable Reservations;
+        for (const FPlanQuery& Query : Queries)
+        {
+            FPlanRequest Request;
+            Request.Start = Query.Start;
+            Request.Goal = Query.Goal;
+            Request.DroneID = Query.DroneID;
+
+            std::vector<FVec3> Path;
+            const FClock::time_point SearchBegin = FClock::now();
+            const EPlanStatus Status = Planner.FindPath(Grid, Options.bReserve ? &Reservations : nullptr, Request, Path);
+            const double SearchSeconds = std::chrono::duration<double>(FClock::now() - SearchBegin).count();
+
+            double SmoothSeconds = 0.0;
+            if (Status == EPlanStatus::Success && Options.bSmooth)
+            {
+                const FClock::time_point SmoothBegin = FClock::now();
+                FPathSmoother(Grid, Options.SafetyDistance, DistanceFieldPtr).SmoothPath(Path);
+                SmoothSeconds = std::chrono::duration<double>(FClock::now() - SmoothBegin).count();
+            }
+            if (Status == EPlanStatus::Success && Options.bReserve)
+            {
+                Reservations.Reserve(Query.DroneID, FReservationTable::BuildSamples(Path, Options.DroneSpeed, 0.0f));
+            }
+
+            const FSearchStats& Stats = Planner.GetLastStats();
+            TotalExpansions += Stats.Expansions;
+            TotalSearchSeconds += SearchSeconds;
+            TotalSmoothSeconds += SmoothSeconds;
+            NumPlanned++;
+            if (Status == EPlanStatus::Success)
+            {
+                NumSucceeded++;
+                TotalCost += Stats.PathCost;
+                TotalBound += Stats.SuboptimalityBound;
+                MaxBound = std::max(MaxBound, Stats.SuboptimalityBound);
+            }
+
+            if (Options.bVerbose)
+            {
+                std::printf("  drone %3d: %-34s expansions %8d  search %9.3f ms  smooth %7.3f ms  points %5d  length %10.1f  bound %5.3f\n",
+                    Query.DroneID, LexToString(Status), Stats.Expansions, SearchSeconds * 1000.0, SmoothSeconds * 1000.0,
+                    (int32_t)Path.size(), PathLength(Path), Stats.SuboptimalityBound);
+            }
+        }
+    }
+
+    std::printf("Planned %d queries (%s), %d succeeded\n", NumPlanned,
+        Options.SearchMode == ESearchMode::JumpPoint ? LexToString(ESearchMode::JumpPoint) : LexToString(Options.Connectivity), NumSucceeded);
+    std::printf("Search: %.3f ms total, %.3f ms/query, %lld expansions, %.0f expansions/s\n",
+        TotalSearchSeconds * 1000.0, NumPlanned ? TotalSearchSeconds * 1000.0 / NumPlanned : 0.0,
+        (long long)TotalExpansions, TotalSearchSeconds > 0.0 ? TotalExpansions / TotalSearchSeconds : 0.0);
+    if (Options.AnytimeInitialWeight > 1.0f)
+    {
+        std::printf("Anytime: initial weight %.2f, total cost %.1f, suboptimality bound mean %.3f, max %.3f\n",
+            Options.AnytimeInitialWeight, TotalCost, NumSucceeded ? TotalBound / NumSucceeded : 1.0, MaxBound);
+    }
+    if (Options.bSmooth)
+    {
+        std::printf("Smooth: %.3f ms total\n", TotalSmoothSeconds * 1000.0);
+    }
+    return 0;
+}